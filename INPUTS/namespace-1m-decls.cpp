@@ -0,0 +1,45 @@
+// This pounds on the lookup table of a single namespace: 1,000,000 functions
+// with distinct names, then 10,000 overloads of one name that are all
+// redeclared. Time it with:
+//
+//   clang -cc1 -fsyntax-only -print-stats INPUTS/namespace-1m-decls.cpp
+
+#define EXPAND_10(M, p) M(p##0) M(p##1) M(p##2) M(p##3) M(p##4) \
+                        M(p##5) M(p##6) M(p##7) M(p##8) M(p##9)
+#define EXPAND_100(M, p)     EXPAND_10(M, p##0)    EXPAND_10(M, p##1) \
+  EXPAND_10(M, p##2)    EXPAND_10(M, p##3)    EXPAND_10(M, p##4)      \
+  EXPAND_10(M, p##5)    EXPAND_10(M, p##6)    EXPAND_10(M, p##7)      \
+  EXPAND_10(M, p##8)    EXPAND_10(M, p##9)
+#define EXPAND_1000(M, p)    EXPAND_100(M, p##0)   EXPAND_100(M, p##1) \
+  EXPAND_100(M, p##2)   EXPAND_100(M, p##3)   EXPAND_100(M, p##4)      \
+  EXPAND_100(M, p##5)   EXPAND_100(M, p##6)   EXPAND_100(M, p##7)      \
+  EXPAND_100(M, p##8)   EXPAND_100(M, p##9)
+#define EXPAND_10000(M, p)   EXPAND_1000(M, p##0)  EXPAND_1000(M, p##1) \
+  EXPAND_1000(M, p##2)  EXPAND_1000(M, p##3)  EXPAND_1000(M, p##4)      \
+  EXPAND_1000(M, p##5)  EXPAND_1000(M, p##6)  EXPAND_1000(M, p##7)      \
+  EXPAND_1000(M, p##8)  EXPAND_1000(M, p##9)
+#define EXPAND_100000(M, p)  EXPAND_10000(M, p##0) EXPAND_10000(M, p##1) \
+  EXPAND_10000(M, p##2) EXPAND_10000(M, p##3) EXPAND_10000(M, p##4)      \
+  EXPAND_10000(M, p##5) EXPAND_10000(M, p##6) EXPAND_10000(M, p##7)      \
+  EXPAND_10000(M, p##8) EXPAND_10000(M, p##9)
+#define EXPAND_1000000(M, p) EXPAND_100000(M, p##0) EXPAND_100000(M, p##1) \
+  EXPAND_100000(M, p##2) EXPAND_100000(M, p##3) EXPAND_100000(M, p##4)      \
+  EXPAND_100000(M, p##5) EXPAND_100000(M, p##6) EXPAND_100000(M, p##7)      \
+  EXPAND_100000(M, p##8) EXPAND_100000(M, p##9)
+
+namespace big {
+  template<int N> struct tag;
+
+#define DISTINCT(n) int f##n(int);
+  EXPAND_1000000(DISTINCT, 1)
+#undef DISTINCT
+
+#define OVERLOAD(n) void g(tag<n>);
+  EXPAND_10000(OVERLOAD, 1)
+  EXPAND_10000(OVERLOAD, 1)
+#undef OVERLOAD
+}
+
+int use() {
+  return big::f1000000(0) + big::f1999999(0);
+}
@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 24
+#define CINDEX_VERSION_MINOR 27
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -1450,6 +1450,46 @@ CINDEX_LINKAGE int clang_reparseTranslationUnit(CXTranslationUnit TU,
                                           struct CXUnsavedFile *unsaved_files,
                                                 unsigned options);
 
+/**
+ * \brief Freeze the AST of a translation unit, so that several threads can
+ * traverse it at the same time.
+ *
+ * Much of the AST of a translation unit is computed lazily: declarations
+ * are deserialized from precompiled headers and modules the first time they
+ * are needed, and properties such as the size of a type are cached the first
+ * time they are queried. None of this is thread-safe. Freezing computes all
+ * of it up front, after which the following may be called concurrently from
+ * several threads on the same translation unit:
+ *
+ *   - \c clang_visitChildren() and the other cursor navigation functions,
+ *     such as \c clang_getCursorSemanticParent() and
+ *     \c clang_getCursorReferenced();
+ *   - the cursor and type query functions, such as \c clang_getCursorType(),
+ *     \c clang_getCursorSpelling(), \c clang_getTypeSpelling() and
+ *     \c clang_Type_getSizeOf(), except as noted below.
+ *
+ * Functions that map between cursors and source locations (for example
+ * \c clang_getCursorLocation(), \c clang_getCursorExtent(),
+ * \c clang_getCursor() and \c clang_tokenize()) update caches in the source
+ * manager and must still not be called concurrently. This includes
+ * \c clang_getCursorUSR() for local and anonymous declarations, whose USRs
+ * encode their location, and \c clang_getTypeSpelling() (or any other
+ * function that prints a type, such as \c clang_getCursorDisplayName()) for
+ * types that involve an anonymous struct, union or enum, whose spelling
+ * includes the location of its definition.
+ *
+ * Freezing can take significant time and memory for a translation unit that
+ * uses large precompiled headers, since everything in them is deserialized.
+ * The translation unit stays frozen until it is reparsed with
+ * \c clang_reparseTranslationUnit().
+ *
+ * \param TU The translation unit to freeze.
+ *
+ * \returns 0 if the translation unit was frozen. Otherwise, one of the
+ * error codes described by the \c CXErrorCode enum.
+ */
+CINDEX_LINKAGE int clang_freezeTranslationUnit(CXTranslationUnit TU);
+
 /**
   * \brief Categorizes how memory is being used by a translation unit.
   */
@@ -3318,6 +3358,27 @@ unsigned clang_visitChildrenWithBlock(CXCursor parent,
  */
 CINDEX_LINKAGE CXString clang_getCursorUSR(CXCursor);
 
+/**
+ * \brief A 128-bit hash of a USR.
+ *
+ * The hash of a given USR is the same across runs, hosts and library
+ * versions, so it can be stored in persistent indexes. \c data[0] can be
+ * used on its own as a 64-bit hash. A hash of zero means that there is no
+ * USR.
+ */
+typedef struct {
+  unsigned long long data[2];
+} CXUSRHash;
+
+/**
+ * \brief Retrieve the hash of the USR for the entity referenced by the given
+ * cursor.
+ *
+ * This is equivalent to hashing the result of #clang_getCursorUSR, without
+ * allocating the USR string.
+ */
+CINDEX_LINKAGE CXUSRHash clang_getCursorUSRHash(CXCursor);
+
 /**
  * \brief Construct a USR for a specified Objective-C class.
  */
@@ -5528,6 +5589,12 @@ typedef struct {
   CXIdxEntityCXXTemplateKind templateKind;
   CXIdxEntityLanguage lang;
   const char *name;
+  /**
+   * \brief The USR of the entity, or \c NULL if it has none.
+   *
+   * USRs are interned in the \c CXIndex: the string stays valid until the
+   * index is disposed, and equal USRs are reported with the same pointer.
+   */
   const char *USR;
   CXCursor cursor;
   const CXIdxAttrInfo *const *attributes;
@@ -5773,6 +5840,13 @@ clang_index_setClientContainer(const CXIdxContainerInfo *,CXIdxClientContainer);
 CINDEX_LINKAGE CXIdxClientEntity
 clang_index_getClientEntity(const CXIdxEntityInfo *);
 
+/**
+ * \brief Retrieve the hash of the entity's USR, which is the same as the one
+ * #clang_getCursorUSRHash returns. This doesn't hash the USR again.
+ */
+CINDEX_LINKAGE CXUSRHash
+clang_index_getEntityUSRHash(const CXIdxEntityInfo *);
+
 /**
  * \brief For setting a custom CXIdxClientEntity attached to an entity.
  */
@@ -5836,7 +5910,20 @@ typedef enum {
    * indexing session assosiated with a \c CXIndexAction object.
    * Bodies in system headers are always skipped.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief Only index the declarations of a header once during an indexing
+   * session associated with a \c CXIndexAction object.
+   *
+   * Declarations are tracked per header and preprocessor conditional region;
+   * once a translation unit of the session has started indexing a region,
+   * other translation units of the session skip the declarations in it.
+   * Inclusion directives and declarations of the main files are always
+   * reported. Headers without an include guard are only tracked inside
+   * their conditional regions.
+   */
+  CXIndexOpt_IndexHeadersOnceInSession = 0x20
 
 } CXIndexOptFlags;
 
@@ -5878,6 +5965,56 @@ CINDEX_LINKAGE int clang_indexSourceFile(CXIndexAction,
                                          CXTranslationUnit *out_TU,
                                          unsigned TU_options);
 
+/**
+ * \brief A source file to index with #clang_indexSourceFiles.
+ */
+typedef struct {
+  /**
+   * \brief The source file, or \c NULL if it is part of the command line
+   * arguments.
+   */
+  const char *source_filename;
+  const char *const *command_line_args;
+  int num_command_line_args;
+  /**
+   * \brief The client data passed to the callbacks invoked for this file.
+   */
+  CXClientData client_data;
+  /**
+   * \brief Set to the value #clang_indexSourceFile would return for this
+   * file.
+   */
+  int result;
+} CXIndexSourceFileJob;
+
+/**
+ * \brief Index several source files, using up to \p num_threads threads.
+ *
+ * Each file is indexed as with #clang_indexSourceFile, without keeping its
+ * translation unit. Combined with \c CXIndexOpt_IndexHeadersOnceInSession,
+ * the declarations of headers shared by the files are reported only once
+ * for the whole batch.
+ *
+ * The callbacks are invoked concurrently from different threads, each call
+ * receiving the client data of the file being indexed.
+ *
+ * \param num_threads The maximum number of files indexed at the same time,
+ * including on the calling thread. 0 and 1 index the files one after the
+ * other.
+ *
+ * \returns 0 if all files were indexed successfully, otherwise the first
+ * non-zero result in \p jobs.
+ */
+CINDEX_LINKAGE int clang_indexSourceFiles(CXIndexAction,
+                                          IndexerCallbacks *index_callbacks,
+                                          unsigned index_callbacks_size,
+                                          unsigned index_options,
+                                          CXIndexSourceFileJob *jobs,
+                                          unsigned num_jobs,
+                                          struct CXUnsavedFile *unsaved_files,
+                                          unsigned num_unsaved_files,
+                                          unsigned num_threads);
+
 /**
  * \brief Index the given translation unit via callbacks implemented through
  * #IndexerCallbacks.
@@ -15,6 +15,7 @@
 #ifndef LLVM_CLANG_AST_ASTCONTEXT_H
 #define LLVM_CLANG_AST_ASTCONTEXT_H
 
+#include "clang/AST/ASTMemoryAccounting.h"
 #include "clang/AST/ASTTypeTraits.h"
 #include "clang/AST/CanonicalType.h"
 #include "clang/AST/CommentCommandTraits.h"
@@ -49,6 +50,7 @@ namespace clang {
   class ASTRecordLayout;
   class BlockExpr;
   class CharUnits;
+  class ConstexprInterpreter;
   class DiagnosticsEngine;
   class Expr;
   class ExternalASTSource;
@@ -173,6 +175,29 @@ class ASTContext : public RefCountedBase<ASTContext> {
   llvm::DenseMap<const MaterializeTemporaryExpr*, APValue>
     MaterializedTemporaryValues;
 
+  /// \brief The result of a call to a constexpr function that only depended
+  /// on the values of its arguments, memoized by the constant evaluator.
+  struct ConstexprCallResult : public llvm::FoldingSetNode {
+    /// \brief The callee and argument values, as profiled by the evaluator.
+    llvm::FoldingSetNodeIDRef Key;
+    APValue Value;
+
+    ConstexprCallResult(llvm::FoldingSetNodeIDRef Key, const APValue &Value)
+      : Key(Key), Value(Value) {}
+
+    void Profile(llvm::FoldingSetNodeID &ID) const {
+      for (size_t I = 0, N = Key.getSize(); I != N; ++I)
+        ID.AddInteger(Key.getData()[I]);
+    }
+  };
+  llvm::FoldingSet<ConstexprCallResult> ConstexprCallResults;
+
+  /// \brief The number of constexpr call cache lookups and hits.
+  unsigned NumConstexprCallLookups, NumConstexprCallHits;
+
+  /// \brief The bytecode interpreter for constexpr calls, created on demand.
+  OwningPtr<ConstexprInterpreter> ConstexprInterp;
+
   /// \brief Representation of a "canonical" template template parameter that
   /// is used in canonical template names.
   class CanonicalTemplateTemplateParm : public llvm::FoldingSetNode {
@@ -391,6 +416,9 @@ private:
   /// AST objects will be released when the ASTContext itself is destroyed.
   mutable llvm::BumpPtrAllocator BumpAlloc;
 
+  /// \brief The accounting that allocations are reported to, if any.
+  ASTMemoryAccounting *MemoryAccounting;
+
   /// \brief Allocator for partial diagnostics.
   PartialDiagnostic::StorageAllocator DiagAllocator;
 
@@ -474,6 +502,8 @@ public:
   }
 
   void *Allocate(size_t Size, unsigned Align = 8) const {
+    if (MemoryAccounting)
+      MemoryAccounting->addASTContextAllocation(Size);
     return BumpAlloc.Allocate(Size, Align);
   }
   void Deallocate(void *Ptr) const { }
@@ -485,6 +515,14 @@ public:
   }
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
+
+  /// \brief Returns the accounting that AST allocations are reported to, or
+  /// null if memory is not being accounted for.
+  ASTMemoryAccounting *getMemoryAccounting() const { return MemoryAccounting; }
+
+  /// \brief Report AST allocations, and the types and side tables of this
+  /// context, to \p Accounting (which may be null) from now on.
+  void setMemoryAccounting(ASTMemoryAccounting *Accounting);
   
   PartialDiagnostic::StorageAllocator &getDiagAllocator() {
     return DiagAllocator;
@@ -2205,6 +2243,18 @@ public:
   APValue *getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
                                          bool MayCreate);
 
+  /// \brief Get the memoized result of the constexpr call profiled in \p ID,
+  /// or null if it hasn't been memoized.
+  const APValue *getConstexprCallResult(const llvm::FoldingSetNodeID &ID);
+
+  /// \brief Memoize the result of the constexpr call profiled in \p ID.
+  void setConstexprCallResult(const llvm::FoldingSetNodeID &ID,
+                              const APValue &Value);
+
+  /// \brief Get the bytecode interpreter used to evaluate constexpr calls
+  /// when -fexperimental-constexpr-bytecode is enabled.
+  ConstexprInterpreter &getConstexprInterpreter();
+
   //===--------------------------------------------------------------------===//
   //                    Statistics
   //===--------------------------------------------------------------------===//
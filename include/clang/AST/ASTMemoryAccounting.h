@@ -0,0 +1,174 @@
+//===--- ASTMemoryAccounting.h - AST memory by kind and file ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the clang::ASTMemoryAccounting class, which attributes the
+/// memory used to represent a translation unit to kinds of AST data and to
+/// the source file being parsed when it was allocated.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_ASTMEMORYACCOUNTING_H
+#define LLVM_CLANG_AST_ASTMEMORYACCOUNTING_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace clang {
+
+class ASTContext;
+
+/// \brief Accounts for the memory used by the AST of a translation unit, for
+/// -fast-memory-report.
+///
+/// Memory is split by category, and attributed to the file that was being
+/// parsed when it was allocated. Memory allocated once the main file has been
+/// parsed, e.g. for pending template instantiations, is attributed to the main
+/// file; memory allocated before any file was entered to "<startup>".
+///
+/// Most categories are counted as the memory is allocated, through add().
+/// Types, the side tables of the ASTContext and Sema, and the buffers of AST
+/// files are instead measured whenever the current file changes; what they
+/// grew by is attributed to the file that was current until then.
+///
+/// An accounting is only ever used from one thread; the one that new
+/// statements and the frontend report to is the one made current on that
+/// thread with setCurrent(). Unlike -print-stats, it doesn't need any
+/// process-wide switch, so it can be used while other threads build modules.
+class ASTMemoryAccounting {
+public:
+  enum Category {
+    /// \brief Type nodes, at the size of their class.
+    Types,
+    /// \brief Declaration nodes, including trailing storage.
+    Decls,
+    /// \brief Statement and expression nodes, including trailing storage and
+    /// operand arrays.
+    Stmts,
+    /// \brief The lookup tables of declaration contexts.
+    DeclContextMaps,
+    /// \brief Evaluated initializers and memoized constexpr call results.
+    APValues,
+    /// \brief The definition data of C++, Objective-C and C++/CLI classes.
+    DefinitionData,
+    /// \brief Everything else allocated by the ASTContext allocator, such as
+    /// TypeSourceInfos, attributes and nested-name-specifiers.
+    OtherAST,
+    /// \brief Side tables of the ASTContext, such as record layouts.
+    ASTSideTables,
+    /// \brief Side tables of Sema, such as pending instantiations and the
+    /// special member and deduction failure caches.
+    SemaTables,
+    /// \brief Buffers holding the AST files the translation unit uses.
+    ASTReaderBuffers,
+    NumCategories
+  };
+
+  /// \brief Returns the number of bytes used so far by some data structure.
+  typedef size_t (*MemoryCounterFn)(const void *Data);
+
+private:
+  struct Usage {
+    uint64_t Bytes[NumCategories];
+    /// \brief Everything allocated by the ASTContext allocator, from which
+    /// OtherAST is derived.
+    uint64_t ASTContextBytes;
+
+    Usage() : ASTContextBytes(0) {
+      for (unsigned I = 0; I != NumCategories; ++I)
+        Bytes[I] = 0;
+    }
+  };
+
+  struct Counter {
+    Category Cat;
+    MemoryCounterFn Fn;
+    const void *Data;
+    uint64_t LastValue;
+  };
+
+  llvm::StringMap<Usage> Files;
+
+  /// \brief The usage of the files entered and not yet left, innermost last.
+  SmallVector<Usage *, 16> OpenFiles;
+
+  /// \brief The usage of the innermost open file, or of "<startup>".
+  Usage *Current;
+
+  /// \brief The counters that are sampled at each checkpoint.
+  SmallVector<Counter, 4> Counters;
+
+  /// \brief The ASTContext whose types and buffers are measured.
+  const ASTContext *Context;
+
+  /// \brief The number of types of Context already measured.
+  unsigned NumTypesMeasured;
+
+  /// \brief Attribute what the sampled counters and types grew by to the
+  /// current file.
+  void checkpoint();
+
+  ASTMemoryAccounting(const ASTMemoryAccounting &) LLVM_DELETED_FUNCTION;
+  void operator=(const ASTMemoryAccounting &) LLVM_DELETED_FUNCTION;
+
+public:
+  ASTMemoryAccounting();
+  ~ASTMemoryAccounting();
+
+  /// \brief Returns the accounting that the current thread reports to, or
+  /// null if accounting is disabled.
+  static ASTMemoryAccounting *getCurrent();
+
+  /// \brief Make \p Accounting (which may be null) the one that the current
+  /// thread reports to.
+  static void setCurrent(ASTMemoryAccounting *Accounting);
+
+  /// \brief Returns the name used for \p C in reports.
+  static const char *getCategoryName(Category C);
+
+  /// \brief Attribute \p Bytes of category \p C to the current file.
+  void add(Category C, size_t Bytes) { Current->Bytes[C] += Bytes; }
+
+  /// \brief Attribute \p Bytes allocated by the ASTContext allocator to the
+  /// current file.
+  void addASTContextAllocation(size_t Bytes) {
+    Current->ASTContextBytes += Bytes;
+  }
+
+  /// \brief Measure the types, side tables and external AST source of \p Ctx
+  /// (which may be null) from now on, instead of those of the previous
+  /// context.
+  void setContext(const ASTContext *Ctx);
+
+  /// \brief Sample \p Fn at each checkpoint, and attribute what it grew by to
+  /// category \p C.
+  void addCounter(Category C, MemoryCounterFn Fn, const void *Data);
+
+  /// \brief Stop sampling the counters for \p Data.
+  void removeCounters(const void *Data);
+
+  /// \brief Attribute further memory to the file named \p Name, until the
+  /// matching exitFile().
+  void enterFile(StringRef Name);
+
+  /// \brief Attribute further memory to the file enclosing the current one.
+  void exitFile();
+
+  /// \brief Write the memory used in each category, in total and for each
+  /// file, as a JSON document. Files are listed from the one that used the
+  /// most memory to the one that used the least.
+  void write(raw_ostream &OS);
+};
+
+} // end namespace clang
+
+#endif
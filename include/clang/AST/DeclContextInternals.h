@@ -16,6 +16,7 @@
 
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclarationName.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
@@ -32,7 +33,48 @@ class DependentDiagnostic;
 struct StoredDeclsList {
 
   /// \brief When in vector form, this is what the Data pointer points to.
-  typedef SmallVector<NamedDecl *, 4> DeclsTy;
+  struct DeclsTy : SmallVector<NamedDecl *, 4> {
+    /// \brief Lists at least this long index the positions of their
+    /// declarations, so that a redeclaration in a huge overload set doesn't
+    /// have to scan the whole set.
+    enum { MinIndexedSize = 16 };
+
+    /// \brief The position of each declaration in the list, or null if it
+    /// hasn't been built or was invalidated by declarations moving.
+    llvm::DenseMap<NamedDecl *, unsigned> *Positions;
+
+    DeclsTy() : Positions(0) {}
+    DeclsTy(const DeclsTy &RHS)
+      : SmallVector<NamedDecl *, 4>(RHS), Positions(0) {}
+    ~DeclsTy() { delete Positions; }
+
+    void invalidatePositions() {
+      delete Positions;
+      Positions = 0;
+    }
+
+    /// \brief Record that \p D is now at position \p I, if positions are
+    /// being tracked.
+    void setPosition(NamedDecl *D, unsigned I) {
+      if (Positions)
+        (*Positions)[D] = I;
+    }
+
+    /// \brief Find the position of \p D, building the index if needed.
+    /// Returns size() if \p D is not in the list.
+    unsigned getPosition(NamedDecl *D) {
+      if (!Positions) {
+        Positions = new llvm::DenseMap<NamedDecl *, unsigned>();
+        for (unsigned I = 0, N = size(); I != N; ++I)
+          (*Positions)[(*this)[I]] = I;
+      }
+      llvm::DenseMap<NamedDecl *, unsigned>::iterator Pos = Positions->find(D);
+      return Pos == Positions->end() ? size() : Pos->second;
+    }
+
+  private:
+    void operator=(const DeclsTy &) LLVM_DELETED_FUNCTION;
+  };
 
   /// \brief A collection of declarations, with a flag to indicate if we have
   /// further external declarations.
@@ -118,6 +160,7 @@ public:
     DeclsTy::iterator I = std::find(Vec.begin(), Vec.end(), D);
     assert(I != Vec.end() && "list does not contain decl");
     Vec.erase(I);
+    Vec.invalidatePositions();
 
     assert(std::find(Vec.begin(), Vec.end(), D)
              == Vec.end() && "list still contains decl");
@@ -136,6 +179,7 @@ public:
       Vec.erase(std::remove_if(Vec.begin(), Vec.end(),
                                std::mem_fun(&Decl::isFromASTFile)),
                 Vec.end());
+      Vec.invalidatePositions();
       // Don't have any external decls any more.
       Data = DeclsAndHasExternalTy(&Vec, false);
     }
@@ -177,11 +221,33 @@ public:
 
     // Determine if this declaration is actually a redeclaration.
     DeclsTy &Vec = *getAsVector();
+
+    // A function or function template can only replace its previous
+    // declaration, which a long list finds through its index.
+    NamedDecl *OldD;
+    if (Vec.size() >= DeclsTy::MinIndexedSize &&
+        getOnlyReplaceableDecl(D, OldD)) {
+      if (!OldD)
+        return false;
+      unsigned I = Vec.getPosition(OldD);
+      if (I == Vec.size())
+        return false;
+      assert(D->declarationReplaces(OldD) && "wrong replaceable decl");
+      Vec[I] = D;
+      Vec.Positions->erase(OldD);
+      (*Vec.Positions)[D] = I;
+      return true;
+    }
+
     for (DeclsTy::iterator OD = Vec.begin(), ODEnd = Vec.end();
          OD != ODEnd; ++OD) {
       NamedDecl *OldD = *OD;
       if (D->declarationReplaces(OldD)) {
         *OD = D;
+        if (Vec.Positions) {
+          Vec.Positions->erase(OldD);
+          (*Vec.Positions)[D] = OD - Vec.begin();
+        }
         return true;
       }
     }
@@ -189,6 +255,23 @@ public:
     return false;
   }
 
+  /// \brief If \p D tracks its redeclarations, so that
+  /// NamedDecl::declarationReplaces can only be true for its previous
+  /// declaration, set \p OldD to that declaration (or null if there is
+  /// none) and return true.
+  static bool getOnlyReplaceableDecl(NamedDecl *D, NamedDecl *&OldD) {
+    if (FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+      OldD = FD->getPreviousDecl();
+      return true;
+    }
+    if (FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D)) {
+      FunctionDecl *PrevFD = FTD->getTemplatedDecl()->getPreviousDecl();
+      OldD = PrevFD ? PrevFD->getDescribedFunctionTemplate() : 0;
+      return true;
+    }
+    return false;
+  }
+
   /// AddSubsequentDecl - This is called on the second and later decl when it is
   /// not a redeclaration to merge it into the appropriate place in our list.
   ///
@@ -213,8 +296,10 @@ public:
     // Tag declarations always go at the end of the list so that an
     // iterator which points at the first tag will start a span of
     // decls that only contains tags.
-    if (D->hasTagIdentifierNamespace())
+    if (D->hasTagIdentifierNamespace()) {
       Vec.push_back(D);
+      Vec.setPosition(D, Vec.size() - 1);
+    }
 
     // Resolved using declarations go at the front of the list so that
     // they won't show up in other lookup results.  Unresolved using
@@ -228,6 +313,7 @@ public:
           ++I;
       }
       Vec.insert(I, D);
+      Vec.invalidatePositions();
 
     // All other declarations go at the end of the list, but before any
     // tag declarations.  But we can be clever about tag declarations
@@ -235,9 +321,13 @@ public:
     } else if (!Vec.empty() && Vec.back()->hasTagIdentifierNamespace()) {
       NamedDecl *TagD = Vec.back();
       Vec.back() = D;
+      Vec.setPosition(D, Vec.size() - 1);
       Vec.push_back(TagD);
-    } else
+      Vec.setPosition(TagD, Vec.size() - 1);
+    } else {
       Vec.push_back(D);
+      Vec.setPosition(D, Vec.size() - 1);
+    }
   }
 };
 
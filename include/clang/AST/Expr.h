@@ -865,6 +865,10 @@ public:
 /// they apply in order to conserve memory. These are laid out past the end of
 /// the object, and flags in the DeclRefExprBitfield track whether they exist:
 ///
+///   DeclRefExprBits.HasNameLoc:
+///       Specifies when the declaration name carries source information of
+///       its own, such as the type written in a conversion-function-id or the
+///       locations of an operator-function-id.
 ///   DeclRefExprBits.HasQualifier:
 ///       Specifies when this declaration reference expression has a C++
 ///       nested-name-specifier.
@@ -885,14 +889,35 @@ class DeclRefExpr : public Expr {
   /// \brief The location of the declaration name itself.
   SourceLocation Loc;
 
-  /// \brief Provides source/type location info for the declaration name
-  /// embedded in D.
-  DeclarationNameLoc DNLoc;
+  /// \brief Test whether there is source/type location info for the
+  /// declaration name attached to the end of this DRE.
+  bool hasNameLoc() const { return DeclRefExprBits.HasNameLoc; }
+
+  /// \brief Helper to retrieve the optional source/type location info for
+  /// the declaration name embedded in D.
+  DeclarationNameLoc &getInternalNameLoc() {
+    assert(hasNameLoc());
+    return *reinterpret_cast<DeclarationNameLoc *>(this + 1);
+  }
+
+  /// \brief Helper to retrieve the optional source/type location info for
+  /// the declaration name embedded in D.
+  const DeclarationNameLoc &getInternalNameLoc() const {
+    return const_cast<DeclRefExpr *>(this)->getInternalNameLoc();
+  }
+
+  /// \brief Returns the start of the trailing objects that follow the
+  /// optional DeclarationNameLoc.
+  char *getTrailingStorage() {
+    if (hasNameLoc())
+      return reinterpret_cast<char *>(&getInternalNameLoc() + 1);
+    return reinterpret_cast<char *>(this + 1);
+  }
 
   /// \brief Helper to retrieve the optional NestedNameSpecifierLoc.
   NestedNameSpecifierLoc &getInternalQualifierLoc() {
     assert(hasQualifier());
-    return *reinterpret_cast<NestedNameSpecifierLoc *>(this + 1);
+    return *reinterpret_cast<NestedNameSpecifierLoc *>(getTrailingStorage());
   }
 
   /// \brief Helper to retrieve the optional NestedNameSpecifierLoc.
@@ -910,7 +935,7 @@ class DeclRefExpr : public Expr {
     assert(hasFoundDecl());
     if (hasQualifier())
       return *reinterpret_cast<NamedDecl **>(&getInternalQualifierLoc() + 1);
-    return *reinterpret_cast<NamedDecl **>(this + 1);
+    return *reinterpret_cast<NamedDecl **>(getTrailingStorage());
   }
 
   /// \brief Helper to retrieve the optional NamedDecl through which this
@@ -937,11 +962,14 @@ class DeclRefExpr : public Expr {
   void computeDependence(const ASTContext &C);
 
 public:
+  /// \brief Construct a reference to \p D by a plain identifier. References
+  /// whose name needs source information of its own, such as an
+  /// operator-function-id, are made with Create().
   DeclRefExpr(ValueDecl *D, bool refersToEnclosingLocal, QualType T,
-              ExprValueKind VK, SourceLocation L,
-              const DeclarationNameLoc &LocInfo = DeclarationNameLoc())
+              ExprValueKind VK, SourceLocation L)
     : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-      D(D), Loc(L), DNLoc(LocInfo) {
+      D(D), Loc(L) {
+    DeclRefExprBits.HasNameLoc = 0;
     DeclRefExprBits.HasQualifier = 0;
     DeclRefExprBits.HasTemplateKWAndArgsInfo = 0;
     DeclRefExprBits.HasFoundDecl = 0;
@@ -972,6 +1000,7 @@ public:
 
   /// \brief Construct an empty declaration reference expression.
   static DeclRefExpr *CreateEmpty(const ASTContext &Context,
+                                  bool HasNameLoc,
                                   bool HasQualifier,
                                   bool HasFoundDecl,
                                   bool HasTemplateKWAndArgsInfo,
@@ -982,7 +1011,10 @@ public:
   void setDecl(ValueDecl *NewD) { D = NewD; }
 
   DeclarationNameInfo getNameInfo() const {
-    return DeclarationNameInfo(getDecl()->getDeclName(), Loc, DNLoc);
+    if (!hasNameLoc())
+      return DeclarationNameInfo(getDecl()->getDeclName(), Loc);
+    return DeclarationNameInfo(getDecl()->getDeclName(), Loc,
+                               getInternalNameLoc());
   }
 
   SourceLocation getLocation() const { return Loc; }
@@ -1044,7 +1076,7 @@ public:
       return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(
         &getInternalQualifierLoc() + 1);
 
-    return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(this + 1);
+    return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(getTrailingStorage());
   }
 
   /// \brief Return the optional template keyword and arguments info.
@@ -2304,20 +2336,22 @@ class MemberExpr : public Expr {
   /// In X.F, this is the decl referenced by F.
   ValueDecl *MemberDecl;
 
-  /// MemberDNLoc - Provides source/type location info for the
-  /// declaration name embedded in MemberDecl.
-  DeclarationNameLoc MemberDNLoc;
-
   /// MemberLoc - This is the location of the member name.
   SourceLocation MemberLoc;
 
   /// IsArrow - True if this is "X->F", false if this is "X.F".
   bool IsArrow : 1;
 
+  /// \brief True if the member name carries source information of its own,
+  /// such as the type written in a conversion-function-id. When true, a
+  /// DeclarationNameLoc is allocated immediately after the MemberExpr.
+  bool HasNameLoc : 1;
+
   /// \brief True if this member expression used a nested-name-specifier to
   /// refer to the member, e.g., "x->Base::f", or found its member via a using
   /// declaration.  When true, a MemberNameQualifier
-  /// structure is allocated immediately after the MemberExpr.
+  /// structure is allocated immediately after the MemberExpr or, if the
+  /// member expression also has a DeclarationNameLoc, after that.
   bool HasQualifierOrFoundDecl : 1;
 
   /// \brief True if this member expression specified a template keyword
@@ -2326,17 +2360,37 @@ class MemberExpr : public Expr {
   /// When true, an ASTTemplateKWAndArgsInfo structure and its
   /// TemplateArguments (if any) are allocated immediately after
   /// the MemberExpr or, if the member expression also has a qualifier,
-  /// after the MemberNameQualifier structure.
+  /// after the MemberNameQualifier structure, or else after the
+  /// DeclarationNameLoc if there is one.
   bool HasTemplateKWAndArgsInfo : 1;
 
   /// \brief True if this member expression refers to a method that
   /// was resolved from an overloaded set having size greater than 1.
   bool HadMultipleCandidates : 1;
 
+  /// \brief Retrieve the source/type location info for the member name.
+  DeclarationNameLoc &getInternalNameLoc() {
+    assert(HasNameLoc);
+    return *reinterpret_cast<DeclarationNameLoc *>(this + 1);
+  }
+
+  /// \brief Retrieve the source/type location info for the member name.
+  const DeclarationNameLoc &getInternalNameLoc() const {
+    return const_cast<MemberExpr *>(this)->getInternalNameLoc();
+  }
+
+  /// \brief Returns the start of the trailing objects that follow the
+  /// optional DeclarationNameLoc.
+  char *getTrailingStorage() {
+    if (HasNameLoc)
+      return reinterpret_cast<char *>(&getInternalNameLoc() + 1);
+    return reinterpret_cast<char *>(this + 1);
+  }
+
   /// \brief Retrieve the qualifier that preceded the member name, if any.
   MemberNameQualifier *getMemberQualifier() {
     assert(HasQualifierOrFoundDecl);
-    return reinterpret_cast<MemberNameQualifier *> (this + 1);
+    return reinterpret_cast<MemberNameQualifier *>(getTrailingStorage());
   }
 
   /// \brief Retrieve the qualifier that preceded the member name, if any.
@@ -2345,6 +2399,10 @@ class MemberExpr : public Expr {
   }
 
 public:
+  // NOTE: only the location of the name is kept; source information carried
+  // by the name itself (i.e., source locations for C++ operator names or type
+  // source info for constructors, destructors and conversion operators) is
+  // only stored by MemberExpr::Create.
   MemberExpr(Expr *base, bool isarrow, ValueDecl *memberdecl,
              const DeclarationNameInfo &NameInfo, QualType ty,
              ExprValueKind VK, ExprObjectKind OK)
@@ -2353,8 +2411,8 @@ public:
            base->isValueDependent(),
            base->isInstantiationDependent(),
            base->containsUnexpandedParameterPack()),
-      Base(base), MemberDecl(memberdecl), MemberDNLoc(NameInfo.getInfo()),
-      MemberLoc(NameInfo.getLoc()), IsArrow(isarrow),
+      Base(base), MemberDecl(memberdecl),
+      MemberLoc(NameInfo.getLoc()), IsArrow(isarrow), HasNameLoc(false),
       HasQualifierOrFoundDecl(false), HasTemplateKWAndArgsInfo(false),
       HadMultipleCandidates(false) {
     assert(memberdecl->getDeclName() == NameInfo.getName());
@@ -2371,8 +2429,8 @@ public:
            base->isTypeDependent(), base->isValueDependent(),
            base->isInstantiationDependent(),
            base->containsUnexpandedParameterPack()),
-      Base(base), MemberDecl(memberdecl), MemberDNLoc(), MemberLoc(l),
-      IsArrow(isarrow),
+      Base(base), MemberDecl(memberdecl), MemberLoc(l),
+      IsArrow(isarrow), HasNameLoc(false),
       HasQualifierOrFoundDecl(false), HasTemplateKWAndArgsInfo(false),
       HadMultipleCandidates(false) {}
 
@@ -2433,7 +2491,7 @@ public:
       return 0;
 
     if (!HasQualifierOrFoundDecl)
-      return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(this + 1);
+      return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(getTrailingStorage());
 
     return reinterpret_cast<ASTTemplateKWAndArgsInfo *>(
                                                       getMemberQualifier() + 1);
@@ -2522,8 +2580,10 @@ public:
 
   /// \brief Retrieve the member declaration name info.
   DeclarationNameInfo getMemberNameInfo() const {
+    if (!HasNameLoc)
+      return DeclarationNameInfo(MemberDecl->getDeclName(), MemberLoc);
     return DeclarationNameInfo(MemberDecl->getDeclName(),
-                               MemberLoc, MemberDNLoc);
+                               MemberLoc, getInternalNameLoc());
   }
 
   bool isArrow() const { return IsArrow; }
@@ -0,0 +1,65 @@
+//===--- ODRHash.h - Content hashing of declarations ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the ODRHash class, which computes a hash of the contents
+/// of a declaration that is stable across AST files.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_ODRHASH_H
+#define LLVM_CLANG_AST_ODRHASH_H
+
+#include "clang/AST/DeclarationName.h"
+#include "clang/AST/Type.h"
+#include "llvm/ADT/FoldingSet.h"
+
+namespace clang {
+
+class ASTContext;
+class CXXRecordDecl;
+class Decl;
+class Stmt;
+class TemplateParameterList;
+
+/// \brief Computes a hash of the contents of a declaration.
+///
+/// The hash only depends on the spelling of the declaration and of the
+/// entities it refers to, never on their addresses, so the same definition
+/// produces the same hash in every module that contains it. Two definitions
+/// with the same hash are (barring collisions) token-for-token equivalent,
+/// which lets the AST reader merge them without comparing them member by
+/// member.
+class ODRHash {
+  const ASTContext &Context;
+  llvm::FoldingSetNodeID ID;
+
+public:
+  explicit ODRHash(const ASTContext &Context) : Context(Context) { }
+
+  /// \brief Add the contents of the given class definition.
+  void AddCXXRecordDecl(const CXXRecordDecl *Record);
+
+  /// \brief Add a declaration that occurs within a definition.
+  void AddSubDecl(const Decl *D);
+
+  void AddQualType(QualType T);
+  void AddDeclarationName(DeclarationName Name);
+  void AddStmt(const Stmt *S);
+  void AddTemplateParameterList(const TemplateParameterList *Params);
+
+  /// \brief Compute the hash of everything added so far.
+  ///
+  /// Zero is reserved to mean "no hash", so it is never returned.
+  unsigned CalculateHash();
+};
+
+} // end namespace clang
+
+#endif
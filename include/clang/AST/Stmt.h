@@ -208,6 +208,7 @@ protected:
     friend class ASTStmtReader; // deserialization
     unsigned : NumExprBits;
 
+    unsigned HasNameLoc : 1;
     unsigned HasQualifier : 1;
     unsigned HasTemplateKWAndArgsInfo : 1;
     unsigned HasFoundDecl : 1;
@@ -339,17 +340,27 @@ private:
   /// \brief Whether statistic collection is enabled.
   static bool StatisticsEnabled;
 
+  /// \brief Record a new statement of class \p SC for -print-stats, if
+  /// statistics are enabled, and in the memory accounting of the current
+  /// thread, if there is one.
+  static void noteStmtClass(StmtClass SC);
+
 protected:
+  /// \brief Record \p Bytes allocated for a statement of class \p SC beyond
+  /// sizeof its class, such as optional trailing objects or an out-of-line
+  /// operand array, like noteStmtClass().
+  static void noteExtraBytes(StmtClass SC, size_t Bytes);
+
   /// \brief Construct an empty statement.
   explicit Stmt(StmtClass SC, EmptyShell) {
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    Stmt::noteStmtClass(SC);
   }
 
 public:
   Stmt(StmtClass SC) {
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    Stmt::noteStmtClass(SC);
   }
 
   StmtClass getStmtClass() const {
@@ -366,6 +377,7 @@ public:
 
   // global temp stats (until we have a per-module visitor)
   static void addStmtClass(const StmtClass s);
+  static void addStmtExtraBytes(const StmtClass s, size_t Bytes);
   static void EnableStatistics();
   static void PrintStats();
 
@@ -433,6 +445,15 @@ public:
   /// written in the source.
   void Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
                bool Canonical) const;
+
+  /// \brief Produce a profile of this statement that does not depend on
+  /// the addresses of the declarations, types and names it refers to.
+  ///
+  /// Two statements with the same spelling produce the same profile even
+  /// when they live in different AST files, which makes the profile usable
+  /// as part of a content hash that is stored in a module file.
+  void ProfileODR(llvm::FoldingSetNodeID &ID,
+                  const ASTContext &Context) const;
 };
 
 /// DeclStmt - Adaptor class for mixing declarations with statements and
@@ -202,6 +202,9 @@ public:
   /// \brief Removes all FileSystemStatCache objects from the manager.
   void clearStatCaches();
 
+  /// \brief Retrieve the first stat cache in the chain, if any.
+  FileSystemStatCache *getStatCache() const { return StatCache.get(); }
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
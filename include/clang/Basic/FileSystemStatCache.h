@@ -18,6 +18,7 @@
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -40,6 +41,8 @@ struct FileData {
   bool InPCH;
 };
 
+class DirectoryListingStatCache;
+
 /// \brief Abstract interface for introducing a FileManager cache for 'stat'
 /// system calls, which is used by precompiled and pretokenized headers to
 /// improve performance.
@@ -83,6 +86,9 @@ public:
   /// ownership of this cache (and, transitively, all of the remaining caches)
   /// to the caller.
   FileSystemStatCache *takeNextStatCache() { return NextStatCache.take(); }
+
+  /// \brief Returns this cache if it is a DirectoryListingStatCache, or null.
+  virtual DirectoryListingStatCache *getAsDirectoryListingCache() { return 0; }
   
 protected:
   virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
@@ -117,6 +123,62 @@ public:
                                vfs::File **F, vfs::FileSystem &FS);
 };
 
+/// \brief A stat "cache" that answers file lookups below a set of registered
+/// directories from a listing of those directories.
+///
+/// Header search probes every search directory for every \#include, and most
+/// of those probes fail. This cache reads each directory once, keeps the set
+/// of entry names, and reports a missing file without going to the file
+/// system when its name does not appear in the listing of its parent.
+/// Lookups that may succeed are always forwarded to the next cache in the
+/// chain, so this cache never produces a positive result on its own.
+///
+/// The listings are shared by every instance in the process, so that
+/// translation units processed one after another (e.g., by libclang) do not
+/// re-read the same directories. Each instance re-validates a listing against
+/// the directory's modification time the first time it uses it.
+class DirectoryListingStatCache : public FileSystemStatCache {
+  /// \brief The absolute directories below which lookups are answered.
+  std::vector<std::string> Roots;
+
+  /// \brief The directories whose shared listing has been validated by this
+  /// instance.
+  llvm::StringSet<> ValidatedDirs;
+
+  // Statistics.
+  unsigned NumMissesAvoided, NumListingsRead;
+
+  bool isBelowRoot(StringRef Dir) const;
+  bool mayExist(StringRef Path, vfs::FileSystem &FS);
+
+public:
+  DirectoryListingStatCache() : NumMissesAvoided(0), NumListingsRead(0) {}
+
+  /// \brief Answer missing-file lookups in \p Dir and its subdirectories from
+  /// the directory listing. Relative paths are ignored.
+  void addDirectory(StringRef Dir);
+
+  /// \brief Forget the registered directories, and validate the listings
+  /// again before using them.
+  void reset();
+
+  /// \brief The number of lookups answered as missing without a system call.
+  unsigned getNumMissesAvoided() const { return NumMissesAvoided; }
+
+  /// \brief The number of directory listings read by this instance.
+  unsigned getNumListingsRead() const { return NumListingsRead; }
+
+  /// \brief Forget all directory listings shared across the process.
+  static void clearSharedListings();
+
+  virtual DirectoryListingStatCache *getAsDirectoryListingCache() {
+    return this;
+  }
+
+  virtual LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                               vfs::File **F, vfs::FileSystem &FS);
+};
+
 } // end namespace clang
 
 #endif
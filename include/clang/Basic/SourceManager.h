@@ -113,13 +113,15 @@ namespace SrcMgr {
 
     /// \brief A bump pointer allocated array of offsets for each source line.
     ///
-    /// This is lazily computed.  This is owned by the SourceManager
-    /// BumpPointerAllocator object.
+    /// This is lazily computed, and only as far into the buffer as line
+    /// information has been requested; see \c LineTableScanEnd.  This is
+    /// owned by the SourceManager BumpPointerAllocator object.
     unsigned *SourceLineCache;
 
-    /// \brief The number of lines in this ContentCache.
+    /// \brief The number of lines in SourceLineCache.
     ///
-    /// This is only valid if SourceLineCache is non-null.
+    /// This is only valid if SourceLineCache is non-null.  Until the whole
+    /// buffer has been scanned, this is the number of lines found so far.
     unsigned NumLines : 31;
 
     /// \brief Indicates whether the buffer itself was provided to override
@@ -132,16 +134,23 @@ namespace SrcMgr {
     /// \brief True if this content cache was initially created for a source
     /// file considered as a system one.
     unsigned IsSystemFile : 1;
+
+    /// \brief The number of entries allocated for SourceLineCache.
+    unsigned LineTableCapacity;
+
+    /// \brief The buffer offset up to which SourceLineCache has been filled
+    /// in.  Every line that starts at or before this offset is in the table.
+    unsigned LineTableScanEnd;
     
     ContentCache(const FileEntry *Ent = 0)
       : Buffer(0, false), OrigEntry(Ent), ContentsEntry(Ent),
         SourceLineCache(0), NumLines(0), BufferOverridden(false),
-        IsSystemFile(false) {}
+        IsSystemFile(false), LineTableCapacity(0), LineTableScanEnd(0) {}
     
     ContentCache(const FileEntry *Ent, const FileEntry *contentEnt)
       : Buffer(0, false), OrigEntry(Ent), ContentsEntry(contentEnt),
         SourceLineCache(0), NumLines(0), BufferOverridden(false),
-        IsSystemFile(false) {}
+        IsSystemFile(false), LineTableCapacity(0), LineTableScanEnd(0) {}
     
     ~ContentCache();
     
@@ -150,7 +159,7 @@ namespace SrcMgr {
     /// is not transferred, so this is a logical error.
     ContentCache(const ContentCache &RHS)
       : Buffer(0, false), SourceLineCache(0), BufferOverridden(false),
-        IsSystemFile(false)
+        IsSystemFile(false), LineTableCapacity(0), LineTableScanEnd(0)
     {
       OrigEntry = RHS.OrigEntry;
       ContentsEntry = RHS.ContentsEntry;
@@ -630,12 +639,25 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// This is referenced by indices from SLocEntryTable.
   LineTableInfo *LineTable;
 
-  /// \brief These ivars serve as a cache used in the getLineNumber
-  /// method which is used to speedup getLineNumber calls to nearby locations.
-  mutable FileID LastLineNoFileIDQuery;
-  mutable SrcMgr::ContentCache *LastLineNoContentCache;
-  mutable unsigned LastLineNoFilePos;
-  mutable unsigned LastLineNoResult;
+  /// \brief The result of a recent getLineNumber query.
+  struct LineNoCacheEntry {
+    FileID FID;
+    SrcMgr::ContentCache *Content;
+    unsigned FilePos;
+    unsigned Result;
+  };
+
+  /// \brief The number of files whose last getLineNumber result is kept.
+  ///
+  /// Diagnostics and debug info tend to alternate between a header and the
+  /// file it was included from, so caching a single file is not enough.
+  enum { NumLineNoCacheEntries = 4 };
+
+  /// \brief A cache used in the getLineNumber method to speed up queries
+  /// for locations near a previous query in the same file.
+  ///
+  /// Entries are kept in most-recently-used order.
+  mutable LineNoCacheEntry LineNoCache[NumLineNoCacheEntries];
 
   /// \brief The file ID for the main source file of the translation unit.
   FileID MainFileID;
@@ -849,6 +871,13 @@ public:
   void overrideFileContents(const FileEntry *SourceFile,
                             const FileEntry *NewFile);
 
+  /// \brief Returns true if the contents of any file have been overridden.
+  bool hasFileOverrides() const {
+    return OverriddenFilesInfo &&
+           (!OverriddenFilesInfo->OverriddenFiles.empty() ||
+            !OverriddenFilesInfo->OverriddenFilesWithBuffer.empty());
+  }
+
   /// \brief Returns true if the file contents have been overridden.
   bool isFileOverridden(const FileEntry *File) {
     if (OverriddenFilesInfo) {
@@ -1560,6 +1589,10 @@ private:
 
   const SrcMgr::SLocEntry &loadSLocEntry(unsigned Index, bool *Invalid) const;
 
+  /// \brief Return the getLineNumber cache entry for the given file, moving
+  /// it to the front of the cache, or null if there is none.
+  LineNoCacheEntry *lookupLineNoCache(FileID FID) const;
+
   /// \brief Get the entry with the given unwrapped FileID.
   const SrcMgr::SLocEntry &getSLocEntryByID(int ID, bool *Invalid = 0) const {
     assert(ID != -1 && "Using FileID sentinel value");
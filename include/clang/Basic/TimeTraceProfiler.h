@@ -0,0 +1,207 @@
+//===--- TimeTraceProfiler.h - Hierarchical frontend profiling --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the clang::TimeTraceProfiler interface, which records
+/// nested, named time intervals for -ftime-trace.
+///
+/// Events currently recorded, outermost first: "ExecuteAction" for each input,
+/// "ReadAST" and "DeserializeDecl" for AST files, "ParseTopLevelDecl", the
+/// template instantiation events of Sema::InstantiatingTemplate,
+/// "PerformPendingInstantiations", "EmitTopLevelDecl", "EmitDeferred" and
+/// "EmitDeferredDecl" in CodeGen, and "Backend" with its pass manager phases.
+/// "Source" events for each included file are recorded on a track of their
+/// own.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+#define LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class SourceManager;
+
+/// \brief Records a tree of timed events, such as the instantiation of each
+/// template or the parsing of each header, along with the memory allocated
+/// while each of them was open.
+///
+/// Events are opened and closed in strict LIFO order with begin() and end(),
+/// usually through a TimeTraceScope. Events that don't nest with the others,
+/// such as the parsing of a file, which can start or end in the middle of a
+/// declaration, are recorded on a separate track, where they only nest with
+/// each other. The result can be written out in the Chrome trace-event
+/// format, with one row per track, or summarized as the most expensive
+/// events.
+///
+/// A profiler is only ever used from one thread; the profiler that
+/// TimeTraceScope reports to is the one made current on that thread with
+/// setCurrent().
+class TimeTraceProfiler {
+public:
+  /// \brief Returns the number of bytes allocated so far by some allocator.
+  typedef size_t (*MemoryCounterFn)(const void *Data);
+
+  /// \brief The tracks on which events are recorded.
+  enum Track {
+    /// \brief Events that are scoped to a function call.
+    MainTrack,
+    /// \brief The "Source" events of the files being parsed.
+    SourceTrack,
+    NumTracks
+  };
+
+private:
+  struct Event {
+    /// \brief The kind of event, interned in EventNames.
+    StringRef Name;
+    /// \brief What the event applies to, e.g. the template specialization.
+    std::string Detail;
+    /// \brief Where in the source the event applies, as "file:line:col".
+    std::string Location;
+    /// \brief Start time and duration, in microseconds since the profiler
+    /// was created.
+    uint64_t Start, Duration;
+    /// \brief Time spent in events nested within this one, in microseconds.
+    uint64_t ChildDuration;
+    /// \brief Memory allocated while the event was open. Holds the counter
+    /// value at begin() until the event ends.
+    int64_t Bytes;
+    /// \brief The index of the enclosing event on the same track, or ~0U for
+    /// a top-level one.
+    unsigned Parent;
+    /// \brief The track the event is recorded on.
+    Track EventTrack;
+  };
+
+  std::vector<Event> Events;
+  SmallVector<unsigned, 16> OpenEvents[NumTracks];
+  llvm::StringMap<char> EventNames;
+
+  /// \brief Time at which the profiler was created, in microseconds.
+  uint64_t StartTime;
+
+  /// \brief Events shorter than this, in microseconds, are dropped unless
+  /// they enclose events that are kept.
+  uint64_t Granularity;
+
+  MemoryCounterFn MemoryCounter;
+  const void *MemoryCounterData;
+
+  uint64_t now() const;
+  int64_t allocatedBytes() const {
+    return MemoryCounter ? (int64_t)MemoryCounter(MemoryCounterData) : 0;
+  }
+  bool isOpen(unsigned Index) const;
+
+  TimeTraceProfiler(const TimeTraceProfiler &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceProfiler &) LLVM_DELETED_FUNCTION;
+
+public:
+  TimeTraceProfiler();
+  ~TimeTraceProfiler();
+
+  /// \brief Returns the profiler that events on the current thread are
+  /// reported to, or null if profiling is disabled.
+  static TimeTraceProfiler *getCurrent();
+
+  /// \brief Make \p Profiler (which may be null) the one that events on the
+  /// current thread are reported to.
+  static void setCurrent(TimeTraceProfiler *Profiler);
+
+  /// \brief Open a new event nested within the innermost open event of
+  /// track \p T.
+  void begin(StringRef Name, StringRef Detail = StringRef(),
+             Track T = MainTrack);
+
+  /// \brief Close the innermost open event of track \p T.
+  void end(Track T = MainTrack);
+
+  /// \brief Set what the innermost open event of track \p T applies to, when
+  /// it is only known once the event is under way.
+  void setDetail(StringRef Detail, Track T = MainTrack);
+
+  /// \brief Set the source location of the innermost open event of track
+  /// \p T.
+  void setLocation(StringRef Location, Track T = MainTrack);
+
+  /// \brief Drop events shorter than \p Microseconds that don't enclose
+  /// longer events, to keep traces of large translation units manageable.
+  void setGranularity(uint64_t Microseconds) { Granularity = Microseconds; }
+
+  /// \brief Format \p Loc as "file:line:col", or return an empty string if
+  /// it is invalid.
+  static std::string getLocationString(SourceLocation Loc,
+                                       const SourceManager &SM);
+
+  /// \brief Set the counter used to attribute memory to events, or clear it
+  /// if \p Counter is null. Events that are open at that point keep the
+  /// memory counted so far, and count further allocations with the new
+  /// counter.
+  void setMemoryCounter(MemoryCounterFn Counter, const void *Data);
+
+  /// \brief Returns the data passed along with the current memory counter.
+  const void *getMemoryCounterData() const { return MemoryCounterData; }
+
+  /// \brief Write all closed events as a Chrome trace-event JSON document,
+  /// suitable for chrome://tracing.
+  void write(raw_ostream &OS) const;
+
+  /// \brief Print the total time spent in each kind of event, and the \p N
+  /// events that took the longest, with events applying to the same entity
+  /// aggregated.
+  void printSummary(raw_ostream &OS, unsigned N) const;
+};
+
+/// \brief Records an event, in the current thread's profiler, for the
+/// lifetime of this object.
+class TimeTraceScope {
+  TimeTraceProfiler *Profiler;
+
+  TimeTraceScope(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+    : Profiler(TimeTraceProfiler::getCurrent()) {
+    if (Profiler)
+      Profiler->begin(Name, Detail);
+  }
+  ~TimeTraceScope() {
+    if (Profiler)
+      Profiler->end();
+  }
+
+  /// \brief Whether the event is being recorded. Callers should only compute
+  /// details and locations when it is.
+  bool isActive() const { return Profiler != 0; }
+
+  void setDetail(StringRef Detail) {
+    if (Profiler)
+      Profiler->setDetail(Detail);
+  }
+
+  void setLocation(SourceLocation Loc, const SourceManager &SM) {
+    if (Profiler)
+      Profiler->setLocation(TimeTraceProfiler::getLocationString(Loc, SM));
+  }
+};
+
+} // end namespace clang
+
+#endif
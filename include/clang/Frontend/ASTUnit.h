@@ -414,6 +414,10 @@ private:
   /// inconsistent state, and is not safe to free.
   unsigned UnsafeToFree : 1;
 
+  /// \brief Whether all lazily-computed AST state has been computed, so
+  /// that the AST can be read from several threads at once.
+  unsigned Frozen : 1;
+
   /// \brief Cache any "global" code-completion results, so that we can avoid
   /// recomputing them with each completion.
   void CacheCodeCompletionResults();
@@ -485,6 +489,10 @@ public:
   bool isUnsafeToFree() const { return UnsafeToFree; }
   void setUnsafeToFree(bool Value) { UnsafeToFree = Value; }
 
+  /// \brief Whether freeze() has been called since the translation unit was
+  /// last parsed.
+  bool isFrozen() const { return Frozen; }
+
   const DiagnosticsEngine &getDiagnostics() const { return *Diagnostics; }
   DiagnosticsEngine &getDiagnostics()             { return *Diagnostics; }
   
@@ -832,6 +840,24 @@ public:
   /// contain any translation-unit information, false otherwise.  
   bool Reparse(ArrayRef<RemappedFile> RemappedFiles = None);
 
+  /// \brief Compute all of the AST state that is otherwise computed lazily,
+  /// so that the AST can afterwards be traversed from several threads at
+  /// once.
+  ///
+  /// This deserializes everything in the AST files this translation unit
+  /// depends on (declarations, types, function bodies, base classes and
+  /// lookup tables), realizes the top-level declarations of the preamble,
+  /// and computes the layout and size of every complete type. Afterwards
+  /// read-only traversal of the declarations and types in the AST does not
+  /// modify any shared state.
+  ///
+  /// Source locations are not covered: the source manager caches the result
+  /// of location lookups, so queries that decompose or compare source
+  /// locations must still be serialized by the client.
+  ///
+  /// The translation unit stays frozen until it is reparsed.
+  void freeze();
+
   /// \brief Perform code completion at the given file, line, and
   /// column within this translation unit.
   ///
@@ -44,6 +44,7 @@ protected:
   virtual uint32_t GetNumExternalSelectors();
   virtual Stmt *GetExternalDeclStmt(uint64_t Offset);
   virtual CXXBaseSpecifier *GetExternalCXXBaseSpecifiers(uint64_t Offset);
+  virtual CXXCtorInitializer **GetExternalCXXCtorInitializers(uint64_t Offset);
   virtual bool FindExternalVisibleDeclsByName(const DeclContext *DC,
                                               DeclarationName Name);
   virtual ExternalLoadResult FindExternalLexicalDecls(const DeclContext *DC,
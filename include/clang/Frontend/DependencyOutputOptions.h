@@ -15,6 +15,12 @@
 
 namespace clang {
 
+/// DependencyOutputFormat - The formats in which dependencies can be written.
+enum DependencyOutputFormat {
+  DOF_Make, ///< A Makefile rule, as written by GCC.
+  DOF_JSON  ///< A JSON object listing the targets and the dependencies.
+};
+
 /// DependencyOutputOptions - Options for controlling the compiler dependency
 /// file generation.
 class DependencyOutputOptions {
@@ -26,6 +32,9 @@ public:
                                      /// problems.
   unsigned AddMissingHeaderDeps : 1; ///< Add missing headers to dependency list
   unsigned PrintShowIncludes : 1; ///< Print cl.exe style /showIncludes info.
+
+  /// The format of the dependency output.
+  DependencyOutputFormat OutputFormat;
   
   /// The file to write dependency output to.
   std::string OutputFile;
@@ -50,6 +59,7 @@ public:
     UsePhonyTargets = 0;
     AddMissingHeaderDeps = 0;
     PrintShowIncludes = 0;
+    OutputFormat = DOF_Make;
   }
 };
 
@@ -227,6 +227,17 @@ protected:
   void ExecuteAction();
 };
 
+/// \brief Runs the preprocessor only as far as needed to compute the
+/// dependencies of the input, e.g. for -MD output.
+///
+/// Macros are expanded only inside directives; the tokens of the rest of the
+/// file are lexed but never expanded. As a consequence, _Pragma operators
+/// outside of directives are not executed.
+class DependencyScanAction : public PreprocessorFrontendAction {
+protected:
+  void ExecuteAction();
+};
+
 class PrintPreprocessedAction : public PreprocessorFrontendAction {
 protected:
   void ExecuteAction();
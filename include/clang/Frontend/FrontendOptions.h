@@ -54,6 +54,7 @@ namespace frontend {
     RewriteTest,            ///< Rewriter playground
     RunAnalysis,            ///< Run one or more source code analyses.
     MigrateSource,          ///< Run migrator.
+    RunDependencyScan,      ///< Preprocess for dependency output only.
     RunPreprocessorOnly     ///< Just lex, no output.
   };
 }
@@ -238,6 +239,22 @@ public:
   /// \brief File name of the file that will provide record layouts
   /// (in the format produced by -fdump-record-layouts).
   std::string OverrideRecordLayoutsFile;
+
+  /// \brief If given, the file to write a Chrome trace-event profile of the
+  /// frontend to.
+  std::string TimeTracePath;
+
+  /// \brief If nonzero, print this many of the most expensive -ftime-trace
+  /// events.
+  unsigned TimeTraceSummary;
+
+  /// \brief The minimum duration, in microseconds, of the -ftime-trace events
+  /// that are kept.
+  unsigned TimeTraceGranularity;
+
+  /// \brief If given, the file to write the -fast-memory-report breakdown of
+  /// the AST memory to.
+  std::string ASTMemoryReportPath;
   
 public:
   FrontendOptions() :
@@ -248,7 +265,8 @@ public:
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpLookups(false),
     ARCMTAction(ARCMT_None), ObjCMTAction(ObjCMT_None),
-    ProgramAction(frontend::ParseSyntaxOnly)
+    ProgramAction(frontend::ParseSyntaxOnly), TimeTraceSummary(0),
+    TimeTraceGranularity(0)
   {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
@@ -30,6 +30,7 @@ class ArgList;
 
 namespace clang {
 class ASTConsumer;
+class ASTMemoryAccounting;
 class CompilerInstance;
 class CompilerInvocation;
 class Decl;
@@ -47,6 +48,7 @@ class PreprocessorOutputOptions;
 class SourceManager;
 class Stmt;
 class TargetInfo;
+class TimeTraceProfiler;
 class FrontendOptions;
 
 /// Apply the header search options to get given HeaderSearch object.
@@ -77,6 +79,13 @@ void DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream* OS,
 void AttachDependencyFileGen(Preprocessor &PP,
                              const DependencyOutputOptions &Opts);
 
+/// AttachDependencyFileGen - Create a dependency file generator that writes
+/// to \p OS instead of Opts.OutputFile, and attach it to the given
+/// preprocessor.  The stream must outlive the preprocessor.
+void AttachDependencyFileGen(Preprocessor &PP,
+                             const DependencyOutputOptions &Opts,
+                             raw_ostream &OS);
+
 /// AttachDependencyGraphGen - Create a dependency graph generator, and attach
 /// it to the given preprocessor.
   void AttachDependencyGraphGen(Preprocessor &PP, StringRef OutputFile,
@@ -97,6 +106,17 @@ void AttachHeaderIncludeGen(Preprocessor &PP, bool ShowAllHeaders = false,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// AttachHeaderTimeTrace - Record the time spent in each file included by the
+/// main source file, and the files they include, as "Source" events of the
+/// given profiler.
+void AttachHeaderTimeTrace(Preprocessor &PP, TimeTraceProfiler &Profiler);
+
+/// AttachHeaderMemoryAccounting - Attribute the AST memory allocated while
+/// each file of the translation unit is parsed to that file, for
+/// -fast-memory-report.
+void AttachHeaderMemoryAccounting(Preprocessor &PP,
+                                  ASTMemoryAccounting &Accounting);
+
 /// CacheTokens - Cache tokens for use with PCH. Note that this requires
 /// a seekable stream.
 void CacheTokens(Preprocessor &PP, llvm::raw_fd_ostream* OS);
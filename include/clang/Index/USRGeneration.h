@@ -12,6 +12,7 @@
 
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
 
 namespace clang {
   class Decl;
@@ -47,6 +48,17 @@ void generateUSRForObjCProperty(StringRef Prop, raw_ostream &OS);
 /// \brief Generate a USR fragment for an Objective-C protocol.
 void generateUSRForObjCProtocol(StringRef Prot, raw_ostream &OS);
 
+/// \brief A 128-bit hash of a USR that is stable across runs and hosts, so
+/// that it can be stored in persistent indexes. The low half can be used on
+/// its own as a 64-bit hash.
+struct USRHash {
+  uint64_t Low;
+  uint64_t High;
+};
+
+/// \brief Compute the stable hash of \p USR.
+USRHash hashUSR(StringRef USR);
+
 } // namespace index
 } // namespace clang
 
@@ -15,10 +15,15 @@
 #define LLVM_CLANG_LEX_HEADERMAP_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/system_error.h"
+#include <string>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
+  class raw_ostream;
 }
 namespace clang {
   class FileEntry;
@@ -30,15 +35,21 @@ namespace clang {
 /// \#include file resolution process, it basically acts like a directory of
 /// symlinks to files.  Its advantages are that it is dense and more efficient
 /// to create and process than a directory of symlinks.
+///
+/// Besides the classic format, which uses linear probing, a header map may use
+/// the extended format written by HeaderMapBuilder::PerfectHash. It stores a
+/// displacement table after the buckets so that every lookup probes exactly
+/// one bucket, regardless of the number of entries.
 class HeaderMap {
   HeaderMap(const HeaderMap &) LLVM_DELETED_FUNCTION;
   void operator=(const HeaderMap &) LLVM_DELETED_FUNCTION;
 
   const llvm::MemoryBuffer *FileBuffer;
   bool NeedsBSwap;
+  bool IsPerfectHash;
 
-  HeaderMap(const llvm::MemoryBuffer *File, bool BSwap)
-    : FileBuffer(File), NeedsBSwap(BSwap) {
+  HeaderMap(const llvm::MemoryBuffer *File, bool BSwap, bool PerfectHash)
+    : FileBuffer(File), NeedsBSwap(BSwap), IsPerfectHash(PerfectHash) {
   }
 public:
   ~HeaderMap();
@@ -47,6 +58,11 @@ public:
   /// map.  If it doesn't look like a HeaderMap, it gives up and returns null.
   static const HeaderMap *Create(const FileEntry *FE, FileManager &FM);
 
+  /// \brief Attempts to interpret the given buffer as a header map. On
+  /// success the header map takes ownership of the buffer; otherwise the
+  /// buffer is deleted and null is returned.
+  static const HeaderMap *Create(const llvm::MemoryBuffer *Buffer);
+
   /// LookupFile - Check to see if the specified relative filename is located in
   /// this HeaderMap.  If so, open it and return its FileEntry.
   /// If RawPath is not NULL and the file is found, RawPath will be set to the
@@ -70,9 +86,54 @@ private:
   unsigned getEndianAdjustedWord(unsigned X) const;
   const HMapHeader &getHeader() const;
   HMapBucket getBucket(unsigned BucketNo) const;
+  unsigned getDisplacement(unsigned GroupNo) const;
   const char *getString(unsigned StrTabIdx) const;
 };
 
+/// \brief Produces the contents of a header map file.
+///
+/// A build system can use this to replace a long list of -I directories with
+/// a single header map, turning each \#include lookup into a hash probe.
+class HeaderMapBuilder {
+public:
+  /// \brief The on-disk layout to produce.
+  enum FormatKind {
+    /// The classic (version 1) format, readable by any header map consumer.
+    Classic,
+    /// The extended (version 2) format, whose lookups probe a single bucket.
+    PerfectHash
+  };
+
+private:
+  struct Entry {
+    std::string Key;
+    std::string Prefix;
+    std::string Suffix;
+  };
+
+  std::vector<Entry> Entries;
+
+  /// \brief Maps the lowercased keys to their index in Entries.
+  llvm::StringMap<unsigned> KeyIndex;
+
+public:
+  /// \brief Map \p Key to the path formed by concatenating \p Prefix and
+  /// \p Suffix. Keys are case-insensitive; the first mapping for a key wins.
+  ///
+  /// \returns true if the mapping was added, false if the key already had one.
+  bool addMapping(StringRef Key, StringRef Prefix, StringRef Suffix);
+
+  /// \brief Map the relative path of every file below \p Dir to its location
+  /// inside \p Dir, as if \p Dir were the next directory in the search path.
+  llvm::error_code addDirectory(StringRef Dir);
+
+  /// \brief The number of mappings added so far.
+  unsigned size() const { return Entries.size(); }
+
+  /// \brief Write the header map to \p OS, in host byte order.
+  void write(llvm::raw_ostream &OS, FormatKind Format) const;
+};
+
 } // end namespace clang.
 
 #endif
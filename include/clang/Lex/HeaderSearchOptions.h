@@ -125,6 +125,21 @@ public:
   /// loading.
   uint64_t BuildSessionTimestamp;
 
+  /// \brief The number of modules that may be built concurrently.
+  ///
+  /// When this is greater than one and a module needs to be built, the
+  /// dependencies named in its module map that have no module file yet are
+  /// built first, in parallel, by independent compiler instances.
+  unsigned ModuleBuildJobs;
+
+  /// \brief A file whose contents stand for the state of all input files of
+  /// precompiled headers and modules.
+  ///
+  /// AST files record a hash of this file when they're written. When the
+  /// hash still matches on load, the input files aren't stat'ed. The build
+  /// system is responsible for changing this file whenever an input changes.
+  std::string InputSignatureFile;
+
   /// \brief The set of macro names that should be ignored for the purposes
   /// of computing the module hash.
   llvm::SetVector<std::string> ModulesIgnoreMacros;
@@ -155,16 +170,26 @@ public:
   /// \c BuildSessionTimestamp).
   unsigned ModulesValidateOncePerBuildSession : 1;
 
+  /// \brief If true, answer lookups of missing headers in the search
+  /// directories from cached directory listings instead of stat'ing them.
+  unsigned UseDirectoryListingCache : 1;
+
+  /// \brief If true, validate the input files of each AST file only the
+  /// first time the AST file is loaded in this process.
+  unsigned ValidateASTInputsOncePerProcess : 1;
+
 public:
   HeaderSearchOptions(StringRef _Sysroot = "/")
     : Sysroot(_Sysroot), DisableModuleHash(0), ModuleMaps(0),
       ModuleCachePruneInterval(7*24*60*60),
       ModuleCachePruneAfter(31*24*60*60),
-      BuildSessionTimestamp(0),
+      BuildSessionTimestamp(0), ModuleBuildJobs(1),
       UseBuiltinIncludes(true),
       UseStandardSystemIncludes(true), UseStandardCXXIncludes(true),
       UseLibcxx(false), Verbose(false),
-      ModulesValidateOncePerBuildSession(false) {}
+      ModulesValidateOncePerBuildSession(false),
+      UseDirectoryListingCache(false),
+      ValidateASTInputsOncePerProcess(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
@@ -82,6 +82,10 @@ public:
   /// stream into an array of specifiers.
   virtual CXXBaseSpecifier *GetExternalCXXBaseSpecifiers(uint64_t Offset);
 
+  /// \brief Resolve the offset of a set of C++ constructor initializers in
+  /// the decl stream into an array of initializers.
+  virtual CXXCtorInitializer **GetExternalCXXCtorInitializers(uint64_t Offset);
+
   /// \brief Find all declarations with the given name in the
   /// given context.
   virtual bool
@@ -91,6 +95,9 @@ public:
   /// context is up to date.
   virtual void completeVisibleDeclsMap(const DeclContext *DC);
 
+  /// \brief Load everything that the sources can provide.
+  virtual void completeAllDeclarations();
+
   /// \brief Finds all declarations lexically contained within the given
   /// DeclContext, after applying an optional filter predicate.
   ///
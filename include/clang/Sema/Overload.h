@@ -23,6 +23,8 @@
 #include "clang/AST/UnresolvedSet.h"
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Allocator.h"
@@ -713,6 +715,25 @@ namespace clang {
     unsigned NumInlineSequences;
     char InlineSpace[16 * sizeof(ImplicitConversionSequence)];
 
+    /// \brief A call argument, along with whether user-defined and explicit
+    /// conversions were allowed, and the parameter type it was converted to.
+    typedef std::pair<llvm::PointerIntPair<Expr *, 2>, QualType> ConversionKey;
+
+    /// \brief The conversion sequences computed so far for the arguments of
+    /// this call. Candidates often share parameter types (think of the first
+    /// parameter of every operator<< for std::ostream), so each conversion
+    /// only needs to be computed once per set.
+    llvm::DenseMap<ConversionKey, ImplicitConversionSequence> ConversionCache;
+
+    static ConversionKey getConversionKey(Expr *Arg, QualType ParamType,
+                                          bool SuppressUserConversions,
+                                          bool AllowExplicit) {
+      return ConversionKey(
+          llvm::PointerIntPair<Expr *, 2>(
+              Arg, SuppressUserConversions | (AllowExplicit << 1)),
+          ParamType);
+    }
+
     OverloadCandidateSet(const OverloadCandidateSet &) LLVM_DELETED_FUNCTION;
     void operator=(const OverloadCandidateSet &) LLVM_DELETED_FUNCTION;
 
@@ -733,6 +754,28 @@ namespace clang {
     /// \brief Clear out all of the candidates.
     void clear();
 
+    /// \brief Retrieve the conversion sequence computed for another candidate
+    /// to pass \p Arg to a parameter of type \p ParamType, if any.
+    const ImplicitConversionSequence *
+    findConversion(Expr *Arg, QualType ParamType, bool SuppressUserConversions,
+                   bool AllowExplicit) const {
+      llvm::DenseMap<ConversionKey, ImplicitConversionSequence>::const_iterator
+        Pos = ConversionCache.find(getConversionKey(Arg, ParamType,
+                                                SuppressUserConversions,
+                                                AllowExplicit));
+      return Pos == ConversionCache.end() ? 0 : &Pos->second;
+    }
+
+    /// \brief Remember the conversion sequence for passing \p Arg to a
+    /// parameter of type \p ParamType, for the other candidates.
+    void addConversion(Expr *Arg, QualType ParamType,
+                       bool SuppressUserConversions, bool AllowExplicit,
+                       const ImplicitConversionSequence &ICS) {
+      ConversionCache.insert(std::make_pair(
+          getConversionKey(Arg, ParamType, SuppressUserConversions,
+                           AllowExplicit), ICS));
+    }
+
     typedef SmallVectorImpl<OverloadCandidate>::iterator iterator;
     iterator begin() { return Candidates.begin(); }
     iterator end() { return Candidates.end(); }
@@ -161,6 +161,7 @@ namespace clang {
   class TemplateParameterList;
   class TemplatePartialOrderingContext;
   class TemplateTemplateParmDecl;
+  class TimeTraceProfiler;
   class Token;
   class TypeAliasDecl;
   class TypedefDecl;
@@ -788,6 +789,41 @@ public:
   /// for C++ records.
   llvm::FoldingSet<SpecialMemberOverloadResult> SpecialMemberCache;
 
+  /// \brief A failed deduction of a function template's arguments from the
+  /// arguments of a call, along with the information needed to diagnose it.
+  class CachedDeductionFailure : public llvm::FastFoldingSetNode {
+  public:
+    CachedDeductionFailure(const llvm::FoldingSetNodeID &ID)
+      : FastFoldingSetNode(ID), Result(0), Param(0), Deduced(0),
+        HasSFINAEDiagnostic(false),
+        SFINAEDiagnostic(SourceLocation(), PartialDiagnostic::NullDiagnostic())
+    {}
+
+    /// \brief A Sema::TemplateDeductionResult.
+    unsigned Result;
+    /// \brief The opaque value of the template parameter the failure
+    /// refers to, if any.
+    void *Param;
+    TemplateArgument FirstArg, SecondArg;
+    TemplateArgumentList *Deduced;
+    bool HasSFINAEDiagnostic;
+    PartialDiagnosticAt SFINAEDiagnostic;
+  };
+
+  /// \brief A cache of template argument deduction failures from calls,
+  /// keyed by the function template, its explicitly-specified template
+  /// arguments and the canonical types and value categories of the call
+  /// arguments.
+  ///
+  /// Only deductions whose arguments are all non-dependent are cached. The
+  /// cache is flushed whenever a declaration that could change the outcome
+  /// of a substitution, such as a new overload or the completion of a class,
+  /// is introduced.
+  llvm::FoldingSet<CachedDeductionFailure> DeductionFailureCache;
+
+  /// \brief Discard all cached template argument deduction failures.
+  void clearDeductionFailureCache();
+
   /// \brief The kind of translation unit we are processing.
   ///
   /// When we're processing a complete translation unit, Sema will perform
@@ -802,6 +838,19 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of overload candidates rejected for their number of
+  /// parameters, without attempting conversions or template argument
+  /// deduction.
+  unsigned NumOverloadCandidatesPruned;
+
+  /// \brief The number of argument conversions reused from another candidate
+  /// in the same overload candidate set.
+  unsigned NumOverloadConversionsReused;
+
+  /// \brief The number of template argument deductions that were answered
+  /// from DeductionFailureCache.
+  unsigned NumDeductionFailuresReused;
+
   typedef llvm::DenseMap<ParmVarDecl *, SmallVector<ParmVarDecl *, 1> >
     UnparsedDefaultArgInstantiationsMap;
 
@@ -920,6 +969,11 @@ public:
 
   void PrintStats() const;
 
+  /// \brief Return the memory used by the side tables of Sema, such as the
+  /// pending instantiations and the special member and deduction failure
+  /// caches.
+  size_t getSideTableAllocatedMemory() const;
+
   /// \brief Helper class that creates diagnostics with optional
   /// template instantiation stacks.
   ///
@@ -5914,6 +5968,12 @@ public:
                           FunctionDecl *&Specialization,
                           sema::TemplateDeductionInfo &Info);
 
+  TemplateDeductionResult
+  DeduceCallTemplateArgumentsUncached(
+      FunctionTemplateDecl *FunctionTemplate,
+      TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
+      FunctionDecl *&Specialization, sema::TemplateDeductionInfo &Info);
+
   TemplateDeductionResult
   DeduceTemplateArguments(FunctionTemplateDecl *FunctionTemplate,
                           TemplateArgumentListInfo *ExplicitTemplateArgs,
@@ -6309,8 +6369,12 @@ public:
     Sema &SemaRef;
     bool Invalid;
     bool SavedInNonInstantiationSFINAEContext;
+    /// \brief The profiler recording this instantiation for -ftime-trace,
+    /// if any.
+    TimeTraceProfiler *Profiler;
     bool CheckInstantiationDepth(SourceLocation PointOfInstantiation,
                                  SourceRange InstantiationRange);
+    void BeginTimeTrace();
 
     InstantiatingTemplate(const InstantiatingTemplate&) LLVM_DELETED_FUNCTION;
 
@@ -35,7 +35,26 @@ namespace clang {
     /// Version 4 of AST files also requires that the version control branch and
     /// revision match exactly, since there is no backward compatibility of
     /// AST files at this time.
-    const unsigned VERSION_MAJOR = 5;
+    ///
+    /// Version 6 stores the redeclaration chains and Objective-C category
+    /// lists as blobs of 32-bit declaration IDs, so that they can be used in
+    /// place from the mapped AST file.
+    ///
+    /// Version 7 adds the ODR hash of each C++ class definition to its
+    /// definition data, so that identical definitions merged from different
+    /// modules need not be compared member by member.
+    ///
+    /// Version 8 adds a HasNameLoc flag to EXPR_DECL_REF records, after
+    /// RefersToEnclosingLocal, and writes the DeclarationNameLoc of the
+    /// reference only when that flag is set. EXPR_MEMBER records are
+    /// unchanged.
+    ///
+    /// Version 8 also stores the initializer list of each constructor in its
+    /// own DECL_CXX_CTOR_INITIALIZERS record, found through the
+    /// CXX_CTOR_INITIALIZERS_OFFSETS table. A DECL_CXX_CONSTRUCTOR record
+    /// holds the number of initializers followed, when there are any, by the
+    /// ID of that record instead of the initializers themselves.
+    const unsigned VERSION_MAJOR = 8;
 
     /// \brief AST file minor version number supported by this version of
     /// Clang.
@@ -149,6 +168,10 @@ namespace clang {
     /// \brief An ID number that refers to a set of CXXBaseSpecifiers in an 
     /// AST file.
     typedef uint32_t CXXBaseSpecifiersID;
+
+    /// \brief An ID number that refers to a list of CXXCtorInitializers in an
+    /// AST file.
+    typedef uint32_t CXXCtorInitializersID;
     
     /// \brief An ID number that refers to an entity in the detailed
     /// preprocessing record.
@@ -284,7 +307,11 @@ namespace clang {
       HEADER_SEARCH_OPTIONS = 11,
 
       /// \brief Record code for the preprocessor options table.
-      PREPROCESSOR_OPTIONS = 12
+      PREPROCESSOR_OPTIONS = 12,
+
+      /// \brief Record code for the hash of the input signature file the
+      /// AST file was built against (see -finput-signature-file).
+      INPUT_SIGNATURE = 13
     };
 
     /// \brief Record types that occur within the input-files block
@@ -512,14 +539,14 @@ namespace clang {
       /// \brief Record code for the array of redeclaration chains.
       ///
       /// This array can only be interpreted properly using the local 
-      /// redeclarations map.
+      /// redeclarations map. It is stored as a blob of 32-bit values.
       LOCAL_REDECLARATIONS = 45,
       
       /// \brief Record code for the array of Objective-C categories (including
       /// extensions).
       ///
       /// This array can only be interpreted properly using the Objective-C
-      /// categories map.
+      /// categories map. It is stored as a blob of 32-bit values.
       OBJC_CATEGORIES = 46,
 
       /// \brief Record code for the table of offsets of each macro ID.
@@ -538,7 +565,16 @@ namespace clang {
       UNDEFINED_BUT_USED = 49,
 
       /// \brief Record code for late parsed template functions.
-      LATE_PARSED_TEMPLATE = 50
+      LATE_PARSED_TEMPLATE = 50,
+
+      /// \brief Record code for the Bloom filter over the names in the
+      /// IDENTIFIER_TABLE, which lets lookups of identifiers that are not in
+      /// this AST file skip its identifier table.
+      IDENTIFIER_BLOOM_FILTER = 51,
+
+      /// \brief Record code for the offsets of the constructor initializer
+      /// lists that are deserialized on demand.
+      CXX_CTOR_INITIALIZERS_OFFSETS = 52
     };
 
     /// \brief Record types used within a source manager block.
@@ -1074,7 +1110,9 @@ namespace clang {
       /// \brief An OMPThreadPrivateDecl record.
       DECL_OMP_THREADPRIVATE,
       /// \brief An EmptyDecl record.
-      DECL_EMPTY
+      DECL_EMPTY,
+      /// \brief A record containing CXXCtorInitializers.
+      DECL_CXX_CTOR_INITIALIZERS
     };
 
     /// \brief Record codes for each kind of statement or expression.
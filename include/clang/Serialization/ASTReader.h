@@ -797,6 +797,10 @@ private:
   /// \brief The number of lookups into identifier tables that succeed.
   unsigned NumIdentifierLookupHits;
 
+  /// \brief The number of lookups into identifier tables that were avoided
+  /// because the table's Bloom filter ruled the identifier out.
+  unsigned NumIdentifierLookupsFiltered;
+
   /// \brief The number of selectors that have been read.
   unsigned NumSelectorsRead;
 
@@ -843,6 +847,38 @@ private:
   /// Number of CXX base specifiers currently loaded
   unsigned NumCXXBaseSpecifiersLoaded;
 
+  /// \brief The number of function and method bodies whose deserialization
+  /// was deferred until they are requested.
+  unsigned NumLazyBodies;
+
+  /// \brief The number of deferred function and method bodies that have
+  /// actually been deserialized.
+  unsigned NumLazyBodiesRead;
+
+  /// \brief The number of constructor initializer lists in the loaded AST
+  /// files, and the number of those that have been deserialized.
+  unsigned TotalNumCXXCtorInitializers, NumCXXCtorInitializersRead;
+
+  /// \brief The number of class definitions that were merged into an
+  /// existing definition, and the number of those that were identified as
+  /// identical by their content hash.
+  unsigned NumMergedDefinitions, NumMergedDefinitionsByHash;
+
+  /// \brief The number of AST files whose input files were not checked
+  /// because their input signature matched.
+  unsigned NumInputValidationsBySignature;
+
+  /// \brief The number of AST files whose input files were not checked
+  /// because this process had already validated them.
+  unsigned NumInputValidationsCached;
+
+  /// \brief The hash of the current input signature file, once computed.
+  std::pair<uint64_t, uint64_t> CurrentInputSignature;
+
+  /// \brief Whether \c CurrentInputSignature has been computed, and whether
+  /// that succeeded.
+  bool ComputedInputSignature, HasCurrentInputSignature;
+
   /// \brief The set of identifiers that were read while the AST reader was
   /// (recursively) loading declarations.
   ///
@@ -943,6 +979,13 @@ private:
   /// when merging implicit instantiations of class templates across modules.
   llvm::DenseMap<DeclContext *, DeclContext *> MergedDeclContexts;
 
+  /// \brief The merged class definitions (keys of MergedDeclContexts) whose
+  /// content hash matches that of the definition they were merged into.
+  ///
+  /// Such definitions are identical to the canonical definition, so their
+  /// members do not need to be checked for ODR violations.
+  llvm::SmallPtrSet<DeclContext *, 16> IdenticalMergedDefinitions;
+
   /// \brief A mapping from canonical declarations of enums to their canonical
   /// definitions. Only populated when using modules in C++.
   llvm::DenseMap<EnumDecl *, EnumDecl *> EnumDefinitions;
@@ -1015,6 +1058,7 @@ private:
                             SmallVectorImpl<ImportedModule> &Loaded,
                             off_t ExpectedSize, time_t ExpectedModTime,
                             unsigned ClientLoadCapabilities);
+  bool matchesInputSignature(ModuleFile &F);
   ASTReadResult ReadControlBlock(ModuleFile &F,
                                  SmallVectorImpl<ImportedModule> &Loaded,
                                  unsigned ClientLoadCapabilities);
@@ -1335,6 +1379,13 @@ public:
                                       FileManager &FileMgr,
                                       ASTReaderListener &Listener);
 
+  /// \brief Compute the signature stored in AST files for the given input
+  /// signature file.
+  ///
+  /// \returns true if the file could not be read.
+  static bool computeInputSignature(StringRef Filename,
+                                    std::pair<uint64_t, uint64_t> &Signature);
+
   /// \brief Determine whether the given AST file is acceptable to load into a
   /// translation unit with the given language and target options.
   static bool isAcceptableASTFile(StringRef Filename,
@@ -1531,6 +1582,13 @@ public:
 
   virtual CXXBaseSpecifier *GetExternalCXXBaseSpecifiers(uint64_t Offset);
 
+  /// \brief Read a CXXCtorInitializers ID from the given record and
+  /// return its global bit offset.
+  uint64_t readCXXCtorInitializersRef(ModuleFile &M, const RecordData &Record,
+                                      unsigned &Idx);
+
+  virtual CXXCtorInitializer **GetExternalCXXCtorInitializers(uint64_t Offset);
+
   /// \brief Resolve the offset of a statement into a statement.
   ///
   /// This operation will read a new statement from the external
@@ -1922,6 +1980,10 @@ public:
   /// \brief Load all external visible decls in the given DeclContext.
   void completeVisibleDeclsMap(const DeclContext *DC);
 
+  /// \brief Load every type, declaration and identifier in the loaded AST
+  /// files.
+  virtual void completeAllDeclarations();
+
   /// \brief Retrieve the AST context that this AST reader supplements.
   ASTContext &getContext() { return Context; }
 
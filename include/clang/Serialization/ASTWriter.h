@@ -123,6 +123,13 @@ private:
   /// \brief Indicates that the AST contained compiler errors.
   bool ASTHasCompilerErrors;
 
+  /// \brief The number of bits written for each part of the AST file, in
+  /// the order in which the parts were written.
+  SmallVector<std::pair<const char *, uint64_t>, 16> PartSizes;
+
+  /// \brief The total number of bits in the last AST file written.
+  uint64_t TotalBitsWritten;
+
   /// \brief Mapping from input file entries to the index into the
   /// offset table where information about that input file is stored.
   llvm::DenseMap<const FileEntry *, uint32_t> InputFileIDs;
@@ -406,6 +413,32 @@ private:
   /// in the order they should be written.
   SmallVector<QueuedCXXBaseSpecifiers, 2> CXXBaseSpecifiersToWrite;
 
+  /// \brief The offset of each CXXCtorInitializer list within the AST.
+  SmallVector<uint32_t, 4> CXXCtorInitializersOffsets;
+
+  /// \brief The ID that will be assigned to the next new list of C++
+  /// constructor initializers.
+  serialization::CXXCtorInitializersID NextCXXCtorInitializersID;
+
+  /// \brief A list of C++ constructor initializers that is queued to be
+  /// written into the AST file.
+  struct QueuedCXXCtorInitializers {
+    QueuedCXXCtorInitializers() : ID(), Inits(), NumInits() { }
+
+    QueuedCXXCtorInitializers(serialization::CXXCtorInitializersID ID,
+                              CXXCtorInitializer const * const *Inits,
+                              unsigned NumInits)
+      : ID(ID), Inits(Inits), NumInits(NumInits) { }
+
+    serialization::CXXCtorInitializersID ID;
+    CXXCtorInitializer const * const *Inits;
+    unsigned NumInits;
+  };
+
+  /// \brief Queue of C++ constructor initializer lists to be written to the
+  /// AST file, in the order they should be written.
+  SmallVector<QueuedCXXCtorInitializers, 2> CXXCtorInitializersToWrite;
+
   /// \brief A mapping from each known submodule to its ID number, which will
   /// be a positive integer.
   llvm::DenseMap<Module *, unsigned> SubmoduleIDs;
@@ -436,6 +469,7 @@ private:
   void WritePragmaDiagnosticMappings(const DiagnosticsEngine &Diag,
                                      bool isModule);
   void WriteCXXBaseSpecifiersOffsets();
+  void WriteCXXCtorInitializersOffsets();
   void WriteType(QualType T);
   uint64_t WriteDeclContextLexicalBlock(ASTContext &Context, DeclContext *DC);
   uint64_t WriteDeclContextVisibleBlock(ASTContext &Context, DeclContext *DC);
@@ -475,6 +509,10 @@ private:
   void WriteDeclsBlockAbbrevs();
   void WriteDecl(ASTContext &Context, Decl *D);
 
+  /// \brief Attribute everything written since \p StartBit to the part of
+  /// the AST file called \p Name.
+  void notePartWritten(const char *Name, uint64_t StartBit);
+
   void WriteASTCore(Sema &SemaRef,
                     StringRef isysroot, const std::string &OutputFile,
                     Module *WritingModule);
@@ -500,6 +538,10 @@ public:
                 Module *WritingModule, StringRef isysroot,
                 bool hasErrors = false);
 
+  /// \brief Print the number of bytes written for each part of the last
+  /// AST file.
+  void PrintStats() const;
+
   /// \brief Emit a token.
   void AddToken(const Token &Tok, RecordDataImpl &Record);
 
@@ -532,6 +574,11 @@ public:
                                CXXBaseSpecifier const *BasesEnd,
                                RecordDataImpl &Record);
 
+  /// \brief Emit a reference to a list of C++ constructor initializers that
+  /// will be written out separately, so that it can be read lazily.
+  void AddCXXCtorInitializersRef(CXXCtorInitializer const * const *Inits,
+                                 unsigned NumInits, RecordDataImpl &Record);
+
   /// \brief Get the unique number used to refer to the given selector.
   serialization::SelectorID getSelectorRef(Selector Sel);
 
@@ -692,6 +739,10 @@ public:
   /// via \c AddCXXBaseSpecifiersRef().
   void FlushCXXBaseSpecifiers();
 
+  /// \brief Flush all of the C++ constructor initializer lists that have
+  /// been added via \c AddCXXCtorInitializersRef().
+  void FlushCXXCtorInitializers();
+
   /// \brief Record an ID for the given switch-case statement.
   unsigned RecordSwitchCaseID(SwitchCase *S);
 
@@ -774,6 +825,7 @@ public:
   virtual void HandleTranslationUnit(ASTContext &Ctx);
   virtual ASTMutationListener *GetASTMutationListener();
   virtual ASTDeserializationListener *GetASTDeserializationListener();
+  virtual void PrintStats();
 
   bool hasEmittedPCH() const { return HasEmittedPCH; }
 };
@@ -16,6 +16,7 @@
 #ifndef LLVM_CLANG_SERIALIZATION_GLOBAL_MODULE_INDEX_H
 #define LLVM_CLANG_SERIALIZATION_GLOBAL_MODULE_INDEX_H
 
+#include "clang/Serialization/IdentifierBloomFilter.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -68,6 +69,9 @@ class GlobalModuleIndex {
   /// GlobalModuleIndex.
   void *IdentifierIndex;
 
+  /// \brief A Bloom filter over the identifiers in the identifier index.
+  serialization::IdentifierBloomFilter IdentifierFilter;
+
   /// \brief Information about a given module file.
   struct ModuleInfo {
     ModuleInfo() : File(), Size(), ModTime() { }
@@ -113,6 +117,10 @@ class GlobalModuleIndex {
   /// \brief The number of identifier lookup hits, where we recognize the
   /// identifier.
   unsigned NumIdentifierLookupHits;
+
+  /// \brief The number of identifier lookups that the Bloom filter answered
+  /// without probing the identifier index.
+  unsigned NumIdentifierLookupsFiltered;
   
   /// \brief Internal constructor. Use \c readIndex() to read an index.
   explicit GlobalModuleIndex(llvm::MemoryBuffer *Buffer,
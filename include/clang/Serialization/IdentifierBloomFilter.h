@@ -0,0 +1,100 @@
+//===--- IdentifierBloomFilter.h - Bloom filter of identifiers --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the IdentifierBloomFilter class, which lets identifier
+//  lookups skip AST files and global module indexes that cannot contain the
+//  identifier without probing their on-disk hash tables.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SERIALIZATION_IDENTIFIER_BLOOM_FILTER_H
+#define LLVM_CLANG_SERIALIZATION_IDENTIFIER_BLOOM_FILTER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace clang {
+namespace serialization {
+
+/// \brief A Bloom filter over the names of the identifiers in an identifier
+/// table, as stored in an AST file.
+///
+/// The filter is a bit array of a power-of-two size; a name sets
+/// \c getNumHashes() bits, chosen by double hashing.  A filter that was not
+/// read from anywhere is empty, and may contain everything.
+class IdentifierBloomFilter {
+public:
+  /// \brief The hashes of a name that the filter bits are derived from.
+  ///
+  /// Computing these once lets a lookup check the same name against many
+  /// filters cheaply.
+  struct Hash {
+    uint32_t H1, H2;
+    explicit Hash(StringRef Name);
+  };
+
+private:
+  const unsigned char *Bits;
+  uint32_t BitMask;
+  unsigned NumHashes;
+
+public:
+  IdentifierBloomFilter() : Bits(0), BitMask(0), NumHashes(0) { }
+
+  /// \brief Wrap the serialized form of a filter, which is not copied.
+  ///
+  /// \returns an empty filter if the data is not a valid filter.
+  static IdentifierBloomFilter get(StringRef Data, unsigned NumHashes);
+
+  /// \brief Whether this filter was read from anywhere.
+  bool empty() const { return Bits == 0; }
+
+  /// \brief Returns false if the identifier with the given hash is definitely
+  /// not in the identifier table that this filter describes.
+  bool mayContain(const Hash &H) const {
+    if (!Bits)
+      return true;
+    for (unsigned I = 0; I != NumHashes; ++I) {
+      uint32_t Bit = (H.H1 + I * H.H2) & BitMask;
+      if (!(Bits[Bit >> 3] & (1 << (Bit & 7))))
+        return false;
+    }
+    return true;
+  }
+
+  bool mayContain(StringRef Name) const { return mayContain(Hash(Name)); }
+};
+
+/// \brief Builds an IdentifierBloomFilter for a set of names.
+class IdentifierBloomFilterBuilder {
+  std::vector<unsigned char> Bits;
+  unsigned NumHashes;
+
+public:
+  /// \brief Create a builder for a filter sized for \p NumNames names.
+  explicit IdentifierBloomFilterBuilder(unsigned NumNames);
+
+  void add(StringRef Name);
+
+  /// \brief The number of bits set per name, which has to be stored
+  /// alongside the filter data.
+  unsigned getNumHashes() const { return NumHashes; }
+
+  /// \brief The serialized form of the filter.
+  StringRef getData() const {
+    return StringRef((const char *)&Bits[0], Bits.size());
+  }
+};
+
+} // end namespace serialization
+} // end namespace clang
+
+#endif
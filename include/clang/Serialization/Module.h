@@ -18,6 +18,8 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/ContinuousRangeMap.h"
+#include "clang/Serialization/IdentifierBloomFilter.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/Bitcode/BitstreamReader.h"
@@ -192,6 +194,17 @@ public:
   /// \brief The input files that have been loaded from this AST file.
   std::vector<InputFile> InputFilesLoaded;
 
+  /// \brief The number of input files that are not system files. These
+  /// come first in \c InputFilesLoaded.
+  unsigned NumUserInputFiles;
+
+  /// \brief The hash of the input signature file this AST file was built
+  /// against, if it recorded one.
+  std::pair<uint64_t, uint64_t> InputSignature;
+
+  /// \brief Whether this AST file recorded an input signature.
+  bool HasInputSignature;
+
   /// \brief If non-zero, specifies the time when we last validated input
   /// files.  Zero means we never validated them.
   ///
@@ -250,6 +263,11 @@ public:
   /// IdentifierHashTable.
   void *IdentifierLookupTable;
 
+  /// \brief A Bloom filter over the identifiers in IdentifierLookupTable.
+  ///
+  /// Empty if the AST file does not have one.
+  serialization::IdentifierBloomFilter IdentifierFilter;
+
   // === Macros ===
 
   /// \brief The cursor to the start of the preprocessor block, which stores
@@ -385,6 +403,13 @@ public:
   /// indexed by the C++ base specifier set ID (-1).
   const uint32_t *CXXBaseSpecifiersOffsets;
 
+  /// \brief The number of C++ constructor initializer lists in this AST file.
+  unsigned LocalNumCXXCtorInitializers;
+
+  /// \brief Offset of each C++ constructor initializer list within the
+  /// bitstream, indexed by the initializer list ID (-1).
+  const uint32_t *CXXCtorInitializersOffsets;
+
   typedef llvm::DenseMap<const DeclContext *, DeclContextInfo>
   DeclContextInfosMap;
 
@@ -404,8 +429,13 @@ public:
   unsigned LocalNumRedeclarationsInMap;
   
   /// \brief The redeclaration chains for declarations local to this
-  /// module file.
-  SmallVector<uint64_t, 1> RedeclarationChains;
+  /// module file, used in place from the AST file. Each chain is a count
+  /// followed by that many local declaration IDs.
+  const uint32_t *RedeclarationChains;
+
+  /// \brief The offsets of the redeclaration chains that have already been
+  /// deserialized.
+  llvm::DenseSet<unsigned> LoadedRedeclarationChains;
   
   /// \brief Array of category list location information within this 
   /// module file, sorted by the definition ID.
@@ -415,8 +445,13 @@ public:
   unsigned LocalNumObjCCategoriesInMap;
   
   /// \brief The Objective-C category lists for categories known to this
-  /// module.
-  SmallVector<uint64_t, 1> ObjCCategories;
+  /// module, used in place from the AST file. Each list is a count followed
+  /// by that many local declaration IDs.
+  const uint32_t *ObjCCategories;
+
+  /// \brief The offsets of the category lists that have already been
+  /// deserialized.
+  llvm::DenseSet<unsigned> LoadedObjCCategories;
 
   // === Types ===
 
@@ -13,6 +13,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "CXXABI.h"
+#include "ConstexprInterpreter.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/CharUnits.h"
@@ -721,6 +722,7 @@ ASTContext::ASTContext(LangOptions& LOpts, SourceManager &SM,
     DependentTemplateSpecializationTypes(this_()),
     SubstTemplateTemplateParmPacks(this_()),
     GlobalNestedNameSpecifier(0), 
+    NumConstexprCallLookups(0), NumConstexprCallHits(0),
     Int128Decl(0), UInt128Decl(0), Float128StubDecl(0),
     BuiltinVaListDecl(0),
     ObjCIdDecl(0), ObjCSelDecl(0), ObjCClassDecl(0), ObjCProtocolClassDecl(0),
@@ -732,7 +734,7 @@ ASTContext::ASTContext(LangOptions& LOpts, SourceManager &SM,
     cudaConfigureCallDecl(0),
     NullTypeSourceInfo(QualType()), 
     FirstLocalImport(), LastLocalImport(),
-    SourceMgr(SM), LangOpts(LOpts), 
+    SourceMgr(SM), LangOpts(LOpts), MemoryAccounting(0),
     AddrSpaceMap(0), Target(t), PrintingPolicy(LOpts),
     Idents(idents), Selectors(sels),
     BuiltinInfo(builtins),
@@ -752,6 +754,9 @@ ASTContext::ASTContext(LangOptions& LOpts, SourceManager &SM,
 }
 
 ASTContext::~ASTContext() {
+  // Account for the last types and side tables while they still exist.
+  setMemoryAccounting(0);
+
   // Release the DenseMaps associated with DeclContext objects.
   // FIXME: Is this the ideal solution?
   ReleaseDeclContextMaps();
@@ -783,6 +788,16 @@ ASTContext::~ASTContext() {
        A != AEnd; ++A)
     A->second->~AttrVec();
 
+  // Memoized constexpr call results live in BumpAlloc, but their values can
+  // own memory.
+  for (llvm::FoldingSet<ConstexprCallResult>::iterator
+         I = ConstexprCallResults.begin(), E = ConstexprCallResults.end();
+       I != E; ) {
+    // Increment in loop to prevent using deallocated memory.
+    ConstexprCallResult &Result = *I++;
+    Result.~ConstexprCallResult();
+  }
+
   llvm::DeleteContainerSeconds(MangleNumberingContexts);
 }
 
@@ -846,6 +861,13 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  if (getLangOpts().CPlusPlus11)
+    llvm::errs() << NumConstexprCallHits << "/" << NumConstexprCallLookups
+                 << " constexpr calls reused a memoized result ("
+                 << ConstexprCallResults.size() << " results memoized)\n";
+  if (ConstexprInterp)
+    ConstexprInterp->PrintStats();
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -1982,7 +2004,7 @@ TypeSourceInfo *ASTContext::CreateTypeSourceInfo(QualType T,
            "incorrect data size provided to CreateTypeSourceInfo!");
 
   TypeSourceInfo *TInfo =
-    (TypeSourceInfo*)BumpAlloc.Allocate(sizeof(TypeSourceInfo) + DataSize, 8);
+    (TypeSourceInfo*)Allocate(sizeof(TypeSourceInfo) + DataSize, 8);
   new (TInfo) TypeSourceInfo(T);
   return TInfo;
 }
@@ -8109,6 +8131,14 @@ size_t ASTContext::getSideTableAllocatedMemory() const {
          llvm::capacity_in_bytes(ClassScopeSpecializationPattern);
 }
 
+void ASTContext::setMemoryAccounting(ASTMemoryAccounting *Accounting) {
+  if (MemoryAccounting)
+    MemoryAccounting->setContext(0);
+  MemoryAccounting = Accounting;
+  if (Accounting)
+    Accounting->setContext(this);
+}
+
 /// getIntTypeForBitwidth -
 /// sets integer QualTy according to specified details:
 /// bitwidth, signed/unsigned.
@@ -8189,6 +8219,37 @@ ASTContext::getMaterializedTemporaryValue(const MaterializeTemporaryExpr *E,
   return I == MaterializedTemporaryValues.end() ? 0 : &I->second;
 }
 
+const APValue *
+ASTContext::getConstexprCallResult(const llvm::FoldingSetNodeID &ID) {
+  ++NumConstexprCallLookups;
+  void *InsertPos;
+  ConstexprCallResult *Result =
+      ConstexprCallResults.FindNodeOrInsertPos(ID, InsertPos);
+  if (!Result)
+    return 0;
+  ++NumConstexprCallHits;
+  return &Result->Value;
+}
+
+void ASTContext::setConstexprCallResult(const llvm::FoldingSetNodeID &ID,
+                                        const APValue &Value) {
+  void *InsertPos;
+  if (ConstexprCallResults.FindNodeOrInsertPos(ID, InsertPos))
+    return;
+  ConstexprCallResult *Result =
+      new (*this) ConstexprCallResult(ID.Intern(BumpAlloc), Value);
+  if (MemoryAccounting)
+    MemoryAccounting->add(ASTMemoryAccounting::APValues,
+                          sizeof(ConstexprCallResult));
+  ConstexprCallResults.InsertNode(Result, InsertPos);
+}
+
+ConstexprInterpreter &ASTContext::getConstexprInterpreter() {
+  if (!ConstexprInterp)
+    ConstexprInterp.reset(new ConstexprInterpreter(*this));
+  return *ConstexprInterp;
+}
+
 bool ASTContext::AtomicUsesUnsupportedLibcall(const AtomicExpr *E) const {
   const llvm::Triple &T = getTargetInfo().getTriple();
   if (!T.isOSDarwin())
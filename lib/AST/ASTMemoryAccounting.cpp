@@ -0,0 +1,252 @@
+//===--- ASTMemoryAccounting.cpp - AST memory by category and file --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ASTMemoryAccounting class, which records the
+//  memory reported for -fast-memory-report.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTMemoryAccounting.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/ExternalASTSource.h"
+#include "clang/AST/Type.h"
+#include "clang/AST/TypeCLI.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/ThreadLocal.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace clang;
+
+static llvm::ManagedStatic<llvm::sys::ThreadLocal<ASTMemoryAccounting> >
+  CurrentAccounting;
+
+ASTMemoryAccounting *ASTMemoryAccounting::getCurrent() {
+  return CurrentAccounting->get();
+}
+
+void ASTMemoryAccounting::setCurrent(ASTMemoryAccounting *Accounting) {
+  if (Accounting)
+    CurrentAccounting->set(Accounting);
+  else
+    CurrentAccounting->erase();
+}
+
+ASTMemoryAccounting::ASTMemoryAccounting()
+  : Current(&Files["<startup>"]), Context(0), NumTypesMeasured(0) {}
+
+ASTMemoryAccounting::~ASTMemoryAccounting() {}
+
+const char *ASTMemoryAccounting::getCategoryName(Category C) {
+  switch (C) {
+  case Types:            return "types";
+  case Decls:            return "decls";
+  case Stmts:            return "stmts";
+  case DeclContextMaps:  return "decl-context-maps";
+  case APValues:         return "apvalues";
+  case DefinitionData:   return "definition-data";
+  case OtherAST:         return "other-ast";
+  case ASTSideTables:    return "ast-side-tables";
+  case SemaTables:       return "sema-tables";
+  case ASTReaderBuffers: return "ast-reader-buffers";
+  case NumCategories:    break;
+  }
+  llvm_unreachable("invalid memory accounting category");
+}
+
+/// \brief The size of the node of \p T, not counting trailing storage.
+static size_t getTypeNodeSize(const Type *T) {
+  switch (T->getTypeClass()) {
+#define TYPE(Class, Base) \
+  case Type::Class: return sizeof(Class##Type);
+#define ABSTRACT_TYPE(Class, Base)
+#include "clang/AST/TypeNodes.def"
+  }
+  llvm_unreachable("invalid type class");
+}
+
+/// \brief The bytes held by the buffers of the AST files that \p Ctx loads
+/// declarations from.
+static uint64_t getASTReaderBufferBytes(const ASTContext &Ctx) {
+  ExternalASTSource *Source = Ctx.getExternalSource();
+  if (!Source)
+    return 0;
+  ExternalASTSource::MemoryBufferSizes Sizes = Source->getMemoryBufferSizes();
+  return Sizes.malloc_bytes + Sizes.mmap_bytes;
+}
+
+void ASTMemoryAccounting::checkpoint() {
+  for (unsigned I = 0, N = Counters.size(); I != N; ++I) {
+    Counter &C = Counters[I];
+    uint64_t Value = C.Fn(C.Data);
+    // Tables can shrink, e.g. when pending instantiations are performed.
+    if (Value > C.LastValue)
+      Current->Bytes[C.Cat] += Value - C.LastValue;
+    C.LastValue = Value;
+  }
+
+  if (!Context)
+    return;
+  const SmallVectorImpl<Type *> &AllTypes = Context->getTypes();
+  for (unsigned E = AllTypes.size(); NumTypesMeasured != E; ++NumTypesMeasured)
+    Current->Bytes[Types] += getTypeNodeSize(AllTypes[NumTypesMeasured]);
+}
+
+/// \brief Counter for the side tables of an ASTContext.
+static size_t getASTSideTableBytes(const void *Ctx) {
+  return static_cast<const ASTContext *>(Ctx)->getSideTableAllocatedMemory();
+}
+
+/// \brief Counter for the AST files an ASTContext loads declarations from.
+static size_t getASTReaderBytes(const void *Ctx) {
+  return getASTReaderBufferBytes(*static_cast<const ASTContext *>(Ctx));
+}
+
+void ASTMemoryAccounting::setContext(const ASTContext *Ctx) {
+  if (Context)
+    removeCounters(Context);
+  else
+    checkpoint();
+  Context = Ctx;
+  NumTypesMeasured = 0;
+  if (Ctx) {
+    addCounter(ASTSideTables, &getASTSideTableBytes, Ctx);
+    addCounter(ASTReaderBuffers, &getASTReaderBytes, Ctx);
+  }
+}
+
+void ASTMemoryAccounting::addCounter(Category C, MemoryCounterFn Fn,
+                                     const void *Data) {
+  checkpoint();
+  Counter NewCounter = { C, Fn, Data, 0 };
+  Counters.push_back(NewCounter);
+  // What the counter measures so far was allocated while it was not sampled;
+  // attribute it to the current file too.
+  checkpoint();
+}
+
+void ASTMemoryAccounting::removeCounters(const void *Data) {
+  checkpoint();
+  for (unsigned I = Counters.size(); I != 0; --I)
+    if (Counters[I - 1].Data == Data)
+      Counters.erase(Counters.begin() + I - 1);
+}
+
+void ASTMemoryAccounting::enterFile(StringRef Name) {
+  checkpoint();
+  Current = &Files[Name];
+  OpenFiles.push_back(Current);
+}
+
+void ASTMemoryAccounting::exitFile() {
+  assert(!OpenFiles.empty() && "no file to exit");
+  checkpoint();
+  OpenFiles.pop_back();
+  Current = OpenFiles.empty() ? &Files["<startup>"] : OpenFiles.back();
+}
+
+/// \brief Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    unsigned char C = *I;
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+namespace {
+/// \brief The memory attributed to one file, by category.
+struct FileTotals {
+  StringRef Name;
+  uint64_t Bytes[ASTMemoryAccounting::NumCategories];
+  uint64_t Total;
+
+  bool operator<(const FileTotals &RHS) const {
+    // Largest first.
+    if (Total != RHS.Total)
+      return Total > RHS.Total;
+    return Name < RHS.Name;
+  }
+};
+}
+
+/// \brief Write the bytes of each category as the members of a JSON object.
+static void writeCategories(raw_ostream &OS, const uint64_t *Bytes) {
+  for (unsigned C = 0; C != ASTMemoryAccounting::NumCategories; ++C) {
+    if (C)
+      OS << ',';
+    OS << '"'
+       << ASTMemoryAccounting::getCategoryName(
+              static_cast<ASTMemoryAccounting::Category>(C))
+       << "\":" << Bytes[C];
+  }
+}
+
+void ASTMemoryAccounting::write(raw_ostream &OS) {
+  checkpoint();
+
+  std::vector<FileTotals> Totals;
+  FileTotals Sum;
+  Sum.Total = 0;
+  std::fill(Sum.Bytes, Sum.Bytes + NumCategories, 0);
+  for (llvm::StringMap<Usage>::const_iterator I = Files.begin(),
+                                              E = Files.end();
+       I != E; ++I) {
+    const Usage &U = I->getValue();
+    FileTotals T;
+    T.Name = I->getKey();
+    std::copy(U.Bytes, U.Bytes + NumCategories, T.Bytes);
+
+    // Whatever the ASTContext allocated that isn't in a category of its own
+    // is other AST data. Statements and types are counted by the size of
+    // their class; some are built on the stack, so don't go below zero.
+    uint64_t Categorized = U.Bytes[Types] + U.Bytes[Decls] + U.Bytes[Stmts] +
+                           U.Bytes[APValues] + U.Bytes[DefinitionData];
+    T.Bytes[OtherAST] = U.ASTContextBytes > Categorized
+                            ? U.ASTContextBytes - Categorized : 0;
+
+    T.Total = 0;
+    for (unsigned C = 0; C != NumCategories; ++C) {
+      T.Total += T.Bytes[C];
+      Sum.Bytes[C] += T.Bytes[C];
+    }
+    if (!T.Total)
+      continue;
+    Sum.Total += T.Total;
+    Totals.push_back(T);
+  }
+  std::sort(Totals.begin(), Totals.end());
+
+  OS << "{\"total\":" << Sum.Total << ",\"categories\":{";
+  writeCategories(OS, Sum.Bytes);
+  OS << "},\"files\":[";
+  for (unsigned I = 0, N = Totals.size(); I != N; ++I) {
+    const FileTotals &T = Totals[I];
+    OS << (I ? ",\n" : "\n") << "{\"file\":";
+    writeJSONString(OS, T.Name);
+    OS << ",\"total\":" << T.Total << ",\"categories\":{";
+    writeCategories(OS, T.Bytes);
+    OS << "}}";
+  }
+  OS << "\n]}\n";
+}
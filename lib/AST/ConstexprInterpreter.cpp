@@ -0,0 +1,1010 @@
+//===--- ConstexprInterpreter.cpp - Bytecode constexpr evaluation ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a bytecode compiler and interpreter for constexpr
+// functions over integers.
+//
+// Each function is compiled once into a sequence of stack machine
+// instructions. Parameters and local variables live in numbered slots, and
+// every value is held as an int64_t in the canonical representation of its
+// type: sign-extended from its width if the type is signed, and zero-extended
+// otherwise. Instructions operating on integers carry the width and
+// signedness of their operand type, so the interpreter never needs to look
+// at the AST.
+//
+// The interpreter must produce exactly the values the AST evaluator would, so
+// it counts evaluation steps in the same places as EvaluateStmt, and it stops
+// instead of producing a value whenever the AST evaluator would produce a
+// note. The caller then re-evaluates the call with the AST evaluator.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ConstexprInterpreter.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/StmtCXX.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+namespace {
+enum Opcode {
+  /// Count an evaluation step, giving up if there are none left.
+  OP_Step,
+  /// Push Constants[Arg].
+  OP_Const,
+  /// Push the value of slot Arg.
+  OP_Load,
+  /// Pop a value and store it to slot Arg.
+  OP_Store,
+  /// Increment or decrement slot Arg in place.
+  OP_Inc,
+  OP_Dec,
+  OP_Dup,
+  OP_Pop,
+  OP_Swap,
+  /// Convert the top of the stack to the instruction's type.
+  OP_Convert,
+  OP_ToBool,
+  OP_Neg,
+  OP_Not,
+  OP_LNot,
+  OP_Add,
+  OP_Sub,
+  OP_Mul,
+  OP_Div,
+  OP_Rem,
+  OP_Shl,
+  OP_Shr,
+  OP_And,
+  OP_Or,
+  OP_Xor,
+  OP_LT,
+  OP_GT,
+  OP_LE,
+  OP_GE,
+  OP_EQ,
+  OP_NE,
+  /// Jump to instruction Arg, unconditionally or depending on a popped value.
+  OP_Jump,
+  OP_JumpIfFalse,
+  OP_JumpIfTrue,
+  /// Call Callees[Arg], whose arguments are on the top of the stack.
+  OP_Call,
+  /// Return the top of the stack.
+  OP_Return,
+  /// Flowed off the end of the function without returning a value.
+  OP_FellOff
+};
+
+/// A single bytecode instruction.
+struct Instr {
+  unsigned char Op;
+  /// The width of the integer type the instruction operates on.
+  unsigned char Width;
+  /// Whether that type is signed.
+  bool Signed;
+  /// For shifts, whether the shift amount is signed. For increments and
+  /// decrements, whether overflow is an error rather than wrapping.
+  bool Aux;
+  int Arg;
+};
+}
+
+class ConstexprInterpreter::Function {
+public:
+  unsigned NumParams;
+  unsigned NumSlots;
+  unsigned ReturnWidth;
+  bool ReturnSigned;
+  SmallVector<Instr, 32> Code;
+  SmallVector<int64_t, 8> Constants;
+  SmallVector<const FunctionDecl *, 4> Callees;
+};
+
+struct ConstexprInterpreter::ExecutionState {
+  unsigned StepsLeft;
+  unsigned DepthLeft;
+  SmallVector<int64_t, 64> Stack;
+};
+
+//===----------------------------------------------------------------------===//
+// Compilation
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Compiles a single function body. All methods return false if they find
+/// a construct the interpreter doesn't support.
+class BytecodeCompiler {
+  ASTContext &Ctx;
+  ConstexprInterpreter::Function &F;
+
+  /// The slot holding each parameter and local variable.
+  llvm::DenseMap<const VarDecl *, unsigned> Slots;
+
+  /// The jumps out of each enclosing loop, to be patched when its end and
+  /// continue point are known.
+  struct LoopJumps {
+    SmallVector<unsigned, 4> Breaks, Continues;
+  };
+  SmallVector<LoopJumps, 4> Loops;
+
+public:
+  BytecodeCompiler(ASTContext &Ctx, ConstexprInterpreter::Function &F)
+    : Ctx(Ctx), F(F) {}
+
+  bool compileFunction(const FunctionDecl *FD);
+
+private:
+  bool getIntType(QualType T, unsigned &Width, bool &Signed);
+
+  unsigned emit(Opcode Op, int Arg = 0, unsigned Width = 0,
+                bool Signed = false, bool Aux = false) {
+    Instr I = { (unsigned char)Op, (unsigned char)Width, Signed, Aux, Arg };
+    F.Code.push_back(I);
+    return F.Code.size() - 1;
+  }
+  bool emitTyped(Opcode Op, QualType T, bool Aux = false, int Arg = 0) {
+    unsigned Width;
+    bool Signed;
+    if (!getIntType(T, Width, Signed))
+      return false;
+    emit(Op, Arg, Width, Signed, Aux);
+    return true;
+  }
+  void emitConst(int64_t Value) {
+    F.Constants.push_back(Value);
+    emit(OP_Const, F.Constants.size() - 1);
+  }
+  void patchJump(unsigned At) { F.Code[At].Arg = F.Code.size(); }
+
+  bool declareVar(const VarDecl *VD);
+  bool compileStmt(const Stmt *S);
+  bool compileLoopBody(const Stmt *Body, LoopJumps &Jumps);
+  bool compileRValue(const Expr *E);
+  bool compileLValue(const Expr *E, unsigned &Slot);
+  bool compileDiscarded(const Expr *E);
+  bool compileIncDec(const Expr *E, const Expr *SubExpr, bool IsIncrement,
+                     unsigned &Slot);
+  bool compileCall(const CallExpr *E);
+};
+}
+
+bool BytecodeCompiler::getIntType(QualType T, unsigned &Width, bool &Signed) {
+  if (!T->isIntegralOrEnumerationType() || T.isVolatileQualified())
+    return false;
+  Width = Ctx.getIntWidth(T);
+  Signed = T->isSignedIntegerOrEnumerationType();
+  return Width && Width <= 64;
+}
+
+bool BytecodeCompiler::declareVar(const VarDecl *VD) {
+  unsigned Width;
+  bool Signed;
+  if (!getIntType(VD->getType(), Width, Signed))
+    return false;
+  Slots[VD] = F.NumSlots++;
+  return true;
+}
+
+bool BytecodeCompiler::compileFunction(const FunctionDecl *FD) {
+  if (FD->isDependentContext() || FD->isVariadic())
+    return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (MD->isInstance())
+      return false;
+
+  unsigned Width;
+  bool Signed;
+  if (!getIntType(FD->getReturnType(), Width, Signed))
+    return false;
+  F.ReturnWidth = Width;
+  F.ReturnSigned = Signed;
+
+  F.NumParams = F.NumSlots = 0;
+  for (unsigned I = 0, N = FD->getNumParams(); I != N; ++I)
+    if (!declareVar(FD->getParamDecl(I)))
+      return false;
+  F.NumParams = F.NumSlots;
+
+  if (!compileStmt(FD->getBody()))
+    return false;
+  emit(OP_FellOff);
+  return true;
+}
+
+bool BytecodeCompiler::compileLoopBody(const Stmt *Body, LoopJumps &Jumps) {
+  Loops.push_back(LoopJumps());
+  bool Success = compileStmt(Body);
+  Jumps = Loops.pop_back_val();
+  return Success;
+}
+
+/// Compile a statement. Each call corresponds to one call to EvaluateStmt in
+/// the AST evaluator, and so costs one step.
+bool BytecodeCompiler::compileStmt(const Stmt *S) {
+  emit(OP_Step);
+
+  switch (S->getStmtClass()) {
+  default:
+    if (const Expr *E = dyn_cast<Expr>(S))
+      return compileDiscarded(E);
+    return false;
+
+  case Stmt::NullStmtClass:
+    return true;
+
+  case Stmt::DeclStmtClass: {
+    const DeclStmt *DS = cast<DeclStmt>(S);
+    for (DeclStmt::const_decl_iterator I = DS->decl_begin(),
+           E = DS->decl_end(); I != E; ++I) {
+      const VarDecl *VD = dyn_cast<VarDecl>(*I);
+      if (!VD)
+        continue;
+      const Expr *Init = VD->getInit();
+      if (!VD->hasLocalStorage() || !Init || Init->isValueDependent())
+        return false;
+      if (!compileRValue(Init) || !declareVar(VD))
+        return false;
+      emit(OP_Store, Slots[VD]);
+    }
+    return true;
+  }
+
+  case Stmt::ReturnStmtClass: {
+    const Expr *RetExpr = cast<ReturnStmt>(S)->getRetValue();
+    if (!RetExpr || !compileRValue(RetExpr))
+      return false;
+    emit(OP_Return);
+    return true;
+  }
+
+  case Stmt::CompoundStmtClass: {
+    const CompoundStmt *CS = cast<CompoundStmt>(S);
+    for (CompoundStmt::const_body_iterator I = CS->body_begin(),
+           E = CS->body_end(); I != E; ++I)
+      if (!compileStmt(*I))
+        return false;
+    return true;
+  }
+
+  case Stmt::IfStmtClass: {
+    const IfStmt *IS = cast<IfStmt>(S);
+    if (IS->getConditionVariable() || !compileRValue(IS->getCond()))
+      return false;
+    unsigned ToElse = emit(OP_JumpIfFalse);
+    if (IS->getThen() && !compileStmt(IS->getThen()))
+      return false;
+    if (!IS->getElse()) {
+      patchJump(ToElse);
+      return true;
+    }
+    unsigned ToEnd = emit(OP_Jump);
+    patchJump(ToElse);
+    if (!compileStmt(IS->getElse()))
+      return false;
+    patchJump(ToEnd);
+    return true;
+  }
+
+  case Stmt::WhileStmtClass: {
+    const WhileStmt *WS = cast<WhileStmt>(S);
+    if (WS->getConditionVariable())
+      return false;
+    unsigned Cond = F.Code.size();
+    if (!compileRValue(WS->getCond()))
+      return false;
+    unsigned ToEnd = emit(OP_JumpIfFalse);
+    LoopJumps Jumps;
+    if (!compileLoopBody(WS->getBody(), Jumps))
+      return false;
+    emit(OP_Jump, Cond);
+    patchJump(ToEnd);
+    for (unsigned I = 0, N = Jumps.Continues.size(); I != N; ++I)
+      F.Code[Jumps.Continues[I]].Arg = Cond;
+    for (unsigned I = 0, N = Jumps.Breaks.size(); I != N; ++I)
+      patchJump(Jumps.Breaks[I]);
+    return true;
+  }
+
+  case Stmt::DoStmtClass: {
+    const DoStmt *DS = cast<DoStmt>(S);
+    unsigned Body = F.Code.size();
+    LoopJumps Jumps;
+    if (!compileLoopBody(DS->getBody(), Jumps))
+      return false;
+    for (unsigned I = 0, N = Jumps.Continues.size(); I != N; ++I)
+      patchJump(Jumps.Continues[I]);
+    if (!compileRValue(DS->getCond()))
+      return false;
+    emit(OP_JumpIfTrue, Body);
+    for (unsigned I = 0, N = Jumps.Breaks.size(); I != N; ++I)
+      patchJump(Jumps.Breaks[I]);
+    return true;
+  }
+
+  case Stmt::ForStmtClass: {
+    const ForStmt *FS = cast<ForStmt>(S);
+    if (FS->getConditionVariable())
+      return false;
+    if (FS->getInit() && !compileStmt(FS->getInit()))
+      return false;
+    unsigned Cond = F.Code.size();
+    unsigned ToEnd = 0;
+    if (FS->getCond()) {
+      if (!compileRValue(FS->getCond()))
+        return false;
+      ToEnd = emit(OP_JumpIfFalse);
+    }
+    LoopJumps Jumps;
+    if (!compileLoopBody(FS->getBody(), Jumps))
+      return false;
+    for (unsigned I = 0, N = Jumps.Continues.size(); I != N; ++I)
+      patchJump(Jumps.Continues[I]);
+    if (FS->getInc() && !compileDiscarded(FS->getInc()))
+      return false;
+    emit(OP_Jump, Cond);
+    if (FS->getCond())
+      patchJump(ToEnd);
+    for (unsigned I = 0, N = Jumps.Breaks.size(); I != N; ++I)
+      patchJump(Jumps.Breaks[I]);
+    return true;
+  }
+
+  case Stmt::ContinueStmtClass:
+    if (Loops.empty())
+      return false;
+    Loops.back().Continues.push_back(emit(OP_Jump));
+    return true;
+
+  case Stmt::BreakStmtClass:
+    // We don't compile switch statements, so this always leaves a loop.
+    if (Loops.empty())
+      return false;
+    Loops.back().Breaks.push_back(emit(OP_Jump));
+    return true;
+
+  case Stmt::LabelStmtClass:
+    return compileStmt(cast<LabelStmt>(S)->getSubStmt());
+
+  case Stmt::AttributedStmtClass:
+    return compileStmt(cast<AttributedStmt>(S)->getSubStmt());
+  }
+}
+
+/// Compile an expression whose value is discarded.
+bool BytecodeCompiler::compileDiscarded(const Expr *E) {
+  unsigned Slot;
+  if (E->isGLValue())
+    return compileLValue(E, Slot);
+
+  E = E->IgnoreParens();
+  if (const CastExpr *CE = dyn_cast<CastExpr>(E))
+    if (CE->getCastKind() == CK_ToVoid)
+      return compileDiscarded(CE->getSubExpr());
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E))
+    if (UO->isIncrementDecrementOp())
+      return compileIncDec(UO, UO->getSubExpr(), UO->isIncrementOp(), Slot);
+  if (const BinaryOperator *BO = dyn_cast<BinaryOperator>(E))
+    if (BO->getOpcode() == BO_Comma)
+      return compileDiscarded(BO->getLHS()) && compileDiscarded(BO->getRHS());
+
+  if (!compileRValue(E))
+    return false;
+  emit(OP_Pop);
+  return true;
+}
+
+/// Compile an increment or decrement of the variable designated by
+/// \p SubExpr, leaving nothing on the stack.
+bool BytecodeCompiler::compileIncDec(const Expr *E, const Expr *SubExpr,
+                                     bool IsIncrement, unsigned &Slot) {
+  // Modification was not permitted in C++11 constant expressions, and bool
+  // increments don't wrap.
+  QualType T = SubExpr->getType();
+  if (!Ctx.getLangOpts().CPlusPlus1y || T->isBooleanType())
+    return false;
+  if (!compileLValue(SubExpr, Slot))
+    return false;
+  // Arithmetic on types narrower than int is performed after promotion, so
+  // can't overflow; the conversion back wraps.
+  bool Checked = T->isSignedIntegerType() &&
+                 Ctx.getIntWidth(T) >= Ctx.getIntWidth(Ctx.IntTy);
+  return emitTyped(IsIncrement ? OP_Inc : OP_Dec, T, Checked, Slot);
+}
+
+/// Compile an lvalue expression, which must designate a parameter or local
+/// variable, performing any side-effects and determining its slot.
+bool BytecodeCompiler::compileLValue(const Expr *E, unsigned &Slot) {
+  E = E->IgnoreParens();
+
+  if (const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E)) {
+    const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+    llvm::DenseMap<const VarDecl *, unsigned>::iterator I =
+        VD ? Slots.find(VD) : Slots.end();
+    if (I == Slots.end())
+      return false;
+    Slot = I->second;
+    return true;
+  }
+
+  if (const CastExpr *CE = dyn_cast<CastExpr>(E))
+    return CE->getCastKind() == CK_NoOp && compileLValue(CE->getSubExpr(), Slot);
+
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (UO->getOpcode() != UO_PreInc && UO->getOpcode() != UO_PreDec)
+      return false;
+    return compileIncDec(UO, UO->getSubExpr(), UO->isIncrementOp(), Slot);
+  }
+
+  const BinaryOperator *BO = dyn_cast<BinaryOperator>(E);
+  if (!BO)
+    return false;
+  if (BO->getOpcode() == BO_Comma)
+    return compileDiscarded(BO->getLHS()) && compileLValue(BO->getRHS(), Slot);
+  if (!BO->isAssignmentOp() || !Ctx.getLangOpts().CPlusPlus1y)
+    return false;
+
+  // Like the AST evaluator, evaluate the left-hand side first.
+  if (!compileLValue(BO->getLHS(), Slot) || !compileRValue(BO->getRHS()))
+    return false;
+
+  if (const CompoundAssignOperator *CAO = dyn_cast<CompoundAssignOperator>(BO)) {
+    QualType LHSTy = CAO->getLHS()->getType();
+    QualType ComputationTy = CAO->getComputationLHSType();
+    Opcode Op;
+    switch (CAO->getOpcode()) {
+    default: return false;
+    case BO_MulAssign: Op = OP_Mul; break;
+    case BO_DivAssign: Op = OP_Div; break;
+    case BO_RemAssign: Op = OP_Rem; break;
+    case BO_AddAssign: Op = OP_Add; break;
+    case BO_SubAssign: Op = OP_Sub; break;
+    case BO_ShlAssign: Op = OP_Shl; break;
+    case BO_ShrAssign: Op = OP_Shr; break;
+    case BO_AndAssign: Op = OP_And; break;
+    case BO_XorAssign: Op = OP_Xor; break;
+    case BO_OrAssign:  Op = OP_Or;  break;
+    }
+    unsigned Width;
+    bool Signed;
+    if (!getIntType(LHSTy, Width, Signed))
+      return false;
+    emit(OP_Load, Slot);
+    if (!emitTyped(OP_Convert, ComputationTy))
+      return false;
+    emit(OP_Swap);
+    bool ShiftAmountSigned =
+        CAO->getRHS()->getType()->isSignedIntegerOrEnumerationType();
+    if (!emitTyped(Op, ComputationTy, ShiftAmountSigned))
+      return false;
+    emit(OP_Convert, 0, Width, Signed);
+  }
+
+  emit(OP_Store, Slot);
+  return true;
+}
+
+bool BytecodeCompiler::compileCall(const CallExpr *E) {
+  const FunctionDecl *Callee = E->getDirectCallee();
+  if (!Callee || Callee->getBuiltinID() || Callee->isVariadic() ||
+      !isa<DeclRefExpr>(E->getCallee()->IgnoreParenImpCasts()))
+    return false;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(Callee))
+    if (MD->isInstance())
+      return false;
+  if (E->getNumArgs() != Callee->getNumParams())
+    return false;
+
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I)
+    if (!compileRValue(E->getArg(I)))
+      return false;
+
+  F.Callees.push_back(Callee);
+  emit(OP_Call, F.Callees.size() - 1);
+  return true;
+}
+
+/// Compile an integer rvalue expression, leaving its value on the stack.
+bool BytecodeCompiler::compileRValue(const Expr *E) {
+  unsigned Width;
+  bool Signed;
+  if (E->isValueDependent() || !E->isRValue() ||
+      !getIntType(E->getType(), Width, Signed))
+    return false;
+
+  switch (E->getStmtClass()) {
+  default:
+    return false;
+
+  case Stmt::IntegerLiteralClass: {
+    const llvm::APInt &Value = cast<IntegerLiteral>(E)->getValue();
+    emitConst(Signed ? Value.getSExtValue() : (int64_t)Value.getZExtValue());
+    return true;
+  }
+
+  case Stmt::CharacterLiteralClass:
+    emitConst(llvm::SignExtend64(cast<CharacterLiteral>(E)->getValue(),
+                                 Signed ? Width : 64));
+    return true;
+
+  case Stmt::CXXBoolLiteralExprClass:
+    emitConst(cast<CXXBoolLiteralExpr>(E)->getValue());
+    return true;
+
+  case Stmt::CXXScalarValueInitExprClass:
+  case Stmt::ImplicitValueInitExprClass:
+    emitConst(0);
+    return true;
+
+  case Stmt::DeclRefExprClass: {
+    const EnumConstantDecl *ECD =
+        dyn_cast<EnumConstantDecl>(cast<DeclRefExpr>(E)->getDecl());
+    if (!ECD)
+      return false;
+    llvm::APSInt Value = ECD->getInitVal().extOrTrunc(Width);
+    emitConst(Signed ? Value.getSExtValue() : (int64_t)Value.getZExtValue());
+    return true;
+  }
+
+  case Stmt::ParenExprClass:
+    return compileRValue(cast<ParenExpr>(E)->getSubExpr());
+
+  case Stmt::SubstNonTypeTemplateParmExprClass:
+    return compileRValue(
+        cast<SubstNonTypeTemplateParmExpr>(E)->getReplacement());
+
+  case Stmt::CXXDefaultArgExprClass:
+    return compileRValue(cast<CXXDefaultArgExpr>(E)->getExpr());
+
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::CXXStaticCastExprClass: {
+    const CastExpr *CE = cast<CastExpr>(E);
+    const Expr *SubExpr = CE->getSubExpr();
+    switch (CE->getCastKind()) {
+    default:
+      return false;
+    case CK_LValueToRValue: {
+      unsigned Slot;
+      if (!compileLValue(SubExpr, Slot))
+        return false;
+      emit(OP_Load, Slot);
+      return true;
+    }
+    case CK_NoOp:
+      return compileRValue(SubExpr);
+    case CK_IntegralCast:
+      if (!compileRValue(SubExpr))
+        return false;
+      emit(OP_Convert, 0, Width, Signed);
+      return true;
+    case CK_IntegralToBoolean:
+      if (!compileRValue(SubExpr))
+        return false;
+      emit(OP_ToBool);
+      return true;
+    }
+  }
+
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(E);
+    unsigned Slot;
+    switch (UO->getOpcode()) {
+    default:
+      return false;
+    case UO_PostInc:
+    case UO_PostDec: {
+      // Load the old value, then update the variable.
+      unsigned Start = F.Code.size();
+      if (!compileIncDec(UO, UO->getSubExpr(), UO->isIncrementOp(), Slot))
+        return false;
+      Instr Update = F.Code.back();
+      F.Code.pop_back();
+      if (F.Code.size() != Start)
+        return false;
+      emit(OP_Load, Slot);
+      F.Code.push_back(Update);
+      return true;
+    }
+    case UO_Plus:
+      return compileRValue(UO->getSubExpr());
+    case UO_Minus:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(OP_Neg, 0, Width, Signed);
+      return true;
+    case UO_Not:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(OP_Not, 0, Width, Signed);
+      return true;
+    case UO_LNot:
+      if (!compileRValue(UO->getSubExpr()))
+        return false;
+      emit(OP_LNot);
+      return true;
+    }
+  }
+
+  case Stmt::BinaryOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(E);
+    const Expr *LHS = BO->getLHS(), *RHS = BO->getRHS();
+    Opcode Op;
+    switch (BO->getOpcode()) {
+    default:
+      return false;
+
+    case BO_Comma:
+      return compileDiscarded(LHS) && compileRValue(RHS);
+
+    case BO_LAnd:
+    case BO_LOr: {
+      if (!compileRValue(LHS))
+        return false;
+      emit(OP_Dup);
+      unsigned ToEnd =
+          emit(BO->getOpcode() == BO_LAnd ? OP_JumpIfFalse : OP_JumpIfTrue);
+      emit(OP_Pop);
+      if (!compileRValue(RHS))
+        return false;
+      patchJump(ToEnd);
+      return true;
+    }
+
+    case BO_Mul: Op = OP_Mul; break;
+    case BO_Div: Op = OP_Div; break;
+    case BO_Rem: Op = OP_Rem; break;
+    case BO_Add: Op = OP_Add; break;
+    case BO_Sub: Op = OP_Sub; break;
+    case BO_Shl: Op = OP_Shl; break;
+    case BO_Shr: Op = OP_Shr; break;
+    case BO_And: Op = OP_And; break;
+    case BO_Xor: Op = OP_Xor; break;
+    case BO_Or:  Op = OP_Or;  break;
+    case BO_LT:  Op = OP_LT;  break;
+    case BO_GT:  Op = OP_GT;  break;
+    case BO_LE:  Op = OP_LE;  break;
+    case BO_GE:  Op = OP_GE;  break;
+    case BO_EQ:  Op = OP_EQ;  break;
+    case BO_NE:  Op = OP_NE;  break;
+    }
+    if (!compileRValue(LHS) || !compileRValue(RHS))
+      return false;
+    // Comparisons operate on the (common) type of their operands; the other
+    // operators on the type of their left operand, which is also the type of
+    // the result.
+    bool ShiftAmountSigned = RHS->getType()->isSignedIntegerOrEnumerationType();
+    return emitTyped(Op, LHS->getType(), ShiftAmountSigned);
+  }
+
+  case Stmt::ConditionalOperatorClass: {
+    const ConditionalOperator *CO = cast<ConditionalOperator>(E);
+    if (!compileRValue(CO->getCond()))
+      return false;
+    unsigned ToFalse = emit(OP_JumpIfFalse);
+    if (!compileRValue(CO->getTrueExpr()))
+      return false;
+    unsigned ToEnd = emit(OP_Jump);
+    patchJump(ToFalse);
+    if (!compileRValue(CO->getFalseExpr()))
+      return false;
+    patchJump(ToEnd);
+    return true;
+  }
+
+  case Stmt::CallExprClass:
+    return compileCall(cast<CallExpr>(E));
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Interpretation
+//===----------------------------------------------------------------------===//
+
+/// Convert \p Value to the representation of an integer of the given type.
+static inline int64_t normalize(int64_t Value, unsigned Width, bool Signed) {
+  if (Width == 64)
+    return Value;
+  uint64_t Bits = (uint64_t)Value & (~0ULL >> (64 - Width));
+  return Signed ? llvm::SignExtend64(Bits, Width) : (int64_t)Bits;
+}
+
+static inline int64_t minSignedValue(unsigned Width) {
+  return Width == 64 ? INT64_MIN : -((int64_t)1 << (Width - 1));
+}
+
+static inline int64_t maxSignedValue(unsigned Width) {
+  return Width == 64 ? INT64_MAX : ((int64_t)1 << (Width - 1)) - 1;
+}
+
+/// Perform a binary integer operation. Returns false if the AST evaluator
+/// would diagnose it.
+static bool evalBinOp(const Instr &I, int64_t LHS, int64_t RHS,
+                      int64_t &Result) {
+  unsigned Width = I.Width;
+  uint64_t ULHS = LHS, URHS = RHS;
+
+  switch (I.Op) {
+  case OP_Add:
+  case OP_Sub:
+  case OP_Mul: {
+    uint64_t Value = I.Op == OP_Add ? ULHS + URHS :
+                     I.Op == OP_Sub ? ULHS - URHS : ULHS * URHS;
+    Result = normalize(Value, Width, I.Signed);
+    if (!I.Signed)
+      return true;
+    // Check that the wrapped result is the mathematical result.
+    bool Overflow;
+    if (I.Op == OP_Add)
+      Overflow = (LHS < 0) == (RHS < 0) && ((int64_t)Value < 0) != (LHS < 0);
+    else if (I.Op == OP_Sub)
+      Overflow = (LHS < 0) != (RHS < 0) && ((int64_t)Value < 0) != (LHS < 0);
+    else if (LHS == 0 || RHS == 0)
+      Overflow = false;
+    else if ((LHS == -1 && RHS == INT64_MIN) ||
+             (RHS == -1 && LHS == INT64_MIN))
+      Overflow = true;
+    else
+      Overflow = (int64_t)Value / RHS != LHS;
+    return !Overflow && Result == (int64_t)Value;
+  }
+
+  case OP_Div:
+  case OP_Rem:
+    if (RHS == 0)
+      return false;
+    if (I.Signed) {
+      if (RHS == -1 && LHS == minSignedValue(Width))
+        return false;
+      Result = I.Op == OP_Div ? LHS / RHS : LHS % RHS;
+    } else {
+      Result = I.Op == OP_Div ? ULHS / URHS : ULHS % URHS;
+    }
+    return true;
+
+  case OP_Shl:
+  case OP_Shr: {
+    // Negative and over-wide shifts are not constant expressions.
+    if ((I.Aux && RHS < 0) || URHS >= Width)
+      return false;
+    unsigned Amount = URHS;
+    if (I.Op == OP_Shr) {
+      if (I.Signed && LHS < 0)
+        Result = ~(~LHS >> Amount);
+      else
+        Result = ULHS >> Amount;
+      return true;
+    }
+    // A signed left shift must not shift out any set bits.
+    if (I.Signed &&
+        (LHS < 0 || (Amount && (ULHS >> (Width - Amount)) != 0)))
+      return false;
+    Result = normalize(ULHS << Amount, Width, I.Signed);
+    return true;
+  }
+
+  case OP_And: Result = LHS & RHS; return true;
+  case OP_Or:  Result = LHS | RHS; return true;
+  case OP_Xor: Result = LHS ^ RHS; return true;
+
+  case OP_LT: Result = I.Signed ? LHS <  RHS : ULHS <  URHS; return true;
+  case OP_GT: Result = I.Signed ? LHS >  RHS : ULHS >  URHS; return true;
+  case OP_LE: Result = I.Signed ? LHS <= RHS : ULHS <= URHS; return true;
+  case OP_GE: Result = I.Signed ? LHS >= RHS : ULHS >= URHS; return true;
+  case OP_EQ: Result = LHS == RHS; return true;
+  case OP_NE: Result = LHS != RHS; return true;
+  }
+  llvm_unreachable("not a binary operator");
+}
+
+ConstexprInterpreter::ConstexprInterpreter(ASTContext &Ctx)
+  : Ctx(Ctx), NumCalls(0), NumCallsEvaluated(0) {}
+
+ConstexprInterpreter::~ConstexprInterpreter() {
+  llvm::DeleteContainerSeconds(Functions);
+}
+
+const ConstexprInterpreter::Function *
+ConstexprInterpreter::getFunction(const FunctionDecl *FD) {
+  const FunctionDecl *Definition = 0;
+  if (!FD->getBody(Definition) || FD->isInvalidDecl() ||
+      !Definition->isConstexpr() || Definition->isInvalidDecl())
+    return 0;
+
+  llvm::DenseMap<const FunctionDecl *, Function *>::iterator I =
+      Functions.find(Definition);
+  if (I != Functions.end())
+    return I->second;
+
+  Function *F = new Function;
+  if (!BytecodeCompiler(Ctx, *F).compileFunction(Definition)) {
+    delete F;
+    F = 0;
+  }
+  Functions[Definition] = F;
+  return F;
+}
+
+bool ConstexprInterpreter::execute(const Function &F, ExecutionState &State) {
+  SmallVectorImpl<int64_t> &Stack = State.Stack;
+  // The arguments are already on the stack, and become the first slots.
+  unsigned Base = Stack.size() - F.NumParams;
+  Stack.resize(Base + F.NumSlots);
+  int64_t *Slots;
+
+  for (unsigned PC = 0; /**/; ++PC) {
+    const Instr &I = F.Code[PC];
+    Slots = Stack.data() + Base;
+
+    switch (I.Op) {
+    case OP_Step:
+      if (!State.StepsLeft)
+        return false;
+      --State.StepsLeft;
+      break;
+
+    case OP_Const:
+      Stack.push_back(F.Constants[I.Arg]);
+      break;
+
+    case OP_Load: {
+      int64_t Value = Slots[I.Arg];
+      Stack.push_back(Value);
+      break;
+    }
+
+    case OP_Store:
+      Slots[I.Arg] = Stack.pop_back_val();
+      break;
+
+    case OP_Inc:
+    case OP_Dec: {
+      int64_t &Value = Slots[I.Arg];
+      if (I.Aux && Value == (I.Op == OP_Inc ? maxSignedValue(I.Width)
+                                            : minSignedValue(I.Width)))
+        return false;
+      Value = normalize((uint64_t)Value + (I.Op == OP_Inc ? 1 : -1), I.Width,
+                        I.Signed);
+      break;
+    }
+
+    case OP_Dup: {
+      int64_t Value = Stack.back();
+      Stack.push_back(Value);
+      break;
+    }
+
+    case OP_Pop:
+      Stack.pop_back();
+      break;
+
+    case OP_Swap:
+      std::swap(Stack.back(), Stack[Stack.size() - 2]);
+      break;
+
+    case OP_Convert:
+      Stack.back() = normalize(Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_ToBool:
+      Stack.back() = Stack.back() != 0;
+      break;
+
+    case OP_Neg:
+      if (I.Signed && Stack.back() == minSignedValue(I.Width))
+        return false;
+      Stack.back() = normalize(0 - (uint64_t)Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_Not:
+      Stack.back() = normalize(~Stack.back(), I.Width, I.Signed);
+      break;
+
+    case OP_LNot:
+      Stack.back() = !Stack.back();
+      break;
+
+    case OP_Add: case OP_Sub: case OP_Mul: case OP_Div: case OP_Rem:
+    case OP_Shl: case OP_Shr: case OP_And: case OP_Or: case OP_Xor:
+    case OP_LT: case OP_GT: case OP_LE: case OP_GE: case OP_EQ: case OP_NE: {
+      int64_t RHS = Stack.pop_back_val();
+      if (!evalBinOp(I, Stack.back(), RHS, Stack.back()))
+        return false;
+      break;
+    }
+
+    case OP_Jump:
+      PC = I.Arg - 1;
+      break;
+
+    case OP_JumpIfFalse:
+      if (!Stack.pop_back_val())
+        PC = I.Arg - 1;
+      break;
+
+    case OP_JumpIfTrue:
+      if (Stack.pop_back_val())
+        PC = I.Arg - 1;
+      break;
+
+    case OP_Call: {
+      if (!State.DepthLeft)
+        return false;
+      const Function *Callee = getFunction(F.Callees[I.Arg]);
+      if (!Callee)
+        return false;
+      --State.DepthLeft;
+      if (!execute(*Callee, State))
+        return false;
+      ++State.DepthLeft;
+      break;
+    }
+
+    case OP_Return: {
+      int64_t Value = Stack.back();
+      Stack.resize(Base);
+      Stack.push_back(Value);
+      return true;
+    }
+
+    case OP_FellOff:
+      return false;
+    }
+  }
+}
+
+bool ConstexprInterpreter::evaluateCall(const FunctionDecl *Callee,
+                                        ArrayRef<APValue> Args,
+                                        unsigned &StepsLeft,
+                                        unsigned DepthLeft, APValue &Result) {
+  ++NumCalls;
+  const Function *F = getFunction(Callee);
+  if (!F || Args.size() != F->NumParams)
+    return false;
+
+  ExecutionState State;
+  State.StepsLeft = StepsLeft;
+  State.DepthLeft = DepthLeft;
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    if (!Args[I].isInt())
+      return false;
+    State.Stack.push_back(Args[I].getInt().getExtValue());
+  }
+
+  if (!execute(*F, State))
+    return false;
+
+  ++NumCallsEvaluated;
+  StepsLeft = State.StepsLeft;
+  llvm::APInt Value(F->ReturnWidth, State.Stack.back(), F->ReturnSigned);
+  Result = APValue(llvm::APSInt(Value, !F->ReturnSigned));
+  return true;
+}
+
+void ConstexprInterpreter::PrintStats() const {
+  unsigned NumCompiled = 0;
+  for (llvm::DenseMap<const FunctionDecl *, Function *>::const_iterator
+         I = Functions.begin(), E = Functions.end(); I != E; ++I)
+    if (I->second)
+      ++NumCompiled;
+
+  llvm::errs() << NumCallsEvaluated << "/" << NumCalls
+               << " constexpr calls evaluated by the bytecode interpreter ("
+               << NumCompiled << "/" << Functions.size()
+               << " functions compiled)\n";
+}
@@ -0,0 +1,80 @@
+//===--- ConstexprInterpreter.h - Bytecode constexpr evaluation -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This provides a bytecode interpreter for calls to constexpr functions whose
+// parameters, local variables and return value are all integers.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_CONSTEXPRINTERPRETER_H
+#define LLVM_CLANG_AST_CONSTEXPRINTERPRETER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace clang {
+
+class APValue;
+class ASTContext;
+class FunctionDecl;
+
+/// Evaluates calls to constexpr functions by compiling each function body
+/// once into a compact bytecode over typed integer slots, and interpreting
+/// that instead of re-walking the AST on every loop iteration.
+///
+/// This accelerates the AST evaluator in ExprConstant.cpp rather than
+/// replacing it. Functions using anything other than integer locals,
+/// parameters and arithmetic are not compiled, and evaluation gives up
+/// whenever it reaches something the AST evaluator would diagnose (overflow,
+/// division by zero, running out of steps, ...), so that the caller can
+/// re-evaluate the call to produce the diagnostic.
+class ConstexprInterpreter {
+public:
+  class Function;
+
+private:
+  ASTContext &Ctx;
+
+  /// The compiled form of each function definition we have tried to compile,
+  /// or null if it can't be compiled.
+  llvm::DenseMap<const FunctionDecl *, Function *> Functions;
+
+  /// Statistics.
+  unsigned NumCalls, NumCallsEvaluated;
+
+  struct ExecutionState;
+
+  const Function *getFunction(const FunctionDecl *FD);
+  bool execute(const Function &F, ExecutionState &State);
+
+  ConstexprInterpreter(const ConstexprInterpreter &) LLVM_DELETED_FUNCTION;
+  void operator=(const ConstexprInterpreter &) LLVM_DELETED_FUNCTION;
+
+public:
+  explicit ConstexprInterpreter(ASTContext &Ctx);
+  ~ConstexprInterpreter();
+
+  /// Try to evaluate a call to \p Callee with the given arguments.
+  ///
+  /// \param StepsLeft The number of evaluation steps the call may take, in
+  /// the same units as the AST evaluator. Updated if the call is evaluated.
+  /// \param DepthLeft The number of nested calls the call may make.
+  ///
+  /// \returns true if the call was evaluated, in which case \p Result holds
+  /// its value, or false if it must be evaluated by the AST evaluator.
+  bool evaluateCall(const FunctionDecl *Callee, ArrayRef<APValue> Args,
+                    unsigned &StepsLeft, unsigned DepthLeft, APValue &Result);
+
+  void PrintStats() const;
+};
+
+}
+
+#endif
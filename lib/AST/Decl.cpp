@@ -1918,6 +1918,9 @@ EvaluatedStmt *VarDecl::ensureEvaluatedStmt() const {
     // work to avoid leaking those, but we do so in VarDecl::evaluateValue
     // where we can detect whether there's anything to clean up or not.
     Eval = new (getASTContext()) EvaluatedStmt;
+    if (ASTMemoryAccounting *Accounting =
+            getASTContext().getMemoryAccounting())
+      Accounting->add(ASTMemoryAccounting::APValues, sizeof(EvaluatedStmt));
     Eval->Value = S;
     Init = Eval;
   }
@@ -3188,6 +3191,10 @@ void TagDecl::startDefinition() {
   if (CXXRecordDecl *D = dyn_cast<CXXRecordDecl>(this)) {
     struct CXXRecordDecl::DefinitionData *Data = 
       new (getASTContext()) struct CXXRecordDecl::DefinitionData(D);
+    if (ASTMemoryAccounting *Accounting =
+            getASTContext().getMemoryAccounting())
+      Accounting->add(ASTMemoryAccounting::DefinitionData,
+                      sizeof(CXXRecordDecl::DefinitionData));
     for (redecl_iterator I = redecls_begin(), E = redecls_end(); I != E; ++I)
       cast<CXXRecordDecl>(*I)->DefinitionData = Data;
   }
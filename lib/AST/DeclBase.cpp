@@ -52,6 +52,8 @@ void *Decl::operator new(std::size_t Size, const ASTContext &Context,
   // resulting pointer will still be 8-byte aligned. 
   void *Start = Context.Allocate(Size + Extra + 8);
   void *Result = (char*)Start + 8;
+  if (ASTMemoryAccounting *Accounting = Context.getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::Decls, Size + Extra + 8);
 
   unsigned *PrefixPtr = (unsigned *)Result - 2;
 
@@ -67,6 +69,8 @@ void *Decl::operator new(std::size_t Size, const ASTContext &Context,
 void *Decl::operator new(std::size_t Size, const ASTContext &Ctx,
                          DeclContext *Parent, std::size_t Extra) {
   assert(!Parent || &Parent->getParentASTContext() == &Ctx);
+  if (ASTMemoryAccounting *Accounting = Ctx.getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::Decls, Size + Extra);
   return ::operator new(Size + Extra, Ctx);
 }
 
@@ -1502,7 +1506,12 @@ void DeclContext::makeDeclVisibleInContextImpl(NamedDecl *D, bool Internal) {
         Source->FindExternalVisibleDeclsByName(this, D->getDeclName());
 
   // Insert this declaration into the map.
+  ASTMemoryAccounting *Accounting = getParentASTContext().getMemoryAccounting();
+  size_t OldMapSize = Accounting ? Map->getMemorySize() : 0;
   StoredDeclsList &DeclNameEntries = (*Map)[D->getDeclName()];
+  if (Accounting)
+    Accounting->add(ASTMemoryAccounting::DeclContextMaps,
+                    Map->getMemorySize() - OldMapSize);
 
   if (Internal) {
     // If this is being added as part of loading an external declaration,
@@ -1555,6 +1564,10 @@ StoredDeclsMap *DeclContext::CreateStoredDeclsMap(ASTContext &C) const {
     M = new DependentStoredDeclsMap();
   else
     M = new StoredDeclsMap();
+  if (ASTMemoryAccounting *Accounting = C.getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::DeclContextMaps,
+                    Dependent ? sizeof(DependentStoredDeclsMap)
+                              : sizeof(StoredDeclsMap));
   M->Previous = C.LastSDM;
   C.LastSDM = llvm::PointerIntPair<StoredDeclsMap*,1>(M, Dependent);
   LookupPtr.setPointer(M);
@@ -19,6 +19,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
+#include "clang/AST/ODRHash.h"
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "llvm/ADT/STLExtras.h"
@@ -71,8 +72,8 @@ CXXRecordDecl::DefinitionData::DefinitionData(CXXRecordDecl *D)
     ImplicitCopyAssignmentHasConstParam(true),
     HasDeclaredCopyConstructorWithConstParam(false),
     HasDeclaredCopyAssignmentWithConstParam(false),
-    IsLambda(false), NumBases(0), NumVBases(0), Bases(), VBases(),
-    Definition(D), FirstFriend() {
+    IsLambda(false), HasODRHash(false), NumBases(0), NumVBases(0),
+    ODRHash(0), Bases(), VBases(), Definition(D), FirstFriend() {
 }
 
 CXXBaseSpecifier *CXXRecordDecl::DefinitionData::getBasesSlowCase() const {
@@ -117,6 +118,9 @@ CXXRecordDecl *CXXRecordDecl::CreateLambda(const ASTContext &C, DeclContext *DC,
                                                           Dependent, 
                                                           IsGeneric, 
                                                           CaptureDefault);
+  if (ASTMemoryAccounting *Accounting = C.getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::DefinitionData,
+                    sizeof(LambdaDefinitionData));
   R->MayHaveOutOfDateDef = false;
   R->setImplicit(true);
   C.getTypeDeclType(R, /*PrevDecl=*/0);
@@ -131,6 +135,25 @@ CXXRecordDecl::CreateDeserialized(const ASTContext &C, unsigned ID) {
   return R;
 }
 
+unsigned CXXRecordDecl::getODRHash() const {
+  assert(DefinitionData && "hashing a class without a definition");
+  struct DefinitionData &Data = *DefinitionData;
+  if (Data.HasODRHash)
+    return Data.ODRHash;
+
+  ODRHash Hash(getASTContext());
+  Hash.AddCXXRecordDecl(Data.Definition);
+  unsigned Result = Hash.CalculateHash();
+
+  // The members of a class that is still being defined can change, so only
+  // cache the hash of a complete definition.
+  if (!Data.Definition->isBeingDefined()) {
+    Data.HasODRHash = true;
+    Data.ODRHash = Result;
+  }
+  return Result;
+}
+
 void
 CXXRecordDecl::setBases(CXXBaseSpecifier const * const *Bases,
                         unsigned NumBases) {
@@ -1704,6 +1727,11 @@ CXXConstructorDecl::Create(ASTContext &C, CXXRecordDecl *RD,
                                         isImplicitlyDeclared, isConstexpr);
 }
 
+CXXConstructorDecl::init_const_iterator
+CXXConstructorDecl::init_begin() const {
+  return CtorInitializers.get(getASTContext().getExternalSource());
+}
+
 CXXConstructorDecl *CXXConstructorDecl::getTargetConstructor() const {
   assert(isDelegatingConstructor() && "Not a delegating constructor!");
   Expr *E = (*init_begin())->getInit()->IgnoreImplicit();
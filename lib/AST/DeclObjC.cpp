@@ -455,6 +455,9 @@ void ObjCInterfaceDecl::allocateDefinitionData() {
   assert(!hasDefinition() && "ObjC class already has a definition");
   Data.setPointer(new (getASTContext()) DefinitionData());
   Data.getPointer()->Definition = this;
+  if (ASTMemoryAccounting *Accounting = getASTContext().getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::DefinitionData,
+                    sizeof(DefinitionData));
 
   // Make the type point at the definition, now that we have one.
   if (TypeForDecl)
@@ -1585,6 +1588,9 @@ void ObjCProtocolDecl::allocateDefinitionData() {
   assert(!Data.getPointer() && "Protocol already has a definition!");
   Data.setPointer(new (getASTContext()) DefinitionData);
   Data.getPointer()->Definition = this;
+  if (ASTMemoryAccounting *Accounting = getASTContext().getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::DefinitionData,
+                    sizeof(DefinitionData));
 }
 
 void ObjCProtocolDecl::startDefinition() {
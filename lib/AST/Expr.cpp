@@ -342,6 +342,21 @@ void DeclRefExpr::computeDependence(const ASTContext &Ctx) {
     ExprBits.ContainsUnexpandedParameterPack = true;
 }
 
+/// \brief Whether a declaration name of this kind carries source information
+/// beyond its location, which a DeclRefExpr then stores after itself.
+static bool nameHasLocInfo(DeclarationName Name) {
+  switch (Name.getNameKind()) {
+  case DeclarationName::CXXConstructorName:
+  case DeclarationName::CXXDestructorName:
+  case DeclarationName::CXXConversionFunctionName:
+  case DeclarationName::CXXOperatorName:
+  case DeclarationName::CXXLiteralOperatorName:
+    return true;
+  default:
+    return false;
+  }
+}
+
 DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
                          NestedNameSpecifierLoc QualifierLoc,
                          SourceLocation TemplateKWLoc,
@@ -351,7 +366,10 @@ DeclRefExpr::DeclRefExpr(const ASTContext &Ctx,
                          const TemplateArgumentListInfo *TemplateArgs,
                          QualType T, ExprValueKind VK)
   : Expr(DeclRefExprClass, T, VK, OK_Ordinary, false, false, false, false),
-    D(D), Loc(NameInfo.getLoc()), DNLoc(NameInfo.getInfo()) {
+    D(D), Loc(NameInfo.getLoc()) {
+  DeclRefExprBits.HasNameLoc = nameHasLocInfo(NameInfo.getName()) ? 1 : 0;
+  if (hasNameLoc())
+    getInternalNameLoc() = NameInfo.getInfo();
   DeclRefExprBits.HasQualifier = QualifierLoc ? 1 : 0;
   if (QualifierLoc)
     getInternalQualifierLoc() = QualifierLoc;
@@ -410,6 +428,8 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
     FoundD = 0;
 
   std::size_t Size = sizeof(DeclRefExpr);
+  if (nameHasLocInfo(NameInfo.getName()))
+    Size += sizeof(DeclarationNameLoc);
   if (QualifierLoc)
     Size += sizeof(NestedNameSpecifierLoc);
   if (FoundD)
@@ -418,6 +438,7 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
     Size += ASTTemplateKWAndArgsInfo::sizeFor(TemplateArgs->size());
   else if (TemplateKWLoc.isValid())
     Size += ASTTemplateKWAndArgsInfo::sizeFor(0);
+  noteExtraBytes(DeclRefExprClass, Size - sizeof(DeclRefExpr));
 
   void *Mem = Context.Allocate(Size, llvm::alignOf<DeclRefExpr>());
   return new (Mem) DeclRefExpr(Context, QualifierLoc, TemplateKWLoc, D,
@@ -426,17 +447,21 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
 }
 
 DeclRefExpr *DeclRefExpr::CreateEmpty(const ASTContext &Context,
+                                      bool HasNameLoc,
                                       bool HasQualifier,
                                       bool HasFoundDecl,
                                       bool HasTemplateKWAndArgsInfo,
                                       unsigned NumTemplateArgs) {
   std::size_t Size = sizeof(DeclRefExpr);
+  if (HasNameLoc)
+    Size += sizeof(DeclarationNameLoc);
   if (HasQualifier)
     Size += sizeof(NestedNameSpecifierLoc);
   if (HasFoundDecl)
     Size += sizeof(NamedDecl *);
   if (HasTemplateKWAndArgsInfo)
     Size += ASTTemplateKWAndArgsInfo::sizeFor(NumTemplateArgs);
+  noteExtraBytes(DeclRefExprClass, Size - sizeof(DeclRefExpr));
 
   void *Mem = Context.Allocate(Size, llvm::alignOf<DeclRefExpr>());
   return new (Mem) DeclRefExpr(EmptyShell());
@@ -1078,6 +1103,7 @@ CallExpr::CallExpr(const ASTContext& C, StmtClass SC, Expr *fn,
     NumArgs(args.size()) {
 
   SubExprs = new (C) Stmt*[args.size()+PREARGS_START+NumPreArgs];
+  noteExtraBytes(SC, (args.size()+PREARGS_START+NumPreArgs) * sizeof(Stmt*));
   SubExprs[FN] = fn;
   for (unsigned i = 0; i != args.size(); ++i) {
     if (args[i]->isTypeDependent())
@@ -1106,6 +1132,7 @@ CallExpr::CallExpr(const ASTContext& C, Expr *fn, ArrayRef<Expr*> args,
     NumArgs(args.size()) {
 
   SubExprs = new (C) Stmt*[args.size()+PREARGS_START];
+  noteExtraBytes(CallExprClass, (args.size()+PREARGS_START) * sizeof(Stmt*));
   SubExprs[FN] = fn;
   for (unsigned i = 0; i != args.size(); ++i) {
     if (args[i]->isTypeDependent())
@@ -1128,6 +1155,7 @@ CallExpr::CallExpr(const ASTContext &C, StmtClass SC, EmptyShell Empty)
   : Expr(SC, Empty), SubExprs(0), NumArgs(0) {
   // FIXME: Why do we allocate this?
   SubExprs = new (C) Stmt*[PREARGS_START];
+  noteExtraBytes(SC, PREARGS_START * sizeof(Stmt*));
   CallExprBits.NumPreArgs = 0;
 }
 
@@ -1136,6 +1164,7 @@ CallExpr::CallExpr(const ASTContext &C, StmtClass SC, unsigned NumPreArgs,
   : Expr(SC, Empty), SubExprs(0), NumArgs(0) {
   // FIXME: Why do we allocate this?
   SubExprs = new (C) Stmt*[PREARGS_START+NumPreArgs];
+  noteExtraBytes(SC, (PREARGS_START+NumPreArgs) * sizeof(Stmt*));
   CallExprBits.NumPreArgs = NumPreArgs;
 }
 
@@ -1183,6 +1212,8 @@ void CallExpr::setNumArgs(const ASTContext& C, unsigned NumArgs) {
   // Otherwise, we are growing the # arguments.  New an bigger argument array.
   unsigned NumPreArgs = getNumPreArgs();
   Stmt **NewSubExprs = new (C) Stmt*[NumArgs+PREARGS_START+NumPreArgs];
+  noteExtraBytes(getStmtClass(),
+                 (NumArgs+PREARGS_START+NumPreArgs) * sizeof(Stmt*));
   // Copy over args.
   for (unsigned i = 0; i != getNumArgs()+PREARGS_START+NumPreArgs; ++i)
     NewSubExprs[i] = SubExprs[i];
@@ -1327,6 +1358,10 @@ MemberExpr *MemberExpr::Create(const ASTContext &C, Expr *base, bool isarrow,
                                ExprObjectKind ok) {
   std::size_t Size = sizeof(MemberExpr);
 
+  bool hasNameLoc = nameHasLocInfo(nameinfo.getName());
+  if (hasNameLoc)
+    Size += sizeof(DeclarationNameLoc);
+
   bool hasQualOrFound = (QualifierLoc ||
                          founddecl.getDecl() != memberdecl ||
                          founddecl.getAccess() != memberdecl->getAccess());
@@ -1337,11 +1372,17 @@ MemberExpr *MemberExpr::Create(const ASTContext &C, Expr *base, bool isarrow,
     Size += ASTTemplateKWAndArgsInfo::sizeFor(targs->size());
   else if (TemplateKWLoc.isValid())
     Size += ASTTemplateKWAndArgsInfo::sizeFor(0);
+  noteExtraBytes(MemberExprClass, Size - sizeof(MemberExpr));
 
   void *Mem = C.Allocate(Size, llvm::alignOf<MemberExpr>());
   MemberExpr *E = new (Mem) MemberExpr(base, isarrow, memberdecl, nameinfo,
                                        ty, vk, ok);
 
+  if (hasNameLoc) {
+    E->HasNameLoc = true;
+    E->getInternalNameLoc() = nameinfo.getInfo();
+  }
+
   if (hasQualOrFound) {
     // FIXME: Wrong. We should be looking at the member declaration we found.
     if (QualifierLoc && QualifierLoc.getNestedNameSpecifier()->isDependent()) {
@@ -1701,6 +1742,7 @@ ImplicitCastExpr *ImplicitCastExpr::Create(const ASTContext &C, QualType T,
   unsigned PathSize = (BasePath ? BasePath->size() : 0);
   void *Buffer =
     C.Allocate(sizeof(ImplicitCastExpr) + PathSize * sizeof(CXXBaseSpecifier*));
+  noteExtraBytes(ImplicitCastExprClass, PathSize * sizeof(CXXBaseSpecifier*));
   ImplicitCastExpr *E =
     new (Buffer) ImplicitCastExpr(T, Kind, Operand, PathSize, VK);
   if (PathSize) E->setCastPath(*BasePath);
@@ -1711,6 +1753,7 @@ ImplicitCastExpr *ImplicitCastExpr::CreateEmpty(const ASTContext &C,
                                                 unsigned PathSize) {
   void *Buffer =
     C.Allocate(sizeof(ImplicitCastExpr) + PathSize * sizeof(CXXBaseSpecifier*));
+  noteExtraBytes(ImplicitCastExprClass, PathSize * sizeof(CXXBaseSpecifier*));
   return new (Buffer) ImplicitCastExpr(EmptyShell(), PathSize);
 }
 
@@ -1723,6 +1766,7 @@ CStyleCastExpr *CStyleCastExpr::Create(const ASTContext &C, QualType T,
   unsigned PathSize = (BasePath ? BasePath->size() : 0);
   void *Buffer =
     C.Allocate(sizeof(CStyleCastExpr) + PathSize * sizeof(CXXBaseSpecifier*));
+  noteExtraBytes(CStyleCastExprClass, PathSize * sizeof(CXXBaseSpecifier*));
   CStyleCastExpr *E =
     new (Buffer) CStyleCastExpr(T, VK, K, Op, PathSize, WrittenTy, L, R);
   if (PathSize) E->setCastPath(*BasePath);
@@ -1733,6 +1777,7 @@ CStyleCastExpr *CStyleCastExpr::CreateEmpty(const ASTContext &C,
                                             unsigned PathSize) {
   void *Buffer =
     C.Allocate(sizeof(CStyleCastExpr) + PathSize * sizeof(CXXBaseSpecifier*));
+  noteExtraBytes(CStyleCastExprClass, PathSize * sizeof(CXXBaseSpecifier*));
   return new (Buffer) CStyleCastExpr(EmptyShell(), PathSize);
 }
 
@@ -33,6 +33,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "ConstexprInterpreter.h"
 #include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
@@ -44,6 +45,7 @@
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 #include <functional>
@@ -452,6 +454,18 @@ namespace {
     /// notes attached to it will also be stored, otherwise they will not be.
     bool HasActiveDiagnostic;
 
+    /// UnmemoizableEvents - The number of diagnostics, side-effects and
+    /// accesses to the object under construction seen so far, whether or not
+    /// they were recorded. A constexpr call during which this doesn't change
+    /// only depended on its arguments, so its result can be memoized.
+    unsigned UnmemoizableEvents;
+
+    /// InInterpreterFallback - Are we walking the AST of a call that the
+    /// bytecode interpreter gave up on? The calls nested in it are not tried
+    /// in the interpreter again: each attempt could spend all the remaining
+    /// steps before giving up the same way.
+    bool InInterpreterFallback;
+
     enum EvaluationMode {
       /// Evaluate as a constant expression. Stop if we find that the expression
       /// is not a constant expression.
@@ -511,7 +525,8 @@ namespace {
         StepsLeft(getLangOpts().ConstexprStepLimit),
         BottomFrame(*this, SourceLocation(), 0, 0, 0),
         EvaluatingDecl((const ValueDecl*)0), EvaluatingDeclValue(0),
-        HasActiveDiagnostic(false), EvalMode(Mode) {}
+        HasActiveDiagnostic(false), UnmemoizableEvents(0),
+        InInterpreterFallback(false), EvalMode(Mode) {}
 
     void setEvaluatingDecl(APValue::LValueBase Base, APValue &Value) {
       EvaluatingDecl = Base;
@@ -572,6 +587,7 @@ namespace {
     OptionalDiagnostic Diag(SourceLocation Loc, diag::kind DiagId
                               = diag::note_invalid_subexpr_in_const_expr,
                             unsigned ExtraNotes = 0) {
+      ++UnmemoizableEvents;
       if (EvalStatus.Diag) {
         // If we have a prior diagnostic, it will be noting that the expression
         // isn't a constant expression. This diagnostic is more important,
@@ -621,6 +637,7 @@ namespace {
                             unsigned ExtraNotes = 0) {
       if (EvalStatus.Diag)
         return Diag(E->getExprLoc(), DiagId, ExtraNotes);
+      ++UnmemoizableEvents;
       HasActiveDiagnostic = false;
       return OptionalDiagnostic();
     }
@@ -637,6 +654,7 @@ namespace {
       // Don't override a previous diagnostic. Don't bother collecting
       // diagnostics if we're evaluating for overflow.
       if (!EvalStatus.Diag || !EvalStatus.Diag->empty()) {
+        ++UnmemoizableEvents;
         HasActiveDiagnostic = false;
         return OptionalDiagnostic();
       }
@@ -679,6 +697,7 @@ namespace {
     /// Note that we have had a side-effect, and determine whether we should
     /// keep evaluating.
     bool noteSideEffect() {
+      ++UnmemoizableEvents;
       EvalStatus.HasSideEffects = true;
       return keepEvaluatingAfterSideEffect();
     }
@@ -1593,12 +1612,14 @@ static APSInt CheckedIntArithmetic(EvalInfo &Info, const Expr *E,
   APSInt Value(Op(LHS.extend(BitWidth), RHS.extend(BitWidth)), false);
   APSInt Result = Value.trunc(LHS.getBitWidth());
   if (Result.extend(BitWidth) != Value) {
-    if (Info.checkingForOverflow())
+    if (Info.checkingForOverflow()) {
+      ++Info.UnmemoizableEvents;
       Info.Ctx.getDiagnostics().Report(E->getExprLoc(),
         diag::warn_integer_constant_overflow)
           << Result.toString(10) << E->getType();
-    else
+    } else {
       HandleOverflow(Info, E, Value, E->getType());
+    }
   }
   return Result;
 }
@@ -1943,6 +1964,7 @@ static bool evaluateVarDeclInit(EvalInfo &Info, const Expr *E,
   // If we're currently evaluating the initializer of this declaration, use that
   // in-flight value.
   if (Info.EvaluatingDecl.dyn_cast<const ValueDecl*>() == VD) {
+    ++Info.UnmemoizableEvents;
     Result = Info.EvaluatingDeclValue;
     return true;
   }
@@ -2574,6 +2596,7 @@ CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E, AccessKinds AK,
   // and this doesn't do quite the right thing for const subobjects of the
   // object under construction.
   if (LVal.getLValueBase() == Info.EvaluatingDecl) {
+    ++Info.UnmemoizableEvents;
     BaseType = Info.Ctx.getCanonicalType(BaseType);
     BaseType.removeLocalConst();
   }
@@ -3586,6 +3609,86 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+/// Profile a value for the constexpr call cache. Returns false if the value
+/// refers to an object, and so can't be part of a memoized call.
+static bool profileMemoizableValue(llvm::FoldingSetNodeID &ID,
+                                   const APValue &V) {
+  ID.AddInteger(V.getKind());
+  switch (V.getKind()) {
+  case APValue::Uninitialized:
+    return true;
+  case APValue::Int:
+    V.getInt().Profile(ID);
+    return true;
+  case APValue::Float:
+    V.getFloat().Profile(ID);
+    return true;
+  case APValue::ComplexInt:
+    V.getComplexIntReal().Profile(ID);
+    V.getComplexIntImag().Profile(ID);
+    return true;
+  case APValue::ComplexFloat:
+    V.getComplexFloatReal().Profile(ID);
+    V.getComplexFloatImag().Profile(ID);
+    return true;
+  case APValue::Vector:
+    ID.AddInteger(V.getVectorLength());
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      if (!profileMemoizableValue(ID, V.getVectorElt(I)))
+        return false;
+    return true;
+  case APValue::Array:
+    ID.AddInteger(V.getArraySize());
+    ID.AddInteger(V.getArrayInitializedElts());
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      if (!profileMemoizableValue(ID, V.getArrayInitializedElt(I)))
+        return false;
+    return !V.hasArrayFiller() ||
+           profileMemoizableValue(ID, V.getArrayFiller());
+  case APValue::Struct:
+    ID.AddInteger(V.getStructNumBases());
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      if (!profileMemoizableValue(ID, V.getStructBase(I)))
+        return false;
+    ID.AddInteger(V.getStructNumFields());
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      if (!profileMemoizableValue(ID, V.getStructField(I)))
+        return false;
+    return true;
+  case APValue::Union:
+    ID.AddPointer(V.getUnionField());
+    return !V.getUnionField() ||
+           profileMemoizableValue(ID, V.getUnionValue());
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
+    return false;
+  }
+  llvm_unreachable("Unknown APValue kind!");
+}
+
+/// Determine whether the value of a call that only depends on its arguments
+/// can be computed outside this evaluation, either from the constexpr call
+/// cache or by the bytecode interpreter.
+static bool canEvaluateCallsOutOfContext(EvalInfo &Info) {
+  switch (Info.EvalMode) {
+  // A memoized or interpreted call didn't overflow, since that is diagnosed.
+  case EvalInfo::EM_ConstantExpression:
+  case EvalInfo::EM_ConstantFold:
+  case EvalInfo::EM_EvaluateForOverflow:
+  case EvalInfo::EM_IgnoreSideEffects:
+    return true;
+
+  // Potential constant expressions don't have argument values, and some
+  // builtins evaluate differently in unevaluated operands.
+  case EvalInfo::EM_PotentialConstantExpression:
+  case EvalInfo::EM_PotentialConstantExpressionUnevaluated:
+  case EvalInfo::EM_ConstantExpressionUnevaluated:
+    return false;
+  }
+  llvm_unreachable("Missed EvalMode case");
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
@@ -3598,6 +3701,44 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
+  // A call with no 'this' and arguments that don't refer to any object can
+  // only depend on its arguments, unless its evaluation notes otherwise.
+  llvm::FoldingSetNodeID CallID;
+  bool OutOfContext = !This && canEvaluateCallsOutOfContext(Info);
+  bool Memoize = OutOfContext && Info.getLangOpts().ConstexprCallCache;
+  if (Memoize) {
+    CallID.AddPointer(Callee->getCanonicalDecl());
+    for (unsigned I = 0, N = ArgValues.size(); Memoize && I != N; ++I)
+      Memoize = profileMemoizableValue(CallID, ArgValues[I]);
+  }
+  if (Memoize) {
+    if (const APValue *Memoized = Info.Ctx.getConstexprCallResult(CallID)) {
+      if (!Info.nextStep(Body))
+        return false;
+      Result = *Memoized;
+      return true;
+    }
+  }
+  unsigned UnmemoizableEvents = Info.UnmemoizableEvents;
+
+  // Try the bytecode interpreter. It gives up on anything we would diagnose,
+  // in which case we evaluate the call again below to produce the notes.
+  llvm::SaveAndRestore<bool> Fallback(Info.InInterpreterFallback);
+  if (OutOfContext && Info.getLangOpts().ConstexprBytecode &&
+      !Info.InInterpreterFallback) {
+    unsigned StepsLeft = Info.StepsLeft;
+    unsigned DepthLeft =
+        Info.getLangOpts().ConstexprCallDepth - Info.CallStackDepth;
+    if (Info.Ctx.getConstexprInterpreter().evaluateCall(
+            Callee, ArgValues, StepsLeft, DepthLeft, Result)) {
+      Info.StepsLeft = StepsLeft;
+      if (Memoize)
+        Info.Ctx.setConstexprCallResult(CallID, Result);
+      return true;
+    }
+    Info.InInterpreterFallback = true;
+  }
+
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -3626,7 +3767,16 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.Diag(Callee->getLocEnd(), diag::note_constexpr_no_return);
   }
-  return ESR == ESR_Returned;
+  if (ESR != ESR_Returned)
+    return false;
+
+  if (Memoize && Info.UnmemoizableEvents == UnmemoizableEvents &&
+      !Result.isUninit()) {
+    llvm::FoldingSetNodeID ResultID;
+    if (profileMemoizableValue(ResultID, Result))
+      Info.Ctx.setConstexprCallResult(CallID, Result);
+  }
+  return true;
 }
 
 /// Evaluate a constructor call.
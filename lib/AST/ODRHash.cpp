@@ -0,0 +1,189 @@
+//===--- ODRHash.cpp - Content hashing of declarations ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ODRHash class, which computes a hash of the
+// contents of a declaration that is stable across AST files.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ODRHash.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/Stmt.h"
+using namespace clang;
+
+void ODRHash::AddQualType(QualType T) {
+  if (T.isNull()) {
+    ID.AddInteger(0);
+    return;
+  }
+
+  // Hash the spelling of the canonical type; its address differs between
+  // AST files.
+  ID.AddString(Context.getCanonicalType(T).getAsString(
+                 Context.getPrintingPolicy()));
+}
+
+void ODRHash::AddDeclarationName(DeclarationName Name) {
+  ID.AddInteger(Name.getNameKind());
+  ID.AddString(Name.getAsString());
+}
+
+void ODRHash::AddStmt(const Stmt *S) {
+  ID.AddBoolean(S != 0);
+  if (S)
+    S->ProfileODR(ID, Context);
+}
+
+void ODRHash::AddTemplateParameterList(const TemplateParameterList *Params) {
+  ID.AddInteger(Params->size());
+  for (TemplateParameterList::const_iterator P = Params->begin(),
+                                             PEnd = Params->end();
+       P != PEnd; ++P) {
+    ID.AddInteger((*P)->getKind());
+    AddDeclarationName((*P)->getDeclName());
+    if (const NonTypeTemplateParmDecl *NTTP =
+          dyn_cast<NonTypeTemplateParmDecl>(*P))
+      AddQualType(NTTP->getType());
+    else if (const TemplateTemplateParmDecl *TTP =
+               dyn_cast<TemplateTemplateParmDecl>(*P))
+      AddTemplateParameterList(TTP->getTemplateParameters());
+  }
+}
+
+void ODRHash::AddCXXRecordDecl(const CXXRecordDecl *Record) {
+  assert(Record->hasDefinition() && "hashing a class without a definition");
+  const CXXRecordDecl *Def = Record->getDefinition();
+
+  ID.AddInteger(Def->getTagKind());
+  AddDeclarationName(Def->getDeclName());
+
+  ID.AddInteger(Def->getNumBases());
+  for (CXXRecordDecl::base_class_const_iterator B = Def->bases_begin(),
+                                                BEnd = Def->bases_end();
+       B != BEnd; ++B) {
+    ID.AddBoolean(B->isVirtual());
+    ID.AddInteger(B->getAccessSpecifierAsWritten());
+    ID.AddBoolean(B->isPackExpansion());
+    AddQualType(B->getType());
+  }
+
+  // Implicit members are derived from the explicit ones, so they add
+  // nothing to the hash; skipping them also keeps the hash independent of
+  // which special members happen to have been declared so far.
+  for (DeclContext::decl_iterator D = Def->decls_begin(),
+                                  DEnd = Def->decls_end();
+       D != DEnd; ++D) {
+    if (!D->isImplicit())
+      AddSubDecl(*D);
+  }
+}
+
+void ODRHash::AddSubDecl(const Decl *D) {
+  ID.AddInteger(D->getKind());
+  ID.AddInteger(D->getAccess());
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    AddDeclarationName(ND->getDeclName());
+
+  if (const FieldDecl *Field = dyn_cast<FieldDecl>(D)) {
+    AddQualType(Field->getType());
+    ID.AddBoolean(Field->isMutable());
+    AddStmt(Field->getBitWidth());
+    AddStmt(Field->getInClassInitializer());
+    return;
+  }
+
+  if (const FunctionDecl *Function = dyn_cast<FunctionDecl>(D)) {
+    AddQualType(Function->getType());
+    ID.AddInteger(Function->getStorageClass());
+    ID.AddBoolean(Function->isInlineSpecified());
+    ID.AddBoolean(Function->isVirtualAsWritten());
+    ID.AddBoolean(Function->isPure());
+    ID.AddBoolean(Function->isDeletedAsWritten());
+    ID.AddBoolean(Function->isExplicitlyDefaulted());
+    ID.AddBoolean(Function->isConstexpr());
+    if (const CXXConstructorDecl *Ctor = dyn_cast<CXXConstructorDecl>(D)) {
+      ID.AddBoolean(Ctor->isExplicitSpecified());
+      ID.AddInteger(Ctor->init_end() - Ctor->init_begin());
+      for (CXXConstructorDecl::init_const_iterator I = Ctor->init_begin(),
+                                                   IEnd = Ctor->init_end();
+           I != IEnd; ++I) {
+        if (TypeSourceInfo *TSI = (*I)->getTypeSourceInfo())
+          AddQualType(TSI->getType());
+        else if (const FieldDecl *Member = (*I)->getAnyMember())
+          AddDeclarationName(Member->getDeclName());
+        AddStmt((*I)->getInit());
+      }
+    }
+    ID.AddBoolean(Function->doesThisDeclarationHaveABody());
+    if (Function->doesThisDeclarationHaveABody())
+      AddStmt(Function->getBody());
+    return;
+  }
+
+  if (const VarDecl *Var = dyn_cast<VarDecl>(D)) {
+    AddQualType(Var->getType());
+    ID.AddInteger(Var->getStorageClass());
+    ID.AddBoolean(Var->isConstexpr());
+    AddStmt(Var->getInit());
+    return;
+  }
+
+  if (const TypedefNameDecl *Typedef = dyn_cast<TypedefNameDecl>(D)) {
+    AddQualType(Typedef->getUnderlyingType());
+    return;
+  }
+
+  if (const EnumDecl *Enum = dyn_cast<EnumDecl>(D)) {
+    ID.AddBoolean(Enum->isScoped());
+    AddQualType(Enum->getIntegerType());
+    for (EnumDecl::enumerator_iterator E = Enum->enumerator_begin(),
+                                       EEnd = Enum->enumerator_end();
+         E != EEnd; ++E) {
+      AddDeclarationName(E->getDeclName());
+      AddStmt(E->getInitExpr());
+    }
+    return;
+  }
+
+  if (const CXXRecordDecl *Record = dyn_cast<CXXRecordDecl>(D)) {
+    ID.AddBoolean(Record->isThisDeclarationADefinition());
+    if (Record->isThisDeclarationADefinition())
+      AddCXXRecordDecl(Record);
+    return;
+  }
+
+  if (const TemplateDecl *Template = dyn_cast<TemplateDecl>(D)) {
+    AddTemplateParameterList(Template->getTemplateParameters());
+    if (const NamedDecl *Pattern = Template->getTemplatedDecl())
+      AddSubDecl(Pattern);
+    return;
+  }
+
+  if (const FriendDecl *Friend = dyn_cast<FriendDecl>(D)) {
+    if (TypeSourceInfo *TSI = Friend->getFriendType())
+      AddQualType(TSI->getType());
+    else if (const NamedDecl *FriendND = Friend->getFriendDecl())
+      AddSubDecl(FriendND);
+    return;
+  }
+
+  if (const StaticAssertDecl *Assert = dyn_cast<StaticAssertDecl>(D)) {
+    AddStmt(Assert->getAssertExpr());
+    return;
+  }
+}
+
+unsigned ODRHash::CalculateHash() {
+  unsigned Hash = ID.ComputeHash();
+  return Hash ? Hash : 1;
+}
@@ -13,6 +13,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
+#include "clang/AST/ASTMemoryAccounting.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/ExprCLI.h"
 #include "clang/AST/ExprObjC.h"
@@ -33,6 +34,7 @@ static struct StmtClassNameTable {
   const char *Name;
   unsigned Counter;
   unsigned Size;
+  uint64_t ExtraBytes;
 } StmtClassInfo[Stmt::lastStmtConstant+1];
 
 static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
@@ -51,6 +53,15 @@ static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
   return StmtClassInfo[E];
 }
 
+/// \brief The size of each statement class. Unlike StmtClassInfo, this table
+/// is never written, so memory accounting can read it from any thread.
+static const unsigned StmtClassSizes[Stmt::lastStmtConstant+1] = {
+  0, // NoStmtClass
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT) sizeof(CLASS),
+#include "clang/AST/StmtNodes.inc"
+};
+
 void *Stmt::operator new(size_t bytes, const ASTContext& C,
                          unsigned alignment) {
   return ::operator new(bytes, C, alignment);
@@ -64,7 +75,7 @@ void Stmt::PrintStats() {
   // Ensure the table is primed.
   getStmtInfoTableEntry(Stmt::NullStmtClass);
 
-  unsigned sum = 0;
+  uint64_t sum = 0;
   llvm::errs() << "\n*** Stmt/Expr Stats:\n";
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == 0) continue;
@@ -75,11 +86,15 @@ void Stmt::PrintStats() {
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == 0) continue;
     if (StmtClassInfo[i].Counter == 0) continue;
+    uint64_t Bytes = (uint64_t)StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
     llvm::errs() << "    " << StmtClassInfo[i].Counter << " "
                  << StmtClassInfo[i].Name << ", " << StmtClassInfo[i].Size
-                 << " each (" << StmtClassInfo[i].Counter*StmtClassInfo[i].Size
-                 << " bytes)\n";
-    sum += StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
+                 << " each (" << Bytes << " bytes";
+    if (StmtClassInfo[i].ExtraBytes)
+      llvm::errs() << " + " << StmtClassInfo[i].ExtraBytes
+                   << " bytes trailing/out-of-line";
+    llvm::errs() << ")\n";
+    sum += Bytes + StmtClassInfo[i].ExtraBytes;
   }
 
   llvm::errs() << "Total bytes = " << sum << "\n";
@@ -89,6 +104,26 @@ void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
 
+void Stmt::addStmtExtraBytes(StmtClass s, size_t Bytes) {
+  getStmtInfoTableEntry(s).ExtraBytes += Bytes;
+}
+
+void Stmt::noteStmtClass(StmtClass SC) {
+  if (StatisticsEnabled)
+    addStmtClass(SC);
+  if (ASTMemoryAccounting *Accounting = ASTMemoryAccounting::getCurrent())
+    Accounting->add(ASTMemoryAccounting::Stmts, StmtClassSizes[SC]);
+}
+
+void Stmt::noteExtraBytes(StmtClass SC, size_t Bytes) {
+  if (!Bytes)
+    return;
+  if (StatisticsEnabled)
+    addStmtExtraBytes(SC, Bytes);
+  if (ASTMemoryAccounting *Accounting = ASTMemoryAccounting::getCurrent())
+    Accounting->add(ASTMemoryAccounting::Stmts, Bytes);
+}
+
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
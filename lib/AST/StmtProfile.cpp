@@ -20,6 +20,7 @@
 #include "clang/AST/ExprObjC.h"
 #include "clang/AST/StmtVisitor.h"
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace clang;
 
 namespace {
@@ -28,10 +29,15 @@ namespace {
     const ASTContext &Context;
     bool Canonical;
 
+    /// \brief Whether referenced declarations, types and names are profiled
+    /// by their spelling rather than by their address, so that the profile
+    /// is the same in every AST file that contains the statement.
+    bool ODR;
+
   public:
     StmtProfiler(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
-                 bool Canonical)
-      : ID(ID), Context(Context), Canonical(Canonical) { }
+                 bool Canonical, bool ODR = false)
+      : ID(ID), Context(Context), Canonical(Canonical), ODR(ODR) { }
 
     void VisitStmt(const Stmt *S);
 
@@ -389,7 +395,7 @@ void StmtProfiler::VisitOffsetOfExpr(const OffsetOfExpr *S) {
       break;
 
     case OffsetOfExpr::OffsetOfNode::Identifier:
-      ID.AddPointer(ON.getFieldName());
+      VisitName(ON.getFieldName());
       break;
         
     case OffsetOfExpr::OffsetOfNode::Base:
@@ -964,7 +970,7 @@ StmtProfiler::VisitCXXPseudoDestructorExpr(const CXXPseudoDestructorExpr *S) {
   if (S->getDestroyedTypeInfo())
     VisitType(S->getDestroyedType());
   else
-    ID.AddPointer(S->getDestroyedTypeIdentifier());
+    VisitName(S->getDestroyedTypeIdentifier());
 }
 
 void StmtProfiler::VisitOverloadExpr(const OverloadExpr *S) {
@@ -1221,30 +1227,64 @@ void StmtProfiler::VisitDecl(const Decl *D) {
     }
   }
 
+  if (ODR) {
+    if (const NamedDecl *ND = dyn_cast_or_null<NamedDecl>(D))
+      ID.AddString(ND->getQualifiedNameAsString());
+    return;
+  }
+
   ID.AddPointer(D? D->getCanonicalDecl() : 0);
 }
 
 void StmtProfiler::VisitType(QualType T) {
-  if (Canonical)
+  if (Canonical || ODR)
     T = Context.getCanonicalType(T);
 
+  if (ODR) {
+    ID.AddString(T.getAsString(Context.getPrintingPolicy()));
+    return;
+  }
+
   ID.AddPointer(T.getAsOpaquePtr());
 }
 
 void StmtProfiler::VisitName(DeclarationName Name) {
+  if (ODR) {
+    ID.AddString(Name.getAsString());
+    return;
+  }
+
   ID.AddPointer(Name.getAsOpaquePtr());
 }
 
 void StmtProfiler::VisitNestedNameSpecifier(NestedNameSpecifier *NNS) {
-  if (Canonical)
+  if (Canonical || ODR)
     NNS = Context.getCanonicalNestedNameSpecifier(NNS);
+
+  if (ODR) {
+    std::string Buffer;
+    llvm::raw_string_ostream OS(Buffer);
+    if (NNS)
+      NNS->print(OS, Context.getPrintingPolicy());
+    ID.AddString(OS.str());
+    return;
+  }
+
   ID.AddPointer(NNS);
 }
 
 void StmtProfiler::VisitTemplateName(TemplateName Name) {
-  if (Canonical)
+  if (Canonical || ODR)
     Name = Context.getCanonicalTemplateName(Name);
 
+  if (ODR) {
+    std::string Buffer;
+    llvm::raw_string_ostream OS(Buffer);
+    Name.print(OS, Context.getPrintingPolicy());
+    ID.AddString(OS.str());
+    return;
+  }
+
   Name.Profile(ID);
 }
 
@@ -1301,3 +1341,9 @@ void Stmt::Profile(llvm::FoldingSetNodeID &ID, const ASTContext &Context,
   StmtProfiler Profiler(ID, Context, Canonical);
   Profiler.Visit(this);
 }
+
+void Stmt::ProfileODR(llvm::FoldingSetNodeID &ID,
+                      const ASTContext &Context) const {
+  StmtProfiler Profiler(ID, Context, /*Canonical=*/false, /*ODR=*/true);
+  Profiler.Visit(this);
+}
@@ -537,6 +537,12 @@ void FileManager::PrintStats() const {
                << NumDirCacheMisses << " dir cache misses.\n";
   llvm::errs() << NumFileLookups << " file lookups, "
                << NumFileCacheMisses << " file cache misses.\n";
+  for (FileSystemStatCache *C = StatCache.get(); C; C = C->getNextStatCache())
+    if (DirectoryListingStatCache *Listings = C->getAsDirectoryListingCache())
+      llvm::errs() << Listings->getNumListingsRead()
+                   << " directory listings read, "
+                   << Listings->getNumMissesAvoided()
+                   << " misses answered from listings.\n";
 
   //llvm::errs() << PagesMapped << BytesOfPagesMapped << FSLookups;
 }
@@ -13,7 +13,11 @@
 
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
 
 // FIXME: This is terrible, we need this for ::close.
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -137,3 +141,140 @@ MemorizeStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+namespace {
+/// \brief The entries of a single directory, as last read from disk.
+struct DirectoryListing {
+  /// \brief Whether the listing can be used to answer lookups. This is false
+  /// if the directory has not been read yet, if reading it failed part way,
+  /// or if it was modified too recently for its timestamp to be trusted.
+  bool Complete;
+
+  /// \brief Whether the directory existed when it was read.
+  bool Exists;
+
+  /// \brief The modification time of the directory when it was read.
+  time_t ModTime;
+
+  /// \brief The names of the directory entries, lowercased so that a lookup
+  /// on a case-insensitive file system is never wrongly reported missing.
+  llvm::StringSet<> Entries;
+
+  DirectoryListing() : Complete(false), Exists(false), ModTime(0) {}
+};
+
+/// \brief The directory listings shared by all DirectoryListingStatCaches.
+struct SharedDirectoryListings {
+  llvm::sys::Mutex Lock;
+  llvm::StringMap<DirectoryListing> Listings;
+};
+}
+
+static llvm::ManagedStatic<SharedDirectoryListings> SharedListings;
+
+static void readDirectoryListing(StringRef Dir, const vfs::Status *Status,
+                                 DirectoryListing &Listing) {
+  Listing.Entries.clear();
+  Listing.Exists = Status != 0;
+  Listing.ModTime = Status ? Status->getLastModificationTime().toEpochTime()
+                           : 0;
+  Listing.Complete = true;
+  if (!Status)
+    return;
+
+  llvm::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(Dir, EC), E; I != E && !EC;
+       I.increment(EC))
+    Listing.Entries.insert(
+        StringRef(llvm::sys::path::filename(I->path())).lower());
+
+  // A directory modified within the last second may still change without
+  // its timestamp changing; read it again the next time it is validated.
+  time_t Now = llvm::sys::TimeValue::now().toEpochTime();
+  if (EC || Listing.ModTime >= Now - 1)
+    Listing.Complete = false;
+}
+
+void DirectoryListingStatCache::addDirectory(StringRef Dir) {
+  if (!llvm::sys::path::is_absolute(Dir))
+    return;
+  while (Dir.size() > 1 && llvm::sys::path::is_separator(Dir.back()))
+    Dir = Dir.drop_back();
+  Roots.push_back(Dir);
+}
+
+void DirectoryListingStatCache::reset() {
+  Roots.clear();
+  ValidatedDirs.clear();
+}
+
+bool DirectoryListingStatCache::isBelowRoot(StringRef Dir) const {
+  for (unsigned I = 0, N = Roots.size(); I != N; ++I) {
+    StringRef Root = Roots[I];
+    if (Dir.startswith(Root) &&
+        (Dir.size() == Root.size() ||
+         llvm::sys::path::is_separator(Dir[Root.size()])))
+      return true;
+  }
+  return false;
+}
+
+/// \brief Returns false if the listing of the directory containing \p Path
+/// proves that \p Path does not exist, true otherwise.
+bool DirectoryListingStatCache::mayExist(StringRef Path, vfs::FileSystem &FS) {
+  StringRef Dir = llvm::sys::path::parent_path(Path);
+  StringRef Name = llvm::sys::path::filename(Path);
+  if (Dir.empty() || Name.empty() || !isBelowRoot(Dir))
+    return true;
+
+  // Directory iteration never returns "." and "..", but they always exist in
+  // a directory that does.
+  if (Name == "." || Name == "..")
+    return true;
+
+  // If the directory is itself below a root, its parent's listing can tell
+  // us it is missing without stat'ing it.
+  if (std::find(Roots.begin(), Roots.end(), Dir) == Roots.end() &&
+      !mayExist(Dir, FS))
+    return false;
+
+  SharedDirectoryListings &Shared = *SharedListings;
+  llvm::MutexGuard Guard(Shared.Lock);
+  DirectoryListing &Listing = Shared.Listings[Dir];
+  if (ValidatedDirs.insert(Dir)) {
+    llvm::ErrorOr<vfs::Status> Status = FS.status(Dir);
+    bool Exists = Status && Status->isDirectory();
+    time_t ModTime =
+        Exists ? Status->getLastModificationTime().toEpochTime() : 0;
+    if (!Listing.Complete || Listing.Exists != Exists ||
+        Listing.ModTime != ModTime) {
+      readDirectoryListing(Dir, Exists ? &*Status : 0, Listing);
+      ++NumListingsRead;
+    }
+  }
+
+  if (!Listing.Complete)
+    return true;
+  return Listing.Exists && Listing.Entries.count(Name.lower());
+}
+
+void DirectoryListingStatCache::clearSharedListings() {
+  SharedDirectoryListings &Shared = *SharedListings;
+  llvm::MutexGuard Guard(Shared.Lock);
+  Shared.Listings.clear();
+}
+
+DirectoryListingStatCache::LookupResult
+DirectoryListingStatCache::getStat(const char *Path, FileData &Data,
+                                   bool isFile, vfs::File **F,
+                                   vfs::FileSystem &FS) {
+  // The listings describe the real file system; overlays and in-memory file
+  // systems have to be asked directly.
+  if (isFile && &FS == vfs::getRealFileSystem().getPtr() &&
+      !mayExist(Path, FS)) {
+    ++NumMissesAvoided;
+    return CacheMissing;
+  }
+
+  return statChained(Path, Data, isFile, F, FS);
+}
@@ -412,8 +412,10 @@ void SourceManager::clearIDTables() {
   LocalSLocEntryTable.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
-  LastLineNoFileIDQuery = FileID();
-  LastLineNoContentCache = 0;
+  for (unsigned I = 0; I != NumLineNoCacheEntries; ++I) {
+    LineNoCache[I].FID = FileID();
+    LineNoCache[I].Content = 0;
+  }
   LastFileIDLookup = FileID();
 
   if (LineTable)
@@ -1155,12 +1157,12 @@ unsigned SourceManager::getColumnNumber(FileID FID, unsigned FilePos,
 
   // See if we just calculated the line number for this FilePos and can use
   // that to lookup the start of the line instead of searching for it.
-  if (LastLineNoFileIDQuery == FID &&
-      LastLineNoContentCache->SourceLineCache != 0 &&
-      LastLineNoResult < LastLineNoContentCache->NumLines) {
-    unsigned *SourceLineCache = LastLineNoContentCache->SourceLineCache;
-    unsigned LineStart = SourceLineCache[LastLineNoResult - 1];
-    unsigned LineEnd = SourceLineCache[LastLineNoResult];
+  LineNoCacheEntry *Cached = lookupLineNoCache(FID);
+  if (Cached && Cached->Content->SourceLineCache != 0 &&
+      Cached->Result < Cached->Content->NumLines) {
+    unsigned *SourceLineCache = Cached->Content->SourceLineCache;
+    unsigned LineStart = SourceLineCache[Cached->Result - 1];
+    unsigned LineEnd = SourceLineCache[Cached->Result];
     if (FilePos >= LineStart && FilePos < LineEnd)
       return FilePos - LineStart + 1;
   }
@@ -1205,90 +1207,162 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
 #include <emmintrin.h>
 #endif
 
+/// \brief The minimum number of bytes scanned each time a line table is
+/// extended, so that walking forward through a file doesn't rescan it in
+/// tiny steps.  Most files are smaller than this and are scanned in one go.
+static const unsigned LineTableChunkSize = 64 * 1024;
+
+/// \brief Given a line break character at \p Pos, return the offset of the
+/// line that follows it.  \n\r and \r\n count as a single line break.
+static inline unsigned SkipLineBreak(const unsigned char *Buf, unsigned Pos,
+                                     unsigned BufSize) {
+  unsigned Next = Pos + 1;
+  if (Next < BufSize && (Buf[Next] == '\n' || Buf[Next] == '\r') &&
+      Buf[Next] != Buf[Pos])
+    ++Next;
+  return Next;
+}
+
+/// \brief Append the offsets of all *physical* lines that start after a line
+/// break in Buf[Offs, Limit) to \p LineOffsets.  This does not look at
+/// trigraphs, escaped newlines, or anything else tricky.
+///
+/// \returns the offset at which scanning stopped.  This is one past \p Limit
+/// if the last line break is a two character one.
+static unsigned ScanLineBreaks(const unsigned char *Buf, unsigned Offs,
+                               unsigned Limit, unsigned BufSize,
+                               SmallVectorImpl<unsigned> &LineOffsets) {
+  unsigned I = Offs;
+
+#ifdef __SSE2__
+  // Find the line breaks 16 bytes at a time.  This is very performance
+  // sensitive for programs with lots of diagnostics and in -E mode, so rather
+  // than restarting the scan for every line, consume every line break found
+  // in a chunk.
+  unsigned Chunk = Offs + ((16 - ((uintptr_t)(Buf + Offs) & 0xF)) & 0xF);
+  while (I < Chunk && I < Limit) {
+    if (Buf[I] == '\n' || Buf[I] == '\r') {
+      I = SkipLineBreak(Buf, I, BufSize);
+      LineOffsets.push_back(I);
+    } else
+      ++I;
+  }
+
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; Chunk + 16 <= Limit; Chunk += 16) {
+    const __m128i Bytes = *(const __m128i*)(Buf + Chunk);
+    unsigned Mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Bytes, CRs),
+                                                   _mm_cmpeq_epi8(Bytes, LFs)));
+    while (Mask) {
+      unsigned Pos = Chunk + llvm::countTrailingZeros(Mask);
+      Mask &= Mask - 1;
+      // Skip the second character of a two character line break.
+      if (Pos < I)
+        continue;
+      I = SkipLineBreak(Buf, Pos, BufSize);
+      LineOffsets.push_back(I);
+    }
+  }
+  // Unless the scan stopped before the first aligned chunk, everything up
+  // to Chunk has been looked at.
+  if (Chunk <= Limit)
+    I = std::max(I, Chunk);
+#endif
+
+  while (I < Limit) {
+    if (Buf[I] == '\n' || Buf[I] == '\r') {
+      I = SkipLineBreak(Buf, I, BufSize);
+      LineOffsets.push_back(I);
+    } else
+      ++I;
+  }
+  return std::max(I, Limit);
+}
+
+/// \brief Extend the line table of \p FI until it contains every line that
+/// starts at or before \p Offset and at least \p MinLines lines, or until the
+/// whole buffer has been scanned.
+///
+/// Only the part of a file that line information is requested for is
+/// scanned, which matters for huge generated files that get a diagnostic or
+/// two near the top.
 static LLVM_ATTRIBUTE_NOINLINE void
 ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                    llvm::BumpPtrAllocator &Alloc,
-                   const SourceManager &SM, bool &Invalid);
+                   const SourceManager &SM, bool &Invalid,
+                   unsigned Offset, unsigned MinLines);
 static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
                                llvm::BumpPtrAllocator &Alloc,
-                               const SourceManager &SM, bool &Invalid) {
+                               const SourceManager &SM, bool &Invalid,
+                               unsigned Offset, unsigned MinLines) {
   // Note that calling 'getBuffer()' may lazily page in the file.
   const MemoryBuffer *Buffer = FI->getBuffer(Diag, SM, SourceLocation(),
                                              &Invalid);
   if (Invalid)
     return;
 
-  // Find the file offsets of all of the *physical* source lines.  This does
-  // not look at trigraphs, escaped newlines, or anything else tricky.
-  SmallVector<unsigned, 256> LineOffsets;
-
-  // Line #1 starts at char 0.
-  LineOffsets.push_back(0);
-
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
+  unsigned BufSize = Buffer->getBufferSize();
 
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
+  SmallVector<unsigned, 256> LineOffsets;
+  if (FI->SourceLineCache == 0) {
+    // Line #1 starts at char 0.
+    LineOffsets.push_back(0);
+    FI->NumLines = 0;
+    FI->LineTableScanEnd = 0;
+  }
 
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
+  do {
+    unsigned ScanEnd = FI->LineTableScanEnd;
+    unsigned Limit = BufSize - ScanEnd > LineTableChunkSize
+                         ? ScanEnd + LineTableChunkSize : BufSize;
+    if (Offset > Limit)
+      Limit = std::min(Offset, BufSize);
+    FI->LineTableScanEnd = ScanLineBreaks(Buf, ScanEnd, Limit, BufSize,
+                                          LineOffsets);
+
+    // Copy the offsets into the FileInfo structure, growing the table if
+    // needed.  Size the new table for the whole file, assuming the rest of
+    // it has lines as long as the part scanned so far, so that a file that
+    // is scanned piecemeal is rarely reallocated more than once.
+    unsigned NumLines = FI->NumLines + LineOffsets.size();
+    if (NumLines > FI->LineTableCapacity) {
+      uint64_t Capacity = std::max(NumLines, 2 * FI->LineTableCapacity);
+      if (FI->LineTableScanEnd < BufSize)
+        Capacity = std::max(Capacity, (uint64_t)NumLines * BufSize /
+                                          (FI->LineTableScanEnd + 1) + 1);
+      Capacity = std::min(Capacity, (uint64_t)BufSize + 1);
+      unsigned *NewTable = Alloc.Allocate<unsigned>(Capacity);
+      std::copy(FI->SourceLineCache, FI->SourceLineCache + FI->NumLines,
+                NewTable);
+      FI->SourceLineCache = NewTable;
+      FI->LineTableCapacity = Capacity;
     }
-#endif
+    std::copy(LineOffsets.begin(), LineOffsets.end(),
+              FI->SourceLineCache + FI->NumLines);
+    FI->NumLines = NumLines;
+    LineOffsets.clear();
+  } while (FI->LineTableScanEnd < BufSize &&
+           (FI->LineTableScanEnd < Offset || FI->NumLines < MinLines));
+}
 
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
+SourceManager::LineNoCacheEntry *
+SourceManager::lookupLineNoCache(FileID FID) const {
+  if (FID.isInvalid())
+    return 0;
 
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1])
-        ++Offs, ++Buf;
-      ++Offs, ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs, ++Buf;
-    }
-  }
+  for (unsigned I = 0; I != NumLineNoCacheEntries; ++I) {
+    if (LineNoCache[I].FID != FID)
+      continue;
 
-  // Copy the offsets into the FileInfo structure.
-  FI->NumLines = LineOffsets.size();
-  FI->SourceLineCache = Alloc.Allocate<unsigned>(LineOffsets.size());
-  std::copy(LineOffsets.begin(), LineOffsets.end(), FI->SourceLineCache);
+    LineNoCacheEntry Entry = LineNoCache[I];
+    for (; I != 0; --I)
+      LineNoCache[I] = LineNoCache[I - 1];
+    LineNoCache[0] = Entry;
+    return &LineNoCache[0];
+  }
+  return 0;
 }
 
 /// getLineNumber - Given a SourceLocation, return the spelling line number
@@ -1304,8 +1378,9 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
   }
 
   ContentCache *Content;
-  if (LastLineNoFileIDQuery == FID)
-    Content = LastLineNoContentCache;
+  LineNoCacheEntry *Cached = lookupLineNoCache(FID);
+  if (Cached)
+    Content = Cached->Content;
   else {
     bool MyInvalid = false;
     const SLocEntry &Entry = getSLocEntry(FID, &MyInvalid);
@@ -1318,11 +1393,13 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
     Content = const_cast<ContentCache*>(Entry.getFile().getContentCache());
   }
   
-  // If this is the first use of line information for this buffer, compute the
-  /// SourceLineCache for it on demand.
-  if (Content->SourceLineCache == 0) {
+  // If this is the first use of line information for this buffer, or this
+  // position is past the part of the buffer scanned so far, compute the
+  // SourceLineCache for it on demand.
+  if (Content->SourceLineCache == 0 || Content->LineTableScanEnd < FilePos) {
     bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
+    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                       FilePos, 0);
     if (Invalid)
       *Invalid = MyInvalid;
     if (MyInvalid)
@@ -1348,13 +1425,13 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
   //
   // If someone gives me a test case where this matters, and I will do it! - DWD
 
-  // If the previous query was to the same file, we know both the file pos from
+  // If a recent query was to the same file, we know both the file pos from
   // that query and the line number returned.  This allows us to narrow the
   // search space from the entire file to something near the match.
-  if (LastLineNoFileIDQuery == FID) {
-    if (QueriedFilePos >= LastLineNoFilePos) {
+  if (Cached) {
+    if (QueriedFilePos >= Cached->FilePos) {
       // FIXME: Potential overflow?
-      SourceLineCache = SourceLineCache+LastLineNoResult-1;
+      SourceLineCache = SourceLineCache+Cached->Result-1;
 
       // The query is likely to be nearby the previous one.  Here we check to
       // see if it is within 5, 10 or 20 lines.  It can be far away in cases
@@ -1373,8 +1450,8 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
         }
       }
     } else {
-      if (LastLineNoResult < Content->NumLines)
-        SourceLineCacheEnd = SourceLineCache+LastLineNoResult+1;
+      if (Cached->Result < Content->NumLines)
+        SourceLineCacheEnd = SourceLineCache+Cached->Result+1;
     }
   }
 
@@ -1407,10 +1484,15 @@ unsigned SourceManager::getLineNumber(FileID FID, unsigned FilePos,
     = std::lower_bound(SourceLineCache, SourceLineCacheEnd, QueriedFilePos);
   unsigned LineNo = Pos-SourceLineCacheStart;
 
-  LastLineNoFileIDQuery = FID;
-  LastLineNoContentCache = Content;
-  LastLineNoFilePos = QueriedFilePos;
-  LastLineNoResult = LineNo;
+  if (!Cached) {
+    for (unsigned I = NumLineNoCacheEntries - 1; I != 0; --I)
+      LineNoCache[I] = LineNoCache[I - 1];
+    Cached = &LineNoCache[0];
+  }
+  Cached->FID = FID;
+  Cached->Content = Content;
+  Cached->FilePos = QueriedFilePos;
+  Cached->Result = LineNo;
   return LineNo;
 }
 
@@ -1779,11 +1861,13 @@ SourceLocation SourceManager::translateLineCol(FileID FID,
   if (!Content)
     return SourceLocation();
 
-  // If this is the first use of line information for this buffer, compute the
+  // If this is the first use of line information for this buffer, or the
+  // line is past the part of the buffer scanned so far, compute the
   // SourceLineCache for it on demand.
-  if (Content->SourceLineCache == 0) {
+  if (Content->SourceLineCache == 0 || Line > Content->NumLines) {
     bool MyInvalid = false;
-    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid);
+    ComputeLineNumbers(Diag, Content, ContentCacheAlloc, *this, MyInvalid,
+                       0, Line);
     if (MyInvalid)
       return SourceLocation();
   }
@@ -2155,15 +2239,18 @@ void SourceManager::PrintStats() const {
                << "B of Sloc address space used.\n";
   
   unsigned NumLineNumsComputed = 0;
+  unsigned NumLineBytesScanned = 0;
   unsigned NumFileBytesMapped = 0;
   for (fileinfo_iterator I = fileinfo_begin(), E = fileinfo_end(); I != E; ++I){
     NumLineNumsComputed += I->second->SourceLineCache != 0;
+    NumLineBytesScanned += I->second->LineTableScanEnd;
     NumFileBytesMapped  += I->second->getSizeBytesMapped();
   }
   unsigned NumMacroArgsComputed = MacroArgsCacheMap.size();
 
   llvm::errs() << NumFileBytesMapped << " bytes of files mapped, "
-               << NumLineNumsComputed << " files with line #'s computed, "
+               << NumLineNumsComputed << " files with line #'s computed ("
+               << NumLineBytesScanned << " bytes scanned), "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
                << NumBinaryProbes << " binary.\n";
@@ -0,0 +1,281 @@
+//===--- TimeTraceProfiler.cpp - Hierarchical frontend profiling ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the TimeTraceProfiler class, which records the events
+//  reported for -ftime-trace.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTraceProfiler.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/ThreadLocal.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+
+static llvm::ManagedStatic<llvm::sys::ThreadLocal<TimeTraceProfiler> >
+  CurrentProfiler;
+
+TimeTraceProfiler *TimeTraceProfiler::getCurrent() {
+  return CurrentProfiler->get();
+}
+
+void TimeTraceProfiler::setCurrent(TimeTraceProfiler *Profiler) {
+  if (Profiler)
+    CurrentProfiler->set(Profiler);
+  else
+    CurrentProfiler->erase();
+}
+
+TimeTraceProfiler::TimeTraceProfiler()
+  : StartTime(0), Granularity(0), MemoryCounter(0), MemoryCounterData(0) {
+  StartTime = now();
+}
+
+TimeTraceProfiler::~TimeTraceProfiler() {}
+
+uint64_t TimeTraceProfiler::now() const {
+  return llvm::sys::TimeValue::now().usec() - StartTime;
+}
+
+bool TimeTraceProfiler::isOpen(unsigned Index) const {
+  const SmallVectorImpl<unsigned> &Open = OpenEvents[Events[Index].EventTrack];
+  return std::find(Open.begin(), Open.end(), Index) != Open.end();
+}
+
+void TimeTraceProfiler::begin(StringRef Name, StringRef Detail, Track T) {
+  SmallVectorImpl<unsigned> &Open = OpenEvents[T];
+  Event E;
+  E.Name = EventNames.GetOrCreateValue(Name).getKey();
+  E.Detail = Detail;
+  E.Start = now();
+  E.Duration = 0;
+  E.ChildDuration = 0;
+  E.Bytes = allocatedBytes();
+  E.Parent = Open.empty() ? ~0U : Open.back();
+  E.EventTrack = T;
+  Open.push_back(Events.size());
+  Events.push_back(E);
+}
+
+void TimeTraceProfiler::end(Track T) {
+  assert(!OpenEvents[T].empty() && "no time trace event to end");
+  unsigned Index = OpenEvents[T].pop_back_val();
+  Event &E = Events[Index];
+  E.Duration = now() - E.Start;
+  E.Bytes = allocatedBytes() - E.Bytes;
+
+  // An event with no nested events left is the last one recorded. If it is
+  // too short to keep, its time stays part of its parent's own time.
+  if (E.Duration < Granularity && Index + 1 == Events.size()) {
+    Events.pop_back();
+    return;
+  }
+
+  if (E.Parent != ~0U)
+    Events[E.Parent].ChildDuration += E.Duration;
+}
+
+void TimeTraceProfiler::setDetail(StringRef Detail, Track T) {
+  assert(!OpenEvents[T].empty() && "no time trace event to annotate");
+  Events[OpenEvents[T].back()].Detail = Detail;
+}
+
+void TimeTraceProfiler::setLocation(StringRef Location, Track T) {
+  assert(!OpenEvents[T].empty() && "no time trace event to annotate");
+  Events[OpenEvents[T].back()].Location = Location;
+}
+
+std::string TimeTraceProfiler::getLocationString(SourceLocation Loc,
+                                                 const SourceManager &SM) {
+  if (Loc.isInvalid())
+    return std::string();
+  PresumedLoc PLoc = SM.getPresumedLoc(SM.getExpansionLoc(Loc));
+  if (PLoc.isInvalid())
+    return std::string();
+
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  OS << PLoc.getFilename() << ':' << PLoc.getLine() << ':' << PLoc.getColumn();
+  return OS.str();
+}
+
+void TimeTraceProfiler::setMemoryCounter(MemoryCounterFn Counter,
+                                         const void *Data) {
+  // Rebase the open events so that what they allocated under the old counter
+  // is kept.
+  int64_t Old = allocatedBytes();
+  MemoryCounter = Counter;
+  MemoryCounterData = Data;
+  int64_t Delta = allocatedBytes() - Old;
+  for (unsigned T = 0; T != NumTracks; ++T)
+    for (unsigned I = 0, N = OpenEvents[T].size(); I != N; ++I)
+      Events[OpenEvents[T][I]].Bytes += Delta;
+}
+
+/// \brief Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    unsigned char C = *I;
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) const {
+  OS << "{\"traceEvents\":[\n";
+  OS << "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\","
+        "\"args\":{\"name\":\"clang\"}},\n"
+        "{\"ph\":\"M\",\"pid\":1,\"tid\":" << unsigned(SourceTrack)
+     << ",\"name\":\"thread_name\",\"args\":{\"name\":\"Source\"}}";
+  for (unsigned I = 0, N = Events.size(); I != N; ++I) {
+    const Event &E = Events[I];
+    // Events that are still open have no duration yet.
+    if (isOpen(I))
+      continue;
+    OS << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << unsigned(E.EventTrack)
+       << ",\"ts\":" << E.Start
+       << ",\"dur\":" << E.Duration << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    OS << ",\"args\":{";
+    if (!E.Detail.empty()) {
+      OS << "\"detail\":";
+      writeJSONString(OS, E.Detail);
+      OS << ',';
+    }
+    if (!E.Location.empty()) {
+      OS << "\"location\":";
+      writeJSONString(OS, E.Location);
+      OS << ',';
+    }
+    OS << "\"bytes\":" << E.Bytes << "}}";
+  }
+  OS << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+namespace {
+/// \brief The summed cost of all events of one kind, or of all events of one
+/// kind applying to the same entity.
+struct EventTotals {
+  StringRef Name, Detail;
+  /// \brief The location of the first such event.
+  StringRef Location;
+  uint64_t Total, Self;
+  int64_t Bytes;
+  unsigned Count;
+
+  EventTotals() : Total(0), Self(0), Bytes(0), Count(0) {}
+
+  bool operator<(const EventTotals &RHS) const {
+    // Most expensive first.
+    if (Total != RHS.Total)
+      return Total > RHS.Total;
+    if (Name != RHS.Name)
+      return Name < RHS.Name;
+    return Detail < RHS.Detail;
+  }
+};
+}
+
+void TimeTraceProfiler::printSummary(raw_ostream &OS, unsigned N) const {
+  llvm::StringMap<EventTotals> ByName, ByEntity;
+  for (unsigned I = 0, NumEvents = Events.size(); I != NumEvents; ++I) {
+    const Event &E = Events[I];
+    if (isOpen(I))
+      continue;
+
+    // Don't count the time of a recursive event, such as a template whose
+    // instantiation instantiates itself with other arguments, twice.
+    bool NestedInSameKind = false, NestedInSameEntity = false;
+    for (unsigned P = E.Parent; P != ~0U; P = Events[P].Parent) {
+      if (Events[P].Name != E.Name)
+        continue;
+      NestedInSameKind = true;
+      if (Events[P].Detail == E.Detail) {
+        NestedInSameEntity = true;
+        break;
+      }
+    }
+
+    uint64_t Self = E.Duration - std::min(E.Duration, E.ChildDuration);
+
+    EventTotals &Kind = ByName[E.Name];
+    Kind.Name = E.Name;
+    if (!NestedInSameKind) {
+      Kind.Total += E.Duration;
+      Kind.Bytes += E.Bytes;
+    }
+    Kind.Self += Self;
+    ++Kind.Count;
+
+    std::string Key = E.Name;
+    Key += '\0';
+    Key += E.Detail;
+    EventTotals &Entity = ByEntity[Key];
+    Entity.Name = E.Name;
+    Entity.Detail = E.Detail;
+    if (Entity.Location.empty())
+      Entity.Location = E.Location;
+    if (!NestedInSameEntity) {
+      Entity.Total += E.Duration;
+      Entity.Bytes += E.Bytes;
+    }
+    Entity.Self += Self;
+    ++Entity.Count;
+  }
+
+  std::vector<EventTotals> Kinds, Entities;
+  for (llvm::StringMap<EventTotals>::const_iterator I = ByName.begin(),
+         E = ByName.end(); I != E; ++I)
+    Kinds.push_back(I->getValue());
+  for (llvm::StringMap<EventTotals>::const_iterator I = ByEntity.begin(),
+         E = ByEntity.end(); I != E; ++I)
+    Entities.push_back(I->getValue());
+  std::sort(Kinds.begin(), Kinds.end());
+  std::sort(Entities.begin(), Entities.end());
+  if (Entities.size() > N)
+    Entities.resize(N);
+
+  OS << "\n*** Time Trace Summary:\n";
+  OS << "   Total ms    Self ms     Count        Bytes  Event\n";
+  for (unsigned I = 0, E = Kinds.size(); I != E; ++I)
+    OS << llvm::format("%11.1f%11.1f%10u%13lld  ", Kinds[I].Total / 1000.0,
+                       Kinds[I].Self / 1000.0, Kinds[I].Count,
+                       (long long)Kinds[I].Bytes)
+       << Kinds[I].Name << '\n';
+
+  OS << "\n*** Top " << Entities.size() << " Events:\n";
+  OS << "   Total ms    Self ms     Count        Bytes  Event\n";
+  for (unsigned I = 0, E = Entities.size(); I != E; ++I) {
+    OS << llvm::format("%11.1f%11.1f%10u%13lld  ", Entities[I].Total / 1000.0,
+                       Entities[I].Self / 1000.0, Entities[I].Count,
+                       (long long)Entities[I].Bytes)
+       << Entities[I].Name;
+    if (!Entities[I].Detail.empty())
+      OS << ' ' << Entities[I].Detail;
+    if (!Entities[I].Location.empty())
+      OS << " (" << Entities[I].Location << ')';
+    OS << '\n';
+  }
+}
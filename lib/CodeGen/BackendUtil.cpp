@@ -11,6 +11,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
@@ -550,6 +551,7 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
 
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : 0);
+  TimeTraceScope TraceScope("Backend");
   llvm::formatted_raw_ostream FormattedOS;
 
   bool UsesCodeGen = (Action != Backend_EmitNothing &&
@@ -588,22 +590,29 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action, raw_ostream *OS) {
 
   if (PerFunctionPasses) {
     PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope PassesTraceScope("PerFunctionPasses");
 
     PerFunctionPasses->doInitialization();
     for (Module::iterator I = TheModule->begin(),
            E = TheModule->end(); I != E; ++I)
-      if (!I->isDeclaration())
+      if (!I->isDeclaration()) {
+        TimeTraceScope FunctionTraceScope("OptimizeFunction");
+        if (FunctionTraceScope.isActive())
+          FunctionTraceScope.setDetail(I->getName());
         PerFunctionPasses->run(*I);
+      }
     PerFunctionPasses->doFinalization();
   }
 
   if (PerModulePasses) {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope PassesTraceScope("PerModulePasses");
     PerModulePasses->run(*TheModule);
   }
 
   if (CodeGenPasses) {
     PrettyStackTraceString CrashInfo("Code generation");
+    TimeTraceScope PassesTraceScope("CodeGenPasses");
     CodeGenPasses->run(*TheModule);
   }
 }
@@ -37,6 +37,7 @@
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
@@ -1038,6 +1039,7 @@ void CodeGenModule::EmitDeferred() {
   // Emit code for any potentially referenced deferred decls.  Since a
   // previously unused static decl may become used during the generation of code
   // for a static function, iterate until no changes are made.
+  TimeTraceScope TraceScope("EmitDeferred");
 
   while (true) {
     if (!DeferredVTables.empty()) {
@@ -1068,6 +1070,14 @@ void CodeGenModule::EmitDeferred() {
       continue;
 
     // Otherwise, emit the definition and move on to the next one.
+    TimeTraceScope DeclTraceScope("EmitDeferredDecl");
+    if (DeclTraceScope.isActive()) {
+      const Decl *DeferredD = D.getDecl();
+      if (const NamedDecl *ND = dyn_cast<NamedDecl>(DeferredD))
+        DeclTraceScope.setDetail(ND->getQualifiedNameAsString());
+      DeclTraceScope.setLocation(DeferredD->getLocation(),
+                                 getContext().getSourceManager());
+    }
     EmitGlobalDefinition(D, GV);
   }
 }
@@ -2957,6 +2967,13 @@ void CodeGenModule::EmitTopLevelDecl(Decl *D) {
   if (D->getDeclContext() && D->getDeclContext()->isDependentContext())
     return;
 
+  TimeTraceScope TraceScope("EmitTopLevelDecl");
+  if (TraceScope.isActive()) {
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      TraceScope.setDetail(ND->getQualifiedNameAsString());
+    TraceScope.setLocation(D->getLocation(), getContext().getSourceManager());
+  }
+
   switch (D->getKind()) {
   case Decl::CXXConversion:
   case Decl::CXXMethod:
@@ -3162,6 +3162,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_summary_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fast_memory_report_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -3374,6 +3378,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddAllArgs(CmdArgs, options::OPT_fmodules_ignore_macro);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_interval);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_prune_after);
+  Args.AddLastArg(CmdArgs, options::OPT_fmodules_build_jobs_EQ);
 
   Args.AddLastArg(CmdArgs, options::OPT_fbuild_session_timestamp);
 
@@ -3385,6 +3390,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fmodules_validate_once_per_build_session);
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_search_dir_cache);
+  Args.AddLastArg(CmdArgs, options::OPT_finput_signature_file_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fvalidate_ast_inputs_once_per_process);
+
   // -faccess-control is default.
   if (Args.hasFlag(options::OPT_fno_access_control,
                    options::OPT_faccess_control,
@@ -14,6 +14,8 @@
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclLookups.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeOrdering.h"
@@ -28,6 +30,7 @@
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Sema/Sema.h"
@@ -227,7 +230,7 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
     CompletionCacheTopLevelHashValue(0),
     PreambleTopLevelHashValue(0),
     CurrentTopLevelHashValue(0),
-    UnsafeToFree(false) { 
+    UnsafeToFree(false), Frozen(false) { 
   if (getenv("LIBCLANG_OBJTRACKING")) {
     llvm::sys::AtomicIncrement(&ActiveASTUnitObjects);
     fprintf(stderr, "+++ %d translation units\n", (int)ActiveASTUnitObjects);
@@ -2105,6 +2108,7 @@ bool ASTUnit::Reparse(ArrayRef<RemappedFile> RemappedFiles) {
     return true;
 
   clearFileLevelDecls();
+  Frozen = false;
   
   SimpleTimer ParsingTimer(WantTiming);
   ParsingTimer.setOutput("Reparsing " + getMainFileName());
@@ -2152,6 +2156,143 @@ bool ASTUnit::Reparse(ArrayRef<RemappedFile> RemappedFiles) {
   return Result;
 }
 
+//----------------------------------------------------------------------------//
+// Freezing
+//----------------------------------------------------------------------------//
+
+namespace {
+  /// \brief Walks every declaration in an AST, computing the state that is
+  /// otherwise computed (and cached) the first time it is queried.
+  class ASTFreezer {
+    ASTContext &Ctx;
+    SmallVector<Decl *, 64> Worklist;
+    llvm::SmallPtrSet<Decl *, 64> Visited;
+
+    void freezeDecl(Decl *D);
+
+    template<typename TemplateDeclT>
+    void addSpecializations(TemplateDeclT *Template) {
+      for (typename TemplateDeclT::spec_iterator
+             I = Template->spec_begin(), E = Template->spec_end();
+           I != E; ++I)
+        add(*I);
+    }
+
+    template<typename TemplateDeclT>
+    void addPartialSpecializations(TemplateDeclT *Template) {
+      for (typename TemplateDeclT::partial_spec_iterator
+             I = Template->partial_spec_begin(),
+             E = Template->partial_spec_end();
+           I != E; ++I)
+        add(*I);
+    }
+
+  public:
+    explicit ASTFreezer(ASTContext &Ctx) : Ctx(Ctx) { }
+
+    void add(Decl *D) {
+      if (D && Visited.insert(D))
+        Worklist.push_back(D);
+    }
+
+    void freezeDecls() {
+      while (!Worklist.empty())
+        freezeDecl(Worklist.pop_back_val());
+    }
+
+    void freezeTypes();
+  };
+}
+
+void ASTFreezer::freezeDecl(Decl *D) {
+  // Linkage is computed on first use and cached in the declaration.
+  if (NamedDecl *ND = dyn_cast<NamedDecl>(D)) {
+    ND->getLinkageInternal();
+    ND->getVisibility();
+  }
+
+  if (FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    FD->getBody();
+    if (CXXConstructorDecl *Ctor = dyn_cast<CXXConstructorDecl>(FD))
+      Ctor->init_begin();
+  } else if (CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(D)) {
+    if (RD->isThisDeclarationADefinition()) {
+      RD->bases_begin();
+      RD->vbases_begin();
+      RD->friend_begin();
+      RD->getVisibleConversionFunctions();
+    }
+  } else if (ClassTemplateDecl *CTD = dyn_cast<ClassTemplateDecl>(D)) {
+    addSpecializations(CTD);
+    addPartialSpecializations(CTD);
+  } else if (FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D)) {
+    addSpecializations(FTD);
+  } else if (VarTemplateDecl *VTD = dyn_cast<VarTemplateDecl>(D)) {
+    addSpecializations(VTD);
+    addPartialSpecializations(VTD);
+  }
+
+  DeclContext *DC = dyn_cast<DeclContext>(D);
+  if (!DC)
+    return;
+
+  for (DeclContext::decl_iterator I = DC->decls_begin(), E = DC->decls_end();
+       I != E; ++I)
+    add(*I);
+
+  // Build the lookup table, loading any visible declarations from the AST
+  // files, so that lookup no longer goes to the external source.
+  DC->lookups_begin();
+  DC->setHasExternalLexicalStorage(false);
+}
+
+void ASTFreezer::freezeTypes() {
+  // Computing a layout can create new types, so iterate by index.
+  for (unsigned I = 0; I != unsigned(Ctx.types_end() - Ctx.types_begin());
+       ++I) {
+    const Type *T = Ctx.types_begin()[I];
+
+    // So are the linkage and other cached properties of every type.
+    T->getLinkage();
+
+    if (T->isDependentType() || T->isIncompleteType() ||
+        T->isUndeducedType() || T->isPlaceholderType())
+      continue;
+
+    // This computes the layout of the records and Objective-C classes too.
+    Ctx.getTypeInfo(T);
+  }
+}
+
+void ASTUnit::freeze() {
+  if (Frozen)
+    return;
+
+  SimpleTimer FreezeTimer(WantTiming);
+  FreezeTimer.setOutput("Freezing " + getMainFileName());
+
+  // Deserialize everything up front; the decl walk below then only has to
+  // resolve the lazy pointers within each declaration.
+  if (ExternalASTSource *Source = Ctx->getExternalSource())
+    Source->completeAllDeclarations();
+
+  if (!TopLevelDeclsInPreamble.empty())
+    RealizeTopLevelDeclsFromPreamble();
+
+  ASTFreezer Freezer(*Ctx);
+  Freezer.add(Ctx->getTranslationUnitDecl());
+  Freezer.freezeDecls();
+  Freezer.freezeTypes();
+
+  if (PreprocessingRecord *PPRec = PP->getPreprocessingRecord()) {
+    for (PreprocessingRecord::iterator I = PPRec->begin(), E = PPRec->end();
+         I != E; ++I)
+      (void)*I;
+  }
+
+  Frozen = true;
+}
+
 //----------------------------------------------------------------------------//
 // Code completion
 //----------------------------------------------------------------------------//
@@ -10,12 +10,15 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/ASTMemoryAccounting.h"
 #include "clang/AST/Decl.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Basic/Version.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Frontend/ChainedDiagnosticConsumer.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
@@ -32,21 +35,28 @@
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/LockFileManager.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 #include <sys/stat.h>
 #include <time.h>
 
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 using namespace clang;
 
 CompilerInstance::CompilerInstance()
@@ -290,6 +300,12 @@ void CompilerInstance::createPreprocessor() {
     AttachHeaderIncludeGen(*PP, /*ShowAllHeaders=*/false, /*OutputPath=*/"",
                            /*ShowDepth=*/true, /*MSStyle=*/true);
   }
+
+  if (TimeTraceProfiler *Profiler = TimeTraceProfiler::getCurrent())
+    AttachHeaderTimeTrace(*PP, *Profiler);
+
+  if (ASTMemoryAccounting *Accounting = ASTMemoryAccounting::getCurrent())
+    AttachHeaderMemoryAccounting(*PP, *Accounting);
 }
 
 // ASTContext
@@ -713,17 +729,71 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   if (getFrontendOpts().ShowStats)
     llvm::EnableStatistics();
 
+  OwningPtr<TimeTraceProfiler> Profiler;
+  if (!getFrontendOpts().TimeTracePath.empty() ||
+      getFrontendOpts().TimeTraceSummary) {
+    Profiler.reset(new TimeTraceProfiler());
+    Profiler->setGranularity(getFrontendOpts().TimeTraceGranularity);
+    TimeTraceProfiler::setCurrent(Profiler.get());
+  }
+
+  OwningPtr<ASTMemoryAccounting> MemoryAccounting;
+  if (!getFrontendOpts().ASTMemoryReportPath.empty()) {
+    MemoryAccounting.reset(new ASTMemoryAccounting());
+    ASTMemoryAccounting::setCurrent(MemoryAccounting.get());
+  }
+
   for (unsigned i = 0, e = getFrontendOpts().Inputs.size(); i != e; ++i) {
+    const FrontendInputFile &Input = getFrontendOpts().Inputs[i];
+    TimeTraceScope TraceScope("ExecuteAction",
+                              Input.isFile() ? Input.getFile() : "<buffer>");
+
     // Reset the ID tables if we are reusing the SourceManager.
     if (hasSourceManager())
       getSourceManager().clearIDTables();
 
-    if (Act.BeginSourceFile(*this, getFrontendOpts().Inputs[i])) {
+    if (Act.BeginSourceFile(*this, Input)) {
       Act.Execute();
       Act.EndSourceFile();
     }
   }
 
+  if (Profiler) {
+    TimeTraceProfiler::setCurrent(0);
+
+    StringRef Path = getFrontendOpts().TimeTracePath;
+    if (!Path.empty()) {
+      std::string Error;
+      llvm::raw_fd_ostream TraceOS(Path.str().c_str(), Error,
+                                   llvm::sys::fs::F_Text);
+      if (!Error.empty())
+        getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << Path << Error;
+      else
+        Profiler->write(TraceOS);
+    }
+    if (getFrontendOpts().TimeTraceSummary)
+      Profiler->printSummary(OS, getFrontendOpts().TimeTraceSummary);
+  }
+
+  if (MemoryAccounting) {
+    ASTMemoryAccounting::setCurrent(0);
+    // The AST may outlive the accounting; stop reporting to it.
+    if (hasASTContext() &&
+        getASTContext().getMemoryAccounting() == MemoryAccounting.get())
+      getASTContext().setMemoryAccounting(0);
+
+    StringRef Path = getFrontendOpts().ASTMemoryReportPath;
+    std::string Error;
+    llvm::raw_fd_ostream ReportOS(Path.str().c_str(), Error,
+                                  llvm::sys::fs::F_Text);
+    if (!Error.empty())
+      getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << Path << Error;
+    else
+      MemoryAccounting->write(ReportOS);
+  }
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
@@ -795,36 +865,34 @@ namespace {
   };
 }
 
-/// \brief Compile a module file for the given module, using the options 
-/// provided by the importing compiler instance.
-static void compileModule(CompilerInstance &ImportingInstance,
-                          SourceLocation ImportLoc,
-                          Module *Module,
-                          StringRef ModuleFileName) {
-  // FIXME: have LockFileManager return an error_code so that we can
-  // avoid the mkdir when the directory already exists.
-  StringRef Dir = llvm::sys::path::parent_path(ModuleFileName);
-  llvm::sys::fs::create_directories(Dir);
-
-  llvm::LockFileManager Locked(ModuleFileName);
-  switch (Locked) {
-  case llvm::LockFileManager::LFS_Error:
-    return;
-
-  case llvm::LockFileManager::LFS_Owned:
-    // We're responsible for building the module ourselves. Do so below.
-    break;
-
-  case llvm::LockFileManager::LFS_Shared:
-    // Someone else is responsible for building the module. Wait for them to
-    // finish.
-    Locked.waitForUnlock();
-    return;
-  }
+/// \brief Find the module map file that defines \p Module.
+///
+/// \returns the path of the module map file, or an empty string if the module
+/// map was inferred, in which case its text is stored in \p InferredModuleMap.
+static std::string getModuleMapToBuild(ModuleMap &ModMap, Module *Module,
+                                       std::string &InferredModuleMap) {
+  if (const FileEntry *File = ModMap.getContainingModuleMapFile(Module))
+    return File->getName();
+
+  llvm::raw_string_ostream OS(InferredModuleMap);
+  Module->print(OS);
+  OS.flush();
+  return std::string();
+}
 
-  ModuleMap &ModMap 
-    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
-    
+/// \brief Create the invocation that builds \p Module into \p ModuleFileName,
+/// using the options provided by the importing compiler instance.
+///
+/// \param ModuleMapPath The module map file to build the module from, or
+/// empty to build it from the inferred module map.
+///
+/// \param Isolated If true, the module is built ahead of time on a worker
+/// thread, so it gets a failed-module set of its own instead of sharing the
+/// importing instance's.
+static IntrusiveRefCntPtr<CompilerInvocation>
+createModuleInvocation(CompilerInstance &ImportingInstance, Module *Module,
+                       StringRef ModuleFileName, StringRef ModuleMapPath,
+                       bool Isolated) {
   // Construct a compiler invocation for creating this module.
   IntrusiveRefCntPtr<CompilerInvocation> Invocation
     (new CompilerInvocation(ImportingInstance.getInvocation()));
@@ -847,14 +915,21 @@ static void compileModule(CompilerInstance &ImportingInstance,
   // Note the name of the module we're building.
   Invocation->getLangOpts()->CurrentModule = Module->getTopLevelModuleName();
 
-  // Make sure that the failed-module structure has been allocated in
-  // the importing instance, and propagate the pointer to the newly-created
-  // instance.
-  PreprocessorOptions &ImportingPPOpts
-    = ImportingInstance.getInvocation().getPreprocessorOpts();
-  if (!ImportingPPOpts.FailedModules)
-    ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
-  PPOpts.FailedModules = ImportingPPOpts.FailedModules;
+  if (Isolated) {
+    // Concurrent builds can't share the failed-module set. Any module that
+    // fails here is rebuilt, with diagnostics, by the importing instance.
+    PPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
+    Invocation->getHeaderSearchOpts().ModuleBuildJobs = 1;
+  } else {
+    // Make sure that the failed-module structure has been allocated in
+    // the importing instance, and propagate the pointer to the
+    // newly-created instance.
+    PreprocessorOptions &ImportingPPOpts
+      = ImportingInstance.getInvocation().getPreprocessorOpts();
+    if (!ImportingPPOpts.FailedModules)
+      ImportingPPOpts.FailedModules = new PreprocessorOptions::FailedModulesSet;
+    PPOpts.FailedModules = ImportingPPOpts.FailedModules;
+  }
 
   // If there is a module map file, build the module using the module map.
   // Set up the inputs/outputs so that we build the module from its umbrella
@@ -863,55 +938,74 @@ static void compileModule(CompilerInstance &ImportingInstance,
   FrontendOpts.OutputFile = ModuleFileName.str();
   FrontendOpts.DisableFree = false;
   FrontendOpts.GenerateGlobalModuleIndex = false;
+  // The importing instance owns the profile and the memory report; a module
+  // build must not write over their files or print a summary of its own.
+  FrontendOpts.TimeTracePath.clear();
+  FrontendOpts.TimeTraceSummary = 0;
+  FrontendOpts.ASTMemoryReportPath.clear();
   FrontendOpts.Inputs.clear();
   InputKind IK = getSourceInputKindFromOptions(*Invocation->getLangOpts());
 
+  // Use the module map where this module resides, or the inferred one.
+  if (!ModuleMapPath.empty())
+    FrontendOpts.Inputs.push_back(FrontendInputFile(ModuleMapPath, IK));
+  else
+    FrontendOpts.Inputs.push_back(
+        FrontendInputFile("__inferred_module.map", IK));
+
   // Don't free the remapped file buffers; they are owned by our caller.
   PPOpts.RetainRemappedFileBuffers = true;
     
   Invocation->getDiagnosticOpts().VerifyDiagnostics = 0;
   assert(ImportingInstance.getInvocation().getModuleHash() ==
          Invocation->getModuleHash() && "Module hash mismatch!");
-  
-  // Construct a compiler instance that will be used to actually create the
-  // module.
-  CompilerInstance Instance;
-  Instance.setInvocation(&*Invocation);
+  return Invocation;
+}
 
-  Instance.createDiagnostics(new ForwardingDiagnosticConsumer(
-                                   ImportingInstance.getDiagnosticClient()),
-                             /*ShouldOwnClient=*/true);
+/// \brief Build \p Module into \p ModuleFileName with \p Instance, whose
+/// invocation, diagnostics and file manager have been set up by the caller.
+///
+/// \param BuildStack The module build stack of the importing instance, to
+/// which \p Module is added so that cycles in the module graph are detected.
+///
+/// \returns true if this call built the module, false if it was left to
+/// another process or the module file could not be locked.
+static bool buildModule(CompilerInstance &Instance, Module *Module,
+                        StringRef ModuleFileName, StringRef InferredModuleMap,
+                        ModuleBuildStack BuildStack, FullSourceLoc ImportLoc) {
+  // FIXME: have LockFileManager return an error_code so that we can
+  // avoid the mkdir when the directory already exists.
+  StringRef Dir = llvm::sys::path::parent_path(ModuleFileName);
+  llvm::sys::fs::create_directories(Dir);
 
-  Instance.setVirtualFileSystem(&ImportingInstance.getVirtualFileSystem());
+  llvm::LockFileManager Locked(ModuleFileName);
+  switch (Locked) {
+  case llvm::LockFileManager::LFS_Error:
+    return false;
+
+  case llvm::LockFileManager::LFS_Owned:
+    // We're responsible for building the module ourselves. Do so below.
+    break;
+
+  case llvm::LockFileManager::LFS_Shared:
+    // Someone else is responsible for building the module. Wait for them to
+    // finish.
+    Locked.waitForUnlock();
+    return false;
+  }
 
   // Note that this module is part of the module build stack, so that we
   // can detect cycles in the module graph.
-  Instance.setFileManager(&ImportingInstance.getFileManager());
   Instance.createSourceManager(Instance.getFileManager());
   SourceManager &SourceMgr = Instance.getSourceManager();
-  SourceMgr.setModuleBuildStack(
-    ImportingInstance.getSourceManager().getModuleBuildStack());
-  SourceMgr.pushModuleBuildStack(Module->getTopLevelModuleName(),
-    FullSourceLoc(ImportLoc, ImportingInstance.getSourceManager()));
-
-  // Get or create the module map that we'll use to build this module.
-  std::string InferredModuleMapContent;
-  if (const FileEntry *ModuleMapFile =
-          ModMap.getContainingModuleMapFile(Module)) {
-    // Use the module map where this module resides.
-    FrontendOpts.Inputs.push_back(
-        FrontendInputFile(ModuleMapFile->getName(), IK));
-  } else {
-    llvm::raw_string_ostream OS(InferredModuleMapContent);
-    Module->print(OS);
-    OS.flush();
-    FrontendOpts.Inputs.push_back(
-        FrontendInputFile("__inferred_module.map", IK));
+  SourceMgr.setModuleBuildStack(BuildStack);
+  SourceMgr.pushModuleBuildStack(Module->getTopLevelModuleName(), ImportLoc);
 
+  if (!InferredModuleMap.empty()) {
     const llvm::MemoryBuffer *ModuleMapBuffer =
-        llvm::MemoryBuffer::getMemBuffer(InferredModuleMapContent);
-    ModuleMapFile = Instance.getFileManager().getVirtualFile(
-        "__inferred_module.map", InferredModuleMapContent.size(), 0);
+        llvm::MemoryBuffer::getMemBuffer(InferredModuleMap);
+    const FileEntry *ModuleMapFile = Instance.getFileManager().getVirtualFile(
+        "__inferred_module.map", InferredModuleMap.size(), 0);
     SourceMgr.overrideFileContents(ModuleMapFile, ModuleMapBuffer);
   }
 
@@ -931,6 +1025,37 @@ static void compileModule(CompilerInstance &ImportingInstance,
   // be nice to do this with RemoveFileOnSignal when we can. However, that
   // doesn't make sense for all clients, so clean this up manually.
   Instance.clearOutputFiles(/*EraseFiles=*/true);
+  return true;
+}
+
+/// \brief Compile a module file for the given module, as it is imported.
+static void compileModule(CompilerInstance &ImportingInstance,
+                          SourceLocation ImportLoc,
+                          Module *Module,
+                          StringRef ModuleFileName) {
+  ModuleMap &ModMap 
+    = ImportingInstance.getPreprocessor().getHeaderSearchInfo().getModuleMap();
+  std::string InferredModuleMap;
+  std::string ModuleMapPath
+    = getModuleMapToBuild(ModMap, Module, InferredModuleMap);
+  IntrusiveRefCntPtr<CompilerInvocation> Invocation
+    = createModuleInvocation(ImportingInstance, Module, ModuleFileName,
+                             ModuleMapPath, /*Isolated=*/false);
+
+  // Construct a compiler instance that will be used to actually create the
+  // module.
+  CompilerInstance Instance;
+  Instance.setInvocation(&*Invocation);
+  Instance.createDiagnostics(new ForwardingDiagnosticConsumer(
+                                   ImportingInstance.getDiagnosticClient()),
+                             /*ShouldOwnClient=*/true);
+  Instance.setFileManager(&ImportingInstance.getFileManager());
+
+  SourceManager &ImportingSourceMgr = ImportingInstance.getSourceManager();
+  if (!buildModule(Instance, Module, ModuleFileName, InferredModuleMap,
+                   ImportingSourceMgr.getModuleBuildStack(),
+                   FullSourceLoc(ImportLoc, ImportingSourceMgr)))
+    return;
 
   // We've rebuilt a module. If we're allowed to generate or update the global
   // module index, record that fact in the importing compiler instance.
@@ -939,6 +1064,345 @@ static void compileModule(CompilerInstance &ImportingInstance,
   }
 }
 
+namespace {
+  /// \brief A module that will be built ahead of the module importing it,
+  /// on a worker thread.
+  ///
+  /// Everything the build needs is set up on the importing thread before the
+  /// workers start, so that a worker shares no reference-counted object with
+  /// the importing instance or with other workers: the invocation and the
+  /// file manager are its own, and so is the file system the file manager
+  /// reads through, which forwards to the importing instance's. The
+  /// importing thread keeps a reference to each of them until the workers
+  /// have finished, so that they're destroyed on that thread.
+  struct PrebuiltModule {
+    Module *Mod;
+    std::string ModuleFileName;
+
+    /// \brief The text of the inferred module map, or empty if the module
+    /// is built from its module map file.
+    std::string InferredModuleMap;
+
+    IntrusiveRefCntPtr<CompilerInvocation> Invocation;
+    IntrusiveRefCntPtr<FileManager> FileMgr;
+  };
+
+  /// \brief A set of modules that don't depend on each other and can
+  /// therefore be built concurrently.
+  struct ModuleBuildWave {
+    ArrayRef<PrebuiltModule> Modules;
+
+    /// \brief A copy of the importing instance's module build stack.
+    SmallVector<std::pair<std::string, FullSourceLoc>, 2> BuildStack;
+
+    llvm::sys::Mutex Lock;
+    unsigned NextModule;
+
+    ModuleBuildWave(ArrayRef<PrebuiltModule> Modules, ModuleBuildStack Stack)
+      : Modules(Modules), BuildStack(Stack.begin(), Stack.end()),
+        NextModule(0) { }
+  };
+}
+
+/// \brief Worker loop: build modules from the wave until none are left.
+static void *buildModulesInWave(void *UserData) {
+  ModuleBuildWave &Wave = *static_cast<ModuleBuildWave *>(UserData);
+  while (true) {
+    const PrebuiltModule *Next;
+    {
+      llvm::sys::ScopedLock L(Wave.Lock);
+      if (Wave.NextModule == Wave.Modules.size())
+        return 0;
+      Next = &Wave.Modules[Wave.NextModule++];
+    }
+
+    // Any module that fails to build here is rebuilt, with diagnostics, by
+    // the importing instance.
+    CompilerInstance Instance;
+    Instance.setInvocation(&*Next->Invocation);
+    Instance.createDiagnostics(new IgnoringDiagConsumer,
+                               /*ShouldOwnClient=*/true);
+    Instance.setFileManager(&*Next->FileMgr);
+    buildModule(Instance, Next->Mod, Next->ModuleFileName,
+                Next->InferredModuleMap, Wave.BuildStack, FullSourceLoc());
+  }
+}
+
+/// \brief Build every module in \p Wave, using up to \p Jobs threads
+/// including the calling one.
+static void runModuleBuildWave(ModuleBuildWave &Wave, unsigned Jobs) {
+#if HAVE_PTHREAD_H
+  SmallVector<pthread_t, 8> Threads;
+  for (unsigned I = 1; I < Jobs && I < Wave.Modules.size(); ++I) {
+    pthread_t Thread;
+    if (::pthread_create(&Thread, 0, &buildModulesInWave, &Wave) == 0)
+      Threads.push_back(Thread);
+  }
+  buildModulesInWave(&Wave);
+  for (unsigned I = 0, N = Threads.size(); I != N; ++I)
+    ::pthread_join(Threads[I], 0);
+#else
+  buildModulesInWave(&Wave);
+#endif
+}
+
+/// \brief Collect the top-level modules that \p Mod names in its module
+/// map through 'use' and 'export' declarations.
+static void getModuleMapDependencies(ModuleMap &ModMap, Module *Mod,
+                                     SmallVectorImpl<Module *> &Deps) {
+  ModMap.resolveUses(Mod, /*Complain=*/false);
+  ModMap.resolveExports(Mod, /*Complain=*/false);
+  for (unsigned I = 0, N = Mod->DirectUses.size(); I != N; ++I)
+    Deps.push_back(Mod->DirectUses[I]->getTopLevelModule());
+  for (unsigned I = 0, N = Mod->Exports.size(); I != N; ++I)
+    if (Module *Exported = Mod->Exports[I].getPointer())
+      Deps.push_back(Exported->getTopLevelModule());
+  for (Module::submodule_iterator Sub = Mod->submodule_begin(),
+                               SubEnd = Mod->submodule_end();
+       Sub != SubEnd; ++Sub)
+    getModuleMapDependencies(ModMap, *Sub, Deps);
+}
+
+/// \brief Collect the headers of \p Mod and its available submodules.
+static void getModuleHeaders(FileManager &FileMgr, Module *Mod,
+                             SmallVectorImpl<const FileEntry *> &Headers) {
+  if (!Mod->isAvailable())
+    return;
+
+  Headers.append(Mod->NormalHeaders.begin(), Mod->NormalHeaders.end());
+  Headers.append(Mod->PrivateHeaders.begin(), Mod->PrivateHeaders.end());
+  if (const FileEntry *UmbrellaHeader = Mod->getUmbrellaHeader()) {
+    Headers.push_back(UmbrellaHeader);
+  } else if (const DirectoryEntry *UmbrellaDir = Mod->getUmbrellaDir()) {
+    llvm::error_code EC;
+    SmallString<128> DirNative;
+    llvm::sys::path::native(UmbrellaDir->getName(), DirNative);
+    for (llvm::sys::fs::recursive_directory_iterator Dir(DirNative.str(), EC),
+                                                     DirEnd;
+         Dir != DirEnd && !EC; Dir.increment(EC)) {
+      if (!llvm::StringSwitch<bool>(llvm::sys::path::extension(Dir->path()))
+          .Cases(".h", ".H", ".hh", ".hpp", true)
+          .Default(false))
+        continue;
+      if (const FileEntry *Header = FileMgr.getFile(Dir->path()))
+        Headers.push_back(Header);
+    }
+  }
+
+  for (Module::submodule_iterator Sub = Mod->submodule_begin(),
+                               SubEnd = Mod->submodule_end();
+       Sub != SubEnd; ++Sub)
+    getModuleHeaders(FileMgr, *Sub, Headers);
+}
+
+/// \brief Collect the top-level modules whose headers \p Header includes or
+/// imports, following the inclusions of headers that belong to no module.
+///
+/// The header is scanned for directives line by line without preprocessing
+/// it, so conditional inclusions are all taken and a dependency may be found
+/// that the build doesn't have; that only costs concurrency. \#include_next
+/// is not followed.
+static void getIncludedModules(HeaderSearch &HS, const FileEntry *Header,
+                               llvm::SmallPtrSet<const FileEntry *, 16> &Seen,
+                               SmallVectorImpl<Module *> &Deps) {
+  if (!Seen.insert(Header))
+    return;
+
+  OwningPtr<llvm::MemoryBuffer> Buffer(
+      HS.getFileMgr().getBufferForFile(Header));
+  if (!Buffer)
+    return;
+
+  StringRef Text = Buffer->getBuffer();
+  while (!Text.empty()) {
+    StringRef Line;
+    llvm::tie(Line, Text) = Text.split('\n');
+    Line = Line.ltrim();
+
+    // '@import Foo.Bar;'
+    StringRef Import("@import");
+    if (Line.startswith(Import)) {
+      StringRef Name = Line.substr(Import.size()).ltrim();
+      Name = Name.substr(0, Name.find_first_of(" \t.;"));
+      if (!Name.empty())
+        if (Module *Imported = HS.lookupModule(Name))
+          Deps.push_back(Imported);
+      continue;
+    }
+
+    // '#include "foo.h"', '#import <Foo/Foo.h>'
+    if (!Line.startswith("#"))
+      continue;
+    Line = Line.substr(1).ltrim();
+    StringRef Directive = Line.substr(0, Line.find_first_of(" \t<\""));
+    if (Directive != "include" && Directive != "import")
+      continue;
+    Line = Line.substr(Directive.size()).ltrim();
+    bool IsAngled = Line.startswith("<");
+    if (!IsAngled && !Line.startswith("\""))
+      continue;
+    size_t End = Line.find(IsAngled ? '>' : '"', 1);
+    if (End == StringRef::npos)
+      continue;
+    StringRef Filename = Line.slice(1, End);
+
+    const DirectoryLookup *CurDir;
+    ModuleMap::KnownHeader SuggestedModule;
+    const FileEntry *File = HS.LookupFile(Filename, SourceLocation(), IsAngled,
+                                          /*FromDir=*/0, CurDir, Header,
+                                          /*SearchPath=*/0,
+                                          /*RelativePath=*/0,
+                                          &SuggestedModule);
+    if (!File)
+      continue;
+    if (Module *Owner = SuggestedModule.getModule())
+      Deps.push_back(Owner->getTopLevelModule());
+    else
+      getIncludedModules(HS, File, Seen, Deps);
+  }
+}
+
+/// \brief Collect the top-level modules that \p Mod depends on: those that
+/// its module map names, and those whose headers its headers include.
+static void getModuleDependencies(HeaderSearch &HS, Module *Mod,
+                                  SmallVectorImpl<Module *> &Deps) {
+  getModuleMapDependencies(HS.getModuleMap(), Mod, Deps);
+
+  SmallVector<const FileEntry *, 16> Headers;
+  getModuleHeaders(HS.getFileMgr(), Mod, Headers);
+  llvm::SmallPtrSet<const FileEntry *, 16> Seen;
+  for (unsigned I = 0, N = Headers.size(); I != N; ++I)
+    getIncludedModules(HS, Headers[I], Seen, Deps);
+}
+
+namespace {
+  /// \brief Orders the dependencies of a module into waves of modules that
+  /// can be built concurrently.
+  class ModuleDependencyScheduler {
+    /// \brief The wave in which each visited module can be built. Zero
+    /// means the module doesn't need to wait for anything we build.
+    llvm::DenseMap<Module *, unsigned> Wave;
+
+    /// \brief Modules that are part of a cycle; they're left to the
+    /// importing instance, which diagnoses the cycle.
+    llvm::SmallPtrSet<Module *, 4> Cyclic;
+
+    /// \brief The modules on the current DFS path.
+    SmallVector<Module *, 8> Stack;
+
+  public:
+    /// \brief The modules without a module file, in dependency order.
+    SmallVector<Module *, 16> ToBuild;
+
+    /// \brief Visit \p Mod and return the wave after which modules that
+    /// depend on it can be built.
+    unsigned visit(Module *Mod, HeaderSearch &HS, bool Root);
+
+    unsigned getWave(Module *Mod) const { return Wave.lookup(Mod); }
+    bool isCyclic(Module *Mod) const { return Cyclic.count(Mod); }
+  };
+}
+
+unsigned ModuleDependencyScheduler::visit(Module *Mod, HeaderSearch &HS,
+                                          bool Root) {
+  llvm::DenseMap<Module *, unsigned>::iterator Known = Wave.find(Mod);
+  if (Known != Wave.end())
+    return Known->second;
+
+  SmallVectorImpl<Module *>::iterator OnStack
+    = std::find(Stack.begin(), Stack.end(), Mod);
+  if (OnStack != Stack.end()) {
+    Cyclic.insert(OnStack, Stack.end());
+    return 0;
+  }
+
+  Stack.push_back(Mod);
+  SmallVector<Module *, 4> Deps;
+  getModuleDependencies(HS, Mod, Deps);
+  unsigned After = 0;
+  for (unsigned I = 0, N = Deps.size(); I != N; ++I)
+    if (Deps[I] != Mod)
+      After = std::max(After, visit(Deps[I], HS, /*Root=*/false));
+  Stack.pop_back();
+
+  // Only look at whether the module file exists; an out-of-date module file
+  // is detected and rebuilt when the module is imported.
+  unsigned Result = After;
+  if (!Root && !Cyclic.count(Mod) &&
+      !llvm::sys::fs::exists(HS.getModuleFileName(Mod))) {
+    ToBuild.push_back(Mod);
+    Result = After + 1;
+  }
+  Wave[Mod] = Result;
+  return Result;
+}
+
+/// \brief Build the dependencies of \p Mod that have no module file yet,
+/// running independent builds concurrently.
+static void prebuildModuleDependencies(CompilerInstance &ImportingInstance,
+                                       Module *Mod) {
+  // The -print-stats counters are process-wide and not thread-safe.
+  unsigned Jobs = ImportingInstance.getHeaderSearchOpts().ModuleBuildJobs;
+  if (Jobs < 2 || ImportingInstance.getFrontendOpts().ShowStats ||
+      !llvm::llvm_start_multithreaded())
+    return;
+
+  HeaderSearch &HS = ImportingInstance.getPreprocessor().getHeaderSearchInfo();
+  ModuleDependencyScheduler Scheduler;
+  Scheduler.visit(Mod, HS, /*Root=*/true);
+  if (Scheduler.ToBuild.empty())
+    return;
+
+  // Don't rebuild anything that failed before, or that is already being
+  // built further up the stack.
+  const PreprocessorOptions &PPOpts = ImportingInstance.getPreprocessorOpts();
+  const ModuleBuildStack &BuildStack
+    = ImportingInstance.getSourceManager().getModuleBuildStack();
+  SmallVector<SmallVector<PrebuiltModule, 4>, 4> Waves;
+  for (unsigned I = 0, N = Scheduler.ToBuild.size(); I != N; ++I) {
+    Module *Dep = Scheduler.ToBuild[I];
+    StringRef Name = Dep->Name;
+    if (PPOpts.FailedModules && PPOpts.FailedModules->hasAlreadyFailed(Name))
+      continue;
+    bool Building = false;
+    for (unsigned J = 0, M = BuildStack.size(); J != M && !Building; ++J)
+      Building = BuildStack[J].first == Name;
+    if (Building)
+      continue;
+
+    unsigned W = Scheduler.getWave(Dep) - 1;
+    if (W >= Waves.size())
+      Waves.resize(W + 1);
+    Waves[W].push_back(PrebuiltModule());
+    PrebuiltModule &Prebuilt = Waves[W].back();
+    Prebuilt.Mod = Dep;
+    Prebuilt.ModuleFileName = HS.getModuleFileName(Dep);
+    std::string ModuleMapPath = getModuleMapToBuild(HS.getModuleMap(), Dep,
+                                                    Prebuilt.InferredModuleMap);
+    Prebuilt.Invocation = createModuleInvocation(ImportingInstance, Dep,
+                                                 Prebuilt.ModuleFileName,
+                                                 ModuleMapPath,
+                                                 /*Isolated=*/true);
+    IntrusiveRefCntPtr<vfs::FileSystem> FS(
+        new vfs::OverlayFileSystem(&ImportingInstance.getVirtualFileSystem()));
+    Prebuilt.FileMgr = new FileManager(Prebuilt.Invocation->getFileSystemOpts(),
+                                       FS);
+  }
+
+  // Each wave only depends on modules built in earlier waves.
+  bool BuiltAny = false;
+  for (unsigned W = 0, N = Waves.size(); W != N; ++W) {
+    if (Waves[W].empty())
+      continue;
+    ModuleBuildWave Wave(Waves[W], BuildStack);
+    runModuleBuildWave(Wave, Jobs);
+    BuiltAny = true;
+  }
+
+  if (BuiltAny && ImportingInstance.getFrontendOpts().GenerateGlobalModuleIndex)
+    ImportingInstance.setBuildGlobalModuleIndex(true);
+}
+
 /// \brief Diagnose differences between the current definition of the given
 /// configuration macro and the definition provided on the command line.
 static void checkConfigMacro(Preprocessor &PP, StringRef ConfigMacro,
@@ -1233,6 +1697,10 @@ CompilerInstance::loadModule(SourceLocation ImportLoc,
         return ModuleLoadResult();
       }
 
+      // Build the dependencies named in the module map first, so that
+      // independent ones can be built in parallel.
+      prebuildModuleDependencies(*this, Module);
+
       // Try to compile the module.
       compileModule(*this, ModuleNameLoc, Module, ModuleFileName);
 
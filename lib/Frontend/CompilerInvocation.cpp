@@ -523,7 +523,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
 }
 
 static void ParseDependencyOutputArgs(DependencyOutputOptions &Opts,
-                                      ArgList &Args) {
+                                      ArgList &Args,
+                                      DiagnosticsEngine &Diags) {
   using namespace options;
   Opts.OutputFile = Args.getLastArgValue(OPT_dependency_file);
   Opts.Targets = Args.getAllArgValues(OPT_MT);
@@ -534,6 +535,16 @@ static void ParseDependencyOutputArgs(DependencyOutputOptions &Opts,
   Opts.AddMissingHeaderDeps = Args.hasArg(OPT_MG);
   Opts.PrintShowIncludes = Args.hasArg(OPT_show_includes);
   Opts.DOTOutputFile = Args.getLastArgValue(OPT_dependency_dot);
+  if (Arg *A = Args.getLastArg(OPT_dependency_format_EQ)) {
+    StringRef Value = A->getValue();
+    if (Value == "make")
+      Opts.OutputFormat = DOF_Make;
+    else if (Value == "json")
+      Opts.OutputFormat = DOF_JSON;
+    else
+      Diags.Report(diag::err_drv_invalid_value)
+        << A->getAsString(Args) << Value;
+  }
 }
 
 bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
@@ -720,6 +731,8 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.ProgramAction = frontend::MigrateSource; break;
     case OPT_Eonly:
       Opts.ProgramAction = frontend::RunPreprocessorOnly; break;
+    case OPT_dependency_scan:
+      Opts.ProgramAction = frontend::RunDependencyScan; break;
     }
   }
 
@@ -760,6 +773,12 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
+  Opts.TimeTracePath = Args.getLastArgValue(OPT_ftime_trace_EQ);
+  Opts.TimeTraceSummary =
+      getLastArgIntValue(Args, OPT_ftime_trace_summary_EQ, 0, Diags);
+  Opts.TimeTraceGranularity =
+      getLastArgIntValue(Args, OPT_ftime_trace_granularity_EQ, 0, Diags);
+  Opts.ASTMemoryReportPath = Args.getLastArgValue(OPT_fast_memory_report_EQ);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
@@ -929,6 +948,12 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
       Args.hasArg(OPT_fmodules_validate_once_per_build_session);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
+  Opts.ModuleBuildJobs =
+      std::max(getLastArgIntValue(Args, OPT_fmodules_build_jobs_EQ, 1), 1);
+  Opts.UseDirectoryListingCache = Args.hasArg(OPT_fheader_search_dir_cache);
+  Opts.InputSignatureFile = Args.getLastArgValue(OPT_finput_signature_file_EQ);
+  Opts.ValidateASTInputsOncePerProcess =
+      Args.hasArg(OPT_fvalidate_ast_inputs_once_per_process);
   for (arg_iterator it = Args.filtered_begin(OPT_fmodules_ignore_macro),
                     ie = Args.filtered_end();
        it != ie; ++it) {
@@ -1363,8 +1388,11 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_depth, 512, Diags);
   Opts.ConstexprStepLimit =
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
+  Opts.ConstexprCallCache = !Args.hasArg(OPT_fno_constexpr_call_cache);
+  Opts.ConstexprBytecode = Args.hasArg(OPT_fexperimental_constexpr_bytecode);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.PCHInstantiateTemplates = Args.hasArg(OPT_fpch_instantiate_templates);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -1629,6 +1657,7 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   case frontend::RewriteTest:
   case frontend::RunAnalysis:
   case frontend::MigrateSource:
+  case frontend::RunDependencyScan:
     Opts.ShowCPP = 0;
     break;
 
@@ -1694,7 +1723,7 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
 
   Success = ParseAnalyzerArgs(*Res.getAnalyzerOpts(), *Args, Diags) && Success;
   Success = ParseMigratorArgs(Res.getMigratorOpts(), *Args) && Success;
-  ParseDependencyOutputArgs(Res.getDependencyOutputOpts(), *Args);
+  ParseDependencyOutputArgs(Res.getDependencyOutputOpts(), *Args, Diags);
   Success = ParseDiagnosticArgs(Res.getDiagnosticOpts(), *Args, &Diags)
             && Success;
   ParseCommentArgs(Res.getLangOpts()->CommentOpts, *Args);
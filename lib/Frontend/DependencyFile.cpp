@@ -22,6 +22,7 @@
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -33,7 +34,9 @@ class DependencyFileCallback : public PPCallbacks {
   llvm::StringSet<> FilesSet;
   const Preprocessor *PP;
   std::string OutputFile;
+  raw_ostream *OutputStream;
   std::vector<std::string> Targets;
+  DependencyOutputFormat OutputFormat;
   bool IncludeSystemHeaders;
   bool PhonyTarget;
   bool AddMissingHeaderDeps;
@@ -43,11 +46,15 @@ private:
                               SrcMgr::CharacteristicKind FileType);
   void AddFilename(StringRef Filename);
   void OutputDependencyFile();
+  void PrintMakeRule(raw_ostream &OS);
+  void PrintJSON(raw_ostream &OS);
 
 public:
   DependencyFileCallback(const Preprocessor *_PP,
-                         const DependencyOutputOptions &Opts)
-    : PP(_PP), OutputFile(Opts.OutputFile), Targets(Opts.Targets),
+                         const DependencyOutputOptions &Opts,
+                         raw_ostream *OS)
+    : PP(_PP), OutputFile(Opts.OutputFile), OutputStream(OS),
+      Targets(Opts.Targets), OutputFormat(Opts.OutputFormat),
       IncludeSystemHeaders(Opts.IncludeSystemHeaders),
       PhonyTarget(Opts.UsePhonyTargets),
       AddMissingHeaderDeps(Opts.AddMissingHeaderDeps),
@@ -72,8 +79,9 @@ public:
 };
 }
 
-void clang::AttachDependencyFileGen(Preprocessor &PP,
-                                    const DependencyOutputOptions &Opts) {
+static void AttachDependencyFileCallback(Preprocessor &PP,
+                                         const DependencyOutputOptions &Opts,
+                                         raw_ostream *OS) {
   if (Opts.Targets.empty()) {
     PP.getDiagnostics().Report(diag::err_fe_dependency_file_requires_MT);
     return;
@@ -83,7 +91,18 @@ void clang::AttachDependencyFileGen(Preprocessor &PP,
   if (Opts.AddMissingHeaderDeps)
     PP.SetSuppressIncludeNotFoundError(true);
 
-  PP.addPPCallbacks(new DependencyFileCallback(&PP, Opts));
+  PP.addPPCallbacks(new DependencyFileCallback(&PP, Opts, OS));
+}
+
+void clang::AttachDependencyFileGen(Preprocessor &PP,
+                                    const DependencyOutputOptions &Opts) {
+  AttachDependencyFileCallback(PP, Opts, 0);
+}
+
+void clang::AttachDependencyFileGen(Preprocessor &PP,
+                                    const DependencyOutputOptions &Opts,
+                                    raw_ostream &OS) {
+  AttachDependencyFileCallback(PP, Opts, &OS);
 }
 
 /// FileMatchesDepCriteria - Determine whether the given Filename should be
@@ -164,9 +183,33 @@ static void PrintFilename(raw_ostream &OS, StringRef Filename) {
   }
 }
 
+/// PrintJSONString - Print the given string as a JSON string literal.
+static void PrintJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned i = 0, e = Str.size(); i != e; ++i) {
+    unsigned char C = Str[i];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
 void DependencyFileCallback::OutputDependencyFile() {
   if (SeenMissingHeader) {
-    llvm::sys::fs::remove(OutputFile);
+    if (!OutputStream)
+      llvm::sys::fs::remove(OutputFile);
+    return;
+  }
+
+  if (OutputStream) {
+    if (OutputFormat == DOF_JSON)
+      PrintJSON(*OutputStream);
+    else
+      PrintMakeRule(*OutputStream);
     return;
   }
 
@@ -178,6 +221,28 @@ void DependencyFileCallback::OutputDependencyFile() {
     return;
   }
 
+  if (OutputFormat == DOF_JSON)
+    PrintJSON(OS);
+  else
+    PrintMakeRule(OS);
+}
+
+void DependencyFileCallback::PrintJSON(raw_ostream &OS) {
+  OS << "{\n  \"targets\": [";
+  for (unsigned i = 0, e = Targets.size(); i != e; ++i) {
+    if (i)
+      OS << ", ";
+    PrintJSONString(OS, Targets[i]);
+  }
+  OS << "],\n  \"dependencies\": [";
+  for (unsigned i = 0, e = Files.size(); i != e; ++i) {
+    OS << (i ? ",\n    " : "\n    ");
+    PrintJSONString(OS, Files[i]);
+  }
+  OS << "\n  ]\n}\n";
+}
+
+void DependencyFileCallback::PrintMakeRule(raw_ostream &OS) {
   // Write out the dependency targets, trying to avoid overly long
   // lines when possible. We try our best to emit exactly the same
   // dependency file as GCC (4.2), assuming the included files are the
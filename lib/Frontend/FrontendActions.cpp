@@ -525,6 +525,23 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+void DependencyScanAction::ExecuteAction() {
+  Preprocessor &PP = getCompilerInstance().getPreprocessor();
+
+  // Ignore unknown pragmas.
+  PP.AddPragmaHandler(new EmptyPragmaHandler());
+
+  // Only directives can change the set of included files, so don't spend any
+  // time expanding macros in the text between them.
+  PP.SetMacroExpansionOnlyInDirectives();
+
+  Token Tok;
+  PP.EnterMainSourceFile();
+  do {
+    PP.LexUnexpandedToken(Tok);
+  } while (Tok.isNot(tok::eof));
+}
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
@@ -0,0 +1,74 @@
+//===--- HeaderMemoryAccounting.cpp - AST memory of each header -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTMemoryAccounting.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+using namespace clang;
+
+namespace {
+class HeaderMemoryAccountingCallback : public PPCallbacks {
+  SourceManager &SM;
+  ASTMemoryAccounting &Accounting;
+
+  /// \brief The files we have entered and not yet left.
+  SmallVector<FileID, 8> OpenFiles;
+
+public:
+  HeaderMemoryAccountingCallback(const Preprocessor &PP,
+                                 ASTMemoryAccounting &Accounting)
+    : SM(PP.getSourceManager()), Accounting(Accounting) {}
+
+  ~HeaderMemoryAccountingCallback() {
+    // The main file is never left, and lexing stops early after a fatal
+    // error; leave what we entered.
+    for (unsigned I = 0, N = OpenFiles.size(); I != N; ++I)
+      Accounting.exitFile();
+  }
+
+  virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                           SrcMgr::CharacteristicKind FileType,
+                           FileID PrevFID);
+};
+}
+
+void clang::AttachHeaderMemoryAccounting(Preprocessor &PP,
+                                         ASTMemoryAccounting &Accounting) {
+  PP.addPPCallbacks(new HeaderMemoryAccountingCallback(PP, Accounting));
+}
+
+void HeaderMemoryAccountingCallback::FileChanged(
+    SourceLocation Loc, FileChangeReason Reason,
+    SrcMgr::CharacteristicKind FileType, FileID PrevFID) {
+  if (Reason == PPCallbacks::ExitFile) {
+    if (!OpenFiles.empty() && OpenFiles.back() == PrevFID) {
+      OpenFiles.pop_back();
+      Accounting.exitFile();
+    }
+    return;
+  }
+  if (Reason != PPCallbacks::EnterFile)
+    return;
+
+  // Unlike -ftime-trace, account for the main file and the predefines buffer
+  // too, so that the report covers the whole translation unit.
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  StringRef Name;
+  if (const FileEntry *File = SM.getFileEntryForID(FID))
+    Name = File->getName();
+  else
+    Name = SM.getBuffer(FID)->getBufferIdentifier();
+
+  OpenFiles.push_back(FID);
+  Accounting.enterFile(Name);
+}
@@ -0,0 +1,76 @@
+//===--- HeaderTimeTrace.cpp - Time headers for -ftime-trace --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTraceProfiler.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallVector.h"
+using namespace clang;
+
+namespace {
+class HeaderTimeTraceCallback : public PPCallbacks {
+  SourceManager &SM;
+  TimeTraceProfiler &Profiler;
+
+  /// \brief The files we have opened an event for and not yet left.
+  SmallVector<FileID, 8> OpenFiles;
+
+public:
+  HeaderTimeTraceCallback(const Preprocessor &PP, TimeTraceProfiler &Profiler)
+    : SM(PP.getSourceManager()), Profiler(Profiler) {}
+
+  ~HeaderTimeTraceCallback() {
+    // Lexing stops early after a fatal error; close what we opened.
+    for (unsigned I = 0, N = OpenFiles.size(); I != N; ++I)
+      Profiler.end(TimeTraceProfiler::SourceTrack);
+  }
+
+  virtual void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                           SrcMgr::CharacteristicKind FileType,
+                           FileID PrevFID);
+};
+}
+
+void clang::AttachHeaderTimeTrace(Preprocessor &PP,
+                                  TimeTraceProfiler &Profiler) {
+  PP.addPPCallbacks(new HeaderTimeTraceCallback(PP, Profiler));
+}
+
+void HeaderTimeTraceCallback::FileChanged(SourceLocation Loc,
+                                          FileChangeReason Reason,
+                                          SrcMgr::CharacteristicKind FileType,
+                                          FileID PrevFID) {
+  if (Reason == PPCallbacks::ExitFile) {
+    if (!OpenFiles.empty() && OpenFiles.back() == PrevFID) {
+      OpenFiles.pop_back();
+      Profiler.end(TimeTraceProfiler::SourceTrack);
+    }
+    return;
+  }
+  if (Reason != PPCallbacks::EnterFile)
+    return;
+
+  // The main file is never left, and the predefines buffer isn't a header.
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  if (FID == SM.getMainFileID())
+    return;
+  const FileEntry *File = SM.getFileEntryForID(FID);
+  if (!File)
+    return;
+
+  OpenFiles.push_back(FID);
+  // A file can start or end in the middle of a declaration, so these events
+  // don't nest with the others; record them on their own track.
+  Profiler.begin("Source", File->getName(), TimeTraceProfiler::SourceTrack);
+  Profiler.setLocation(
+      TimeTraceProfiler::getLocationString(SM.getIncludeLoc(FID), SM),
+      TimeTraceProfiler::SourceTrack);
+}
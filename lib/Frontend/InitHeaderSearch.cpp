@@ -13,6 +13,7 @@
 
 #include "clang/Frontend/Utils.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Config/config.h" // C_INCLUDE_DIRS
 #include "clang/Lex/HeaderSearch.h"
@@ -727,4 +728,31 @@ void clang::ApplyHeaderSearchOptions(HeaderSearch &HS,
   }
 
   Init.Realize(Lang);
+
+  if (HSOpts.UseDirectoryListingCache) {
+    // Let the file manager answer misses in the search directories from their
+    // listings. Header maps are looked up in memory already. A file manager
+    // that is reused, e.g. when an ASTUnit is reparsed, keeps its cache.
+    FileManager &FileMgr = HS.getFileMgr();
+    DirectoryListingStatCache *Cache = 0;
+    for (FileSystemStatCache *C = FileMgr.getStatCache(); C && !Cache;
+         C = C->getNextStatCache())
+      Cache = C->getAsDirectoryListingCache();
+    bool IsNew = !Cache;
+    if (IsNew)
+      Cache = new DirectoryListingStatCache();
+    else
+      Cache->reset();
+
+    for (HeaderSearch::search_dir_iterator I = HS.search_dir_begin(),
+                                           E = HS.search_dir_end();
+         I != E; ++I) {
+      if (I->isNormalDir())
+        Cache->addDirectory(I->getDir()->getName());
+      else if (I->isFramework())
+        Cache->addDirectory(I->getFrameworkDir()->getName());
+    }
+    if (IsNew)
+      FileMgr.addStatCache(Cache);
+  }
 }
@@ -585,11 +585,11 @@ struct UnknownPragmaHandler : public PragmaHandler {
     Callbacks->MoveToLine(PragmaTok.getLocation());
     Callbacks->OS.write(Prefix, strlen(Prefix));
     // Read and print all of the pragma tokens.
+    SmallString<128> SpellingBuffer;
     while (PragmaTok.isNot(tok::eod)) {
       if (PragmaTok.hasLeadingSpace())
         Callbacks->OS << ' ';
-      std::string TokSpell = PP.getSpelling(PragmaTok);
-      Callbacks->OS.write(&TokSpell[0], TokSpell.size());
+      Callbacks->OS << PP.getSpelling(PragmaTok, SpellingBuffer);
 
       // Expand macros in pragmas with -fms-extensions.  The assumption is that
       // the majority of pragmas in such a file will be Microsoft pragmas.
@@ -611,6 +611,7 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                       !PP.getCommentRetentionState();
 
   char Buffer[256];
+  SmallString<512> LongSpelling;
   Token PrevPrevTok, PrevTok;
   PrevPrevTok.startToken();
   PrevTok.startToken();
@@ -660,13 +661,15 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
       if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
         Callbacks->HandleNewlinesInToken(TokPtr, Len);
     } else {
-      std::string S = PP.getSpelling(Tok);
-      OS.write(&S[0], S.size());
+      // Reuse one buffer for long tokens (typically block comments) instead of
+      // allocating a string for each of them.
+      StringRef S = PP.getSpelling(Tok, LongSpelling);
+      OS << S;
 
       // Tokens that can contain embedded newlines need to adjust our current
       // line number.
       if (Tok.getKind() == tok::comment || Tok.getKind() == tok::unknown)
-        Callbacks->HandleNewlinesInToken(&S[0], S.size());
+        Callbacks->HandleNewlinesInToken(S.data(), S.size());
     }
     Callbacks->setEmittedTokensOnThisLine();
 
@@ -728,6 +731,14 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
   // to -C or -CC.
   PP.SetCommentRetentionState(Opts.ShowComments, Opts.ShowMacroComments);
 
+  // The printer writes one token at a time, and the output stream may have a
+  // small buffer (or none at all, when writing to a terminal). Give it a large
+  // one so that the output reaches the file in big chunks.
+  const size_t OutputBufferSize = 256 * 1024;
+  size_t OldBufferSize = OS->GetBufferSize();
+  if (OldBufferSize < OutputBufferSize)
+    OS->SetBufferSize(OutputBufferSize);
+
   PrintPPOutputPPCallbacks *Callbacks =
       new PrintPPOutputPPCallbacks(PP, *OS, !Opts.ShowLineMarkers,
                                    Opts.ShowMacros);
@@ -762,4 +773,12 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
   // Read all the preprocessed tokens, printing them out to the stream.
   PrintPreprocessedTokens(PP, Tok, Callbacks, *OS);
   *OS << '\n';
+
+  // Give the stream its own buffer back.
+  if (OldBufferSize < OutputBufferSize) {
+    if (OldBufferSize)
+      OS->SetBufferSize(OldBufferSize);
+    else
+      OS->SetUnbuffered();
+  }
 }
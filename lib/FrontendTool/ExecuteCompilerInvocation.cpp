@@ -117,6 +117,7 @@ static FrontendAction *CreateFrontendBaseAction(CompilerInstance &CI) {
 #else
   case RunAnalysis:            Action = "RunAnalysis"; break;
 #endif
+  case RunDependencyScan:      return new DependencyScanAction();
   case RunPreprocessorOnly:    return new PreprocessOnlyAction();
   }
 
@@ -12,6 +12,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -815,3 +816,19 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   UG.Visit(D);
   return UG.ignoreResults();
 }
+
+USRHash clang::index::hashUSR(StringRef USR) {
+  llvm::MD5 Hasher;
+  Hasher.update(USR);
+  llvm::MD5::MD5Result Digest;
+  Hasher.final(Digest);
+
+  // Read the digest as two little-endian words so the value doesn't depend on
+  // the host.
+  USRHash Hash = { 0, 0 };
+  for (unsigned I = 0; I != 8; ++I) {
+    Hash.Low |= uint64_t(Digest[I]) << (8 * I);
+    Hash.High |= uint64_t(Digest[8 + I]) << (8 * I);
+  }
+  return Hash;
+}
@@ -17,9 +17,14 @@
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/DataTypes.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
+#include <functional>
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -29,6 +34,7 @@ using namespace clang;
 enum {
   HMAP_HeaderMagicNumber = ('h' << 24) | ('m' << 16) | ('a' << 8) | 'p',
   HMAP_HeaderVersion = 1,
+  HMAP_PerfectHashVersion = 2,
 
   HMAP_EmptyBucketKey = 0
 };
@@ -50,6 +56,8 @@ struct HMapHeader {
   uint32_t NumBuckets;      // Number of buckets (always a power of 2).
   uint32_t MaxValueLength;  // Length of longest result path (excluding nul).
   // An array of 'NumBuckets' HMapBucket objects follows this header.
+  // In version 2, an array of getNumHMapGroups(NumBuckets) uint32_t
+  // displacements follows the buckets.
   // Strings follow the buckets, at StringsOffset.
 };
 } // end namespace clang.
@@ -66,6 +74,29 @@ static inline unsigned HashHMapKey(StringRef Str) {
   return Result;
 }
 
+/// HashHMapKeyWithSeed - The hash function used by version 2 header maps.  A
+/// key is first hashed with seed 0 to select its group, then with the group's
+/// displacement to select its bucket.  Like HashHMapKey, it is
+/// case-insensitive.
+static inline uint32_t HashHMapKeyWithSeed(StringRef Str, uint32_t Seed) {
+  uint32_t Result = 2166136261u ^ (Seed * 0x9E3779B9u);
+  for (const char *S = Str.begin(), *End = Str.end(); S != End; ++S) {
+    Result ^= (unsigned char)toLowercase(*S);
+    Result *= 16777619u;
+  }
+  Result ^= Result >> 16;
+  Result *= 0x85EBCA6Bu;
+  Result ^= Result >> 13;
+  Result *= 0xC2B2AE35u;
+  Result ^= Result >> 16;
+  return Result;
+}
+
+/// getNumHMapGroups - The number of entries in the displacement table of a
+/// version 2 header map with the given (power of two) number of buckets.
+static inline unsigned getNumHMapGroups(unsigned NumBuckets) {
+  return NumBuckets >= 4 ? NumBuckets / 4 : 1;
+}
 
 
 //===----------------------------------------------------------------------===//
@@ -81,8 +112,14 @@ const HeaderMap *HeaderMap::Create(const FileEntry *FE, FileManager &FM) {
   unsigned FileSize = FE->getSize();
   if (FileSize <= sizeof(HMapHeader)) return 0;
 
-  OwningPtr<const llvm::MemoryBuffer> FileBuffer(FM.getBufferForFile(FE));
-  if (!FileBuffer) return 0;  // Unreadable file?
+  const llvm::MemoryBuffer *Buffer = FM.getBufferForFile(FE);
+  if (!Buffer) return 0;  // Unreadable file?
+  return Create(Buffer);
+}
+
+const HeaderMap *HeaderMap::Create(const llvm::MemoryBuffer *Buffer) {
+  OwningPtr<const llvm::MemoryBuffer> FileBuffer(Buffer);
+  if (FileBuffer->getBufferSize() <= sizeof(HMapHeader)) return 0;
   const char *FileStart = FileBuffer->getBufferStart();
 
   // We know the file is at least as big as the header, check it now.
@@ -91,19 +128,24 @@ const HeaderMap *HeaderMap::Create(const FileEntry *FE, FileManager &FM) {
   // Sniff it to see if it's a headermap by checking the magic number and
   // version.
   bool NeedsByteSwap;
-  if (Header->Magic == HMAP_HeaderMagicNumber &&
-      Header->Version == HMAP_HeaderVersion)
+  uint16_t Version;
+  if (Header->Magic == HMAP_HeaderMagicNumber) {
     NeedsByteSwap = false;
-  else if (Header->Magic == llvm::ByteSwap_32(HMAP_HeaderMagicNumber) &&
-           Header->Version == llvm::ByteSwap_16(HMAP_HeaderVersion))
+    Version = Header->Version;
+  } else if (Header->Magic == llvm::ByteSwap_32(HMAP_HeaderMagicNumber)) {
     NeedsByteSwap = true;  // Mixed endianness headermap.
-  else
+    Version = llvm::ByteSwap_16(Header->Version);
+  } else
     return 0;  // Not a header map.
 
+  if (Version != HMAP_HeaderVersion && Version != HMAP_PerfectHashVersion)
+    return 0;
+
   if (Header->Reserved != 0) return 0;
 
   // Okay, everything looks good, create the header map.
-  return new HeaderMap(FileBuffer.take(), NeedsByteSwap);
+  return new HeaderMap(FileBuffer.take(), NeedsByteSwap,
+                       Version == HMAP_PerfectHashVersion);
 }
 
 HeaderMap::~HeaderMap() {
@@ -157,6 +199,23 @@ HMapBucket HeaderMap::getBucket(unsigned BucketNo) const {
   return Result;
 }
 
+/// getDisplacement - Return the displacement of the specified group of a
+/// version 2 header map.  If the group number is not valid, this returns 0,
+/// which makes the lookup miss.
+unsigned HeaderMap::getDisplacement(unsigned GroupNo) const {
+  unsigned NumBuckets = getEndianAdjustedWord(getHeader().NumBuckets);
+  const uint32_t *DisplacementArray =
+    reinterpret_cast<const uint32_t*>(FileBuffer->getBufferStart() +
+                                      sizeof(HMapHeader) +
+                                      NumBuckets * sizeof(HMapBucket));
+
+  const uint32_t *DisplacementPtr = DisplacementArray+GroupNo;
+  if ((const char*)(DisplacementPtr+1) > FileBuffer->getBufferEnd())
+    return 0;  // Invalid buffer, corrupt hmap.
+
+  return getEndianAdjustedWord(*DisplacementPtr);
+}
+
 /// getString - Look up the specified string in the string table.  If the string
 /// index is not valid, it returns an empty string.
 const char *HeaderMap::getString(unsigned StrTabIdx) const {
@@ -220,6 +279,28 @@ StringRef HeaderMap::lookupFilename(StringRef Filename,
   if (NumBuckets & (NumBuckets-1))
     return StringRef();
 
+  if (IsPerfectHash) {
+    // The displacement of the key's group selects the only bucket the key can
+    // occupy.
+    unsigned NumGroups = getNumHMapGroups(NumBuckets);
+    unsigned Group = HashHMapKeyWithSeed(Filename, 0) & (NumGroups-1);
+    unsigned Displacement = getDisplacement(Group);
+    if (Displacement == 0) return StringRef(); // Empty group.
+
+    HMapBucket B = getBucket(HashHMapKeyWithSeed(Filename, Displacement) &
+                             (NumBuckets-1));
+    if (B.Key == HMAP_EmptyBucketKey) return StringRef(); // Hash miss.
+    const char *Key = getString(B.Key);
+    if (!Key || !Filename.equals_lower(Key)) return StringRef();
+
+    StringRef Prefix = getString(B.Prefix);
+    StringRef Suffix = getString(B.Suffix);
+    DestPath.clear();
+    DestPath.append(Prefix.begin(), Prefix.end());
+    DestPath.append(Suffix.begin(), Suffix.end());
+    return StringRef(DestPath.begin(), DestPath.size());
+  }
+
   // Linearly probe the hash table.
   for (unsigned Bucket = HashHMapKey(Filename);; ++Bucket) {
     HMapBucket B = getBucket(Bucket & (NumBuckets-1));
@@ -239,3 +320,190 @@ StringRef HeaderMap::lookupFilename(StringRef Filename,
     return StringRef(DestPath.begin(), DestPath.size());
   }
 }
+
+//===----------------------------------------------------------------------===//
+// Header Map Construction
+//===----------------------------------------------------------------------===//
+
+bool HeaderMapBuilder::addMapping(StringRef Key, StringRef Prefix,
+                                  StringRef Suffix) {
+  assert(!Key.empty() && "Header map keys cannot be empty");
+  std::string LowerKey = Key.lower();
+  if (KeyIndex.count(LowerKey))
+    return false;
+  KeyIndex[LowerKey] = Entries.size();
+
+  Entry E;
+  E.Key = Key;
+  E.Prefix = Prefix;
+  E.Suffix = Suffix;
+  Entries.push_back(E);
+  return true;
+}
+
+llvm::error_code HeaderMapBuilder::addDirectory(StringRef Dir) {
+  llvm::error_code EC;
+  for (llvm::sys::fs::recursive_directory_iterator Entry(Dir, EC), End;
+       Entry != End && !EC; Entry.increment(EC)) {
+    llvm::sys::fs::file_status Status;
+    if (Entry->status(Status) || !llvm::sys::fs::is_regular_file(Status))
+      continue;
+
+    // The key is the path relative to Dir, spelled as it would be in an
+    // #include directive.
+    StringRef Path = Entry->path();
+    StringRef Relative = Path.substr(Dir.size());
+    while (!Relative.empty() && llvm::sys::path::is_separator(Relative[0]))
+      Relative = Relative.substr(1);
+    std::string Key = Relative;
+    std::replace(Key.begin(), Key.end(), '\\', '/');
+
+    StringRef Filename = llvm::sys::path::filename(Path);
+    addMapping(Key, Path.drop_back(Filename.size()), Filename);
+  }
+  return EC;
+}
+
+namespace {
+/// \brief Uniques the strings of a header map as they are added to its
+/// string pool.
+class HMapStringPool {
+  llvm::StringMap<unsigned> Offsets;
+  SmallString<4096> Data;
+
+public:
+  HMapStringPool() {
+    // Offset 0 is reserved to mark empty buckets.
+    Data.push_back('\0');
+  }
+
+  unsigned add(StringRef Str) {
+    llvm::StringMap<unsigned>::iterator Known = Offsets.find(Str);
+    if (Known != Offsets.end())
+      return Known->second;
+
+    unsigned Offset = Data.size();
+    Offsets[Str] = Offset;
+    Data.append(Str.begin(), Str.end());
+    Data.push_back('\0');
+    return Offset;
+  }
+
+  StringRef str() const { return Data.str(); }
+};
+}
+
+/// \brief Try to place every key in its own bucket by finding, for each group
+/// of keys, a displacement that sends all of them to free buckets.
+///
+/// \returns true on success, false if some group could not be placed, in
+/// which case the caller should retry with more buckets.
+static bool buildPerfectHash(ArrayRef<StringRef> Keys, unsigned NumBuckets,
+                             std::vector<unsigned> &Slots,
+                             std::vector<uint32_t> &Displacements) {
+  const unsigned MaxDisplacement = 1 << 16;
+  unsigned NumGroups = getNumHMapGroups(NumBuckets);
+
+  std::vector<std::vector<unsigned> > Groups(NumGroups);
+  for (unsigned I = 0, N = Keys.size(); I != N; ++I)
+    Groups[HashHMapKeyWithSeed(Keys[I], 0) & (NumGroups-1)].push_back(I);
+
+  // Place the largest groups first, while there are many free buckets.
+  std::vector<std::pair<unsigned, unsigned> > Order;
+  for (unsigned G = 0; G != NumGroups; ++G)
+    if (!Groups[G].empty())
+      Order.push_back(std::make_pair(Groups[G].size(), G));
+  std::sort(Order.begin(), Order.end(),
+            std::greater<std::pair<unsigned, unsigned> >());
+
+  Slots.assign(NumBuckets, ~0U);
+  Displacements.assign(NumGroups, 0);
+  SmallVector<unsigned, 8> Chosen;
+  for (unsigned I = 0, N = Order.size(); I != N; ++I) {
+    const std::vector<unsigned> &Group = Groups[Order[I].second];
+    uint32_t D = 1;
+    for (; D != MaxDisplacement; ++D) {
+      Chosen.clear();
+      for (unsigned K = 0, KE = Group.size(); K != KE; ++K) {
+        unsigned B = HashHMapKeyWithSeed(Keys[Group[K]], D) & (NumBuckets-1);
+        if (Slots[B] != ~0U ||
+            std::find(Chosen.begin(), Chosen.end(), B) != Chosen.end())
+          break;
+        Chosen.push_back(B);
+      }
+      if (Chosen.size() == Group.size())
+        break;
+    }
+    if (D == MaxDisplacement)
+      return false;
+
+    for (unsigned K = 0, KE = Group.size(); K != KE; ++K)
+      Slots[Chosen[K]] = Group[K];
+    Displacements[Order[I].second] = D;
+  }
+  return true;
+}
+
+void HeaderMapBuilder::write(llvm::raw_ostream &OS, FormatKind Format) const {
+  unsigned NumEntries = Entries.size();
+  SmallVector<StringRef, 64> Keys;
+  for (unsigned I = 0; I != NumEntries; ++I)
+    Keys.push_back(Entries[I].Key);
+
+  // Assign every entry a bucket. The classic format keeps the table at most
+  // half full so that linear probing always finds an empty bucket.
+  unsigned NumBuckets;
+  std::vector<unsigned> Slots;
+  std::vector<uint32_t> Displacements;
+  if (Format == PerfectHash) {
+    NumBuckets = llvm::NextPowerOf2(NumEntries);
+    while (!buildPerfectHash(Keys, NumBuckets, Slots, Displacements))
+      NumBuckets *= 2;
+  } else {
+    NumBuckets = llvm::NextPowerOf2(NumEntries * 2);
+    Slots.assign(NumBuckets, ~0U);
+    for (unsigned I = 0; I != NumEntries; ++I) {
+      unsigned B = HashHMapKey(Keys[I]);
+      while (Slots[B & (NumBuckets-1)] != ~0U)
+        ++B;
+      Slots[B & (NumBuckets-1)] = I;
+    }
+  }
+
+  HMapStringPool Strings;
+  std::vector<HMapBucket> Buckets(NumBuckets);
+  unsigned MaxValueLength = 0;
+  for (unsigned B = 0; B != NumBuckets; ++B) {
+    if (Slots[B] == ~0U) {
+      Buckets[B].Key = HMAP_EmptyBucketKey;
+      Buckets[B].Prefix = 0;
+      Buckets[B].Suffix = 0;
+      continue;
+    }
+    const Entry &E = Entries[Slots[B]];
+    Buckets[B].Key = Strings.add(E.Key);
+    Buckets[B].Prefix = Strings.add(E.Prefix);
+    Buckets[B].Suffix = Strings.add(E.Suffix);
+    MaxValueLength = std::max<unsigned>(MaxValueLength,
+                                        E.Prefix.size() + E.Suffix.size());
+  }
+
+  HMapHeader Header;
+  Header.Magic = HMAP_HeaderMagicNumber;
+  Header.Version = Format == PerfectHash ? HMAP_PerfectHashVersion
+                                         : HMAP_HeaderVersion;
+  Header.Reserved = 0;
+  Header.StringsOffset = sizeof(HMapHeader) + NumBuckets * sizeof(HMapBucket) +
+                         Displacements.size() * sizeof(uint32_t);
+  Header.NumEntries = NumEntries;
+  Header.NumBuckets = NumBuckets;
+  Header.MaxValueLength = MaxValueLength;
+
+  OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  OS.write(reinterpret_cast<const char *>(&Buckets[0]),
+           NumBuckets * sizeof(HMapBucket));
+  if (!Displacements.empty())
+    OS.write(reinterpret_cast<const char *>(&Displacements[0]),
+             Displacements.size() * sizeof(uint32_t));
+  OS << Strings.str();
+}
@@ -16,6 +16,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/ParsedTemplate.h"
@@ -557,11 +558,22 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
     break;
   }
 
+  TimeTraceScope TraceScope("ParseTopLevelDecl");
+  if (TraceScope.isActive())
+    TraceScope.setLocation(Tok.getLocation(), PP.getSourceManager());
+
   ParsedAttributesWithRange attrs(AttrFactory);
   MaybeParseCXX11Attributes(attrs);
   MaybeParseMicrosoftAttributes(attrs);
 
   Result = ParseExternalDeclaration(attrs);
+
+  if (TraceScope.isActive() && Result) {
+    DeclGroupRef DG = Result.get();
+    if (!DG.isNull())
+      if (NamedDecl *ND = dyn_cast<NamedDecl>(*DG.begin()))
+        TraceScope.setDetail(ND->getQualifiedNameAsString());
+  }
   return false;
 }
 
@@ -81,6 +81,15 @@ CXXBaseSpecifier *MultiplexExternalSemaSource::GetExternalCXXBaseSpecifiers(
   return 0; 
 }
 
+CXXCtorInitializer **
+MultiplexExternalSemaSource::GetExternalCXXCtorInitializers(uint64_t Offset) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    if (CXXCtorInitializer **R =
+            Sources[i]->GetExternalCXXCtorInitializers(Offset))
+      return R;
+  return 0;
+}
+
 bool MultiplexExternalSemaSource::
 FindExternalVisibleDeclsByName(const DeclContext *DC, DeclarationName Name) {
   bool AnyDeclsFound = false;
@@ -94,6 +103,11 @@ void MultiplexExternalSemaSource::completeVisibleDeclsMap(const DeclContext *DC)
     Sources[i]->completeVisibleDeclsMap(DC);
 }
 
+void MultiplexExternalSemaSource::completeAllDeclarations() {
+  for(size_t i = 0; i < Sources.size(); ++i)
+    Sources[i]->completeAllDeclarations();
+}
+
 ExternalLoadResult MultiplexExternalSemaSource::
 FindExternalLexicalDecls(const DeclContext *DC,
                          bool (*isKindWeWant)(Decl::Kind),
@@ -16,6 +16,7 @@
 #include "clang/Sema/SemaCLI.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
+#include "clang/AST/ASTMemoryAccounting.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclFriend.h"
 #include "clang/AST/DeclObjC.h"
@@ -27,6 +28,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CXXFieldCollector.h"
@@ -42,6 +44,7 @@
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/Support/Capacity.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 using namespace clang;
 using namespace sema;
@@ -119,6 +122,17 @@ void SemaPPCallbacks::UsingDirective(SourceLocation HashLoc,
   S.LoadManagedAssembly(FID);
 }
 
+/// \brief Attributes memory allocated in the ASTContext to the template
+/// instantiations recorded by -ftime-trace.
+static size_t getASTAllocatedMemory(const void *Context) {
+  return static_cast<const ASTContext *>(Context)->getASTAllocatedMemory();
+}
+
+/// \brief Measures the side tables of Sema for -fast-memory-report.
+static size_t getSemaSideTableMemory(const void *S) {
+  return static_cast<const Sema *>(S)->getSideTableAllocatedMemory();
+}
+
 Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
            TranslationUnitKind TUKind,
            CodeCompleteConsumer *CodeCompleter)
@@ -142,7 +156,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     NSDictionaryDecl(0), DictionaryWithObjectsMethod(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0),
+    NumSFINAEErrors(0), NumOverloadCandidatesPruned(0),
+    NumOverloadConversionsReused(0), NumDeductionFailuresReused(0),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
     CurrentInstantiationScope(0), DisableTypoCorrection(false),
@@ -174,6 +189,15 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
 
   // Initilization of data sharing attributes stack for OpenMP
   InitDataSharingAttributesStack();
+
+  if (TimeTraceProfiler *Profiler = TimeTraceProfiler::getCurrent())
+    Profiler->setMemoryCounter(&getASTAllocatedMemory, &Context);
+
+  if (ASTMemoryAccounting *Accounting = ASTMemoryAccounting::getCurrent()) {
+    Context.setMemoryAccounting(Accounting);
+    Accounting->addCounter(ASTMemoryAccounting::SemaTables,
+                           &getSemaSideTableMemory, this);
+  }
 }
 
 void Sema::addImplicitTypedef(StringRef Name, QualType T) {
@@ -271,7 +295,15 @@ void Sema::Initialize() {
 }
 
 Sema::~Sema() {
+  if (TimeTraceProfiler *Profiler = TimeTraceProfiler::getCurrent())
+    if (Profiler->getMemoryCounterData() == &Context)
+      Profiler->setMemoryCounter(0, 0);
+
+  if (ASTMemoryAccounting *Accounting = Context.getMemoryAccounting())
+    Accounting->removeCounters(this);
+
   llvm::DeleteContainerSeconds(LateParsedTemplateMap);
+  clearDeductionFailureCache();
   if (PackContext) FreePackedContext();
   if (VisContext) FreeVisContext();
   // Kill all the active scopes.
@@ -355,11 +387,32 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumOverloadCandidatesPruned
+               << " overload candidates pruned by arity.\n";
+  llvm::errs() << NumOverloadConversionsReused
+               << " overload argument conversions reused.\n";
+  llvm::errs() << NumDeductionFailuresReused
+               << " template argument deduction failures reused.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
 }
 
+size_t Sema::getSideTableAllocatedMemory() const {
+  return BumpAlloc.getTotalMemory() +
+         DeductionFailureCache.size() * sizeof(CachedDeductionFailure) +
+         PendingInstantiations.size() * sizeof(PendingImplicitInstantiation) +
+         PendingLocalImplicitInstantiations.size() *
+             sizeof(PendingImplicitInstantiation) +
+         llvm::capacity_in_bytes(LocallyScopedExternCDecls) +
+         llvm::capacity_in_bytes(WeakUndeclaredIdentifiers) +
+         llvm::capacity_in_bytes(UnparsedDefaultArgLocs) +
+         llvm::capacity_in_bytes(UndefinedButUsed) +
+         llvm::capacity_in_bytes(ReferencedSelectors) +
+         llvm::capacity_in_bytes(VTableUses) +
+         llvm::capacity_in_bytes(VTablesUsed);
+}
+
 /// ImpCastExprToType - If Expr is not of type 'Type', insert an implicit cast.
 /// If there is already an implicit cast, merge into the existing one.
 /// The result is of the given category.
@@ -664,7 +717,7 @@ void Sema::ActOnEndOfTranslationUnit() {
     return;
 
   // Complete translation units and modules define vtables and perform implicit
-  // instantiations. PCH files do not.
+  // instantiations. PCH files do not, unless asked to instantiate templates.
   if (TUKind != TU_Prefix) {
     DiagnoseUseOfUnimplementedSelectors();
 
@@ -699,6 +752,12 @@ void Sema::ActOnEndOfTranslationUnit() {
     // name that was not visible at its first point of instantiation.
     PerformPendingInstantiations();
     CheckDelayedMemberExceptionSpecs();
+  } else if (LangOpts.PCHInstantiateTemplates) {
+    // Perform the implicit instantiations the PCH needs so far, so they are
+    // serialized with it instead of being redone in every file that uses it.
+    // As in a complete translation unit, the point of instantiation is
+    // effectively the end of the PCH.
+    PerformPendingInstantiations();
   }
 
   // All delayed member exception specs should be checked or we end up accepting
@@ -2515,6 +2515,9 @@ static CLIDefinitionData *GetCLIRecordData(Sema &S,
                                            //TypeDefinition^ TypeDef
   ) {
   CLIDefinitionData *CD = new (S.getASTContext()) CLIDefinitionData();
+  if (ASTMemoryAccounting *Accounting = S.getASTContext().getMemoryAccounting())
+    Accounting->add(ASTMemoryAccounting::DefinitionData,
+                    sizeof(CLIDefinitionData));
   CD->AssemblyName = TypeDef->getModule()->getAssembly()->getName(); //marshalString<E_UTF8>(
   CD->FullName = TypeDef->getFullName(); //marshalString<E_UTF8>(
   CD->Type = CLI_RT_ReferenceType;
@@ -1077,6 +1077,12 @@ void Sema::PushOnScopeChains(NamedDecl *D, Scope *S, bool AddToContext) {
   if (AddToContext)
     CurContext->addDecl(D);
 
+  // A new overload or redeclaration can change the outcome of a substitution
+  // that failed before. Function-local declarations are never found from
+  // within a template declared elsewhere.
+  if (!D->getDeclContext()->isFunctionOrMethod())
+    clearDeductionFailureCache();
+
   // Out-of-line definitions shouldn't be pushed into scope in C++, unless they
   // are function-local declarations.
   if (getLangOpts().CPlusPlus && D->isOutOfLine() &&
@@ -9649,14 +9655,10 @@ Decl *Sema::ActOnStartOfFunctionDef(Scope *FnBodyScope, Decl *D) {
       // for lack of a real context earlier. If so, remove from the translation unit
       // and reattach to the current context.
       if (D->getLexicalDeclContext() == Context.getTranslationUnitDecl()) {
-        // Is the decl actually in the context?
-        for (DeclContext::decl_iterator DI = Context.getTranslationUnitDecl()->decls_begin(),
-               DE = Context.getTranslationUnitDecl()->decls_end(); DI != DE; ++DI) {
-          if (*DI == D) {  
-            Context.getTranslationUnitDecl()->removeDecl(D);
-            break;
-          }
-        }
+        // Is the decl actually in the context? Don't walk all the decls of
+        // the translation unit to find out.
+        if (Context.getTranslationUnitDecl()->containsDecl(D))
+          Context.getTranslationUnitDecl()->removeDecl(D);
         // Either way, reassign the lexical decl context to our FunctionDecl.
         D->setLexicalDeclContext(CurContext);
       }
@@ -11109,6 +11111,9 @@ CreateNewDecl:
   if (CXXRecordDecl *RD = dyn_cast<CXXRecordDecl>(New)) {
     if (isCLITagTypeKind(Kind)) {
       CLIDefinitionData *Data = new (Context) CLIDefinitionData();
+      if (ASTMemoryAccounting *Accounting = Context.getMemoryAccounting())
+        Accounting->add(ASTMemoryAccounting::DefinitionData,
+                        sizeof(CLIDefinitionData));
       Data->Type = convertTagKindToCLIRecordType(Kind);
       RD->setCLIData(Data);
     }
@@ -11284,6 +11289,10 @@ void Sema::ActOnTagFinishDefinition(Scope *S, Decl *TagD,
   if (isa<CXXRecordDecl>(Tag))
     FieldCollector->FinishClass();
 
+  // A deduction that failed because this type was incomplete might succeed
+  // now.
+  clearDeductionFailureCache();
+
   // Exit this scope of this tag's definition.
   PopDeclContext();
 
@@ -13061,6 +13070,7 @@ DeclResult Sema::ActOnModuleImport(SourceLocation AtLoc,
                                           AtLoc.isValid()? AtLoc : ImportLoc, 
                                           Mod, IdentifierLocs);
   Context.getTranslationUnitDecl()->addDecl(Import);
+  clearDeductionFailureCache();
   return Import;
 }
 
@@ -13068,6 +13078,7 @@ void Sema::ActOnModuleInclude(SourceLocation DirectiveLoc, Module *Mod) {
   // FIXME: Should we synthesize an ImportDecl here?
   PP.getModuleLoader().makeModuleVisible(Mod, Module::AllVisible, DirectiveLoc,
                                          /*Complain=*/true);
+  clearDeductionFailureCache();
 }
 
 void Sema::createImplicitModuleImport(SourceLocation Loc, Module *Mod) {
@@ -13081,6 +13092,7 @@ void Sema::createImplicitModuleImport(SourceLocation Loc, Module *Mod) {
   // Make the module visible.
   PP.getModuleLoader().makeModuleVisible(Mod, Module::AllVisible, Loc,
                                          /*Complain=*/false);
+  clearDeductionFailureCache();
 }
 
 void Sema::ActOnPragmaRedefineExtname(IdentifierInfo* Name,
@@ -56,8 +56,10 @@ CreateFunctionRefExpr(Sema &S, FunctionDecl *Fn, NamedDecl *FoundDecl,
   // being used.
   if (FoundDecl != Fn && S.DiagnoseUseOfDecl(Fn, Loc))
     return ExprError();
-  DeclRefExpr *DRE = new (S.Context) DeclRefExpr(Fn, false, Fn->getType(),
-                                                 VK_LValue, Loc, LocInfo);
+  DeclRefExpr *DRE = DeclRefExpr::Create(
+      S.Context, NestedNameSpecifierLoc(), SourceLocation(), Fn, false,
+      DeclarationNameInfo(Fn->getDeclName(), Loc, LocInfo), Fn->getType(),
+      VK_LValue);
   if (HadMultipleCandidates)
     DRE->setHadMultipleCandidates(true);
 
@@ -811,6 +813,7 @@ void OverloadCandidateSet::clear() {
   NumInlineSequences = 0;
   Candidates.clear();
   Functions.clear();
+  ConversionCache.clear();
 }
 
 namespace {
@@ -5730,6 +5733,32 @@ AddCLIVariadicParameterArraysOverloads(Sema& S,
                        Args, CandidateSet, SuppressUserConversions);
 }
 
+/// \brief Determine the implicit conversion sequence for passing \p Arg to a
+/// parameter of type \p ParamType of a candidate in \p CandidateSet, reusing
+/// the one computed for an earlier candidate with the same parameter type.
+static ImplicitConversionSequence
+TryCopyInitializationForCandidate(Sema &S, OverloadCandidateSet &CandidateSet,
+                                  Expr *Arg, QualType ParamType,
+                                  bool SuppressUserConversions,
+                                  bool AllowExplicit = false) {
+  if (const ImplicitConversionSequence *ICS
+        = CandidateSet.findConversion(Arg, ParamType, SuppressUserConversions,
+                                      AllowExplicit)) {
+    ++S.NumOverloadConversionsReused;
+    return *ICS;
+  }
+
+  ImplicitConversionSequence ICS
+    = TryCopyInitialization(S, Arg, ParamType, SuppressUserConversions,
+                            /*InOverloadResolution=*/true,
+                            /*AllowObjCWritebackConversion=*/
+                              S.getLangOpts().ObjCAutoRefCount,
+                            AllowExplicit);
+  CandidateSet.addConversion(Arg, ParamType, SuppressUserConversions,
+                             AllowExplicit, ICS);
+  return ICS;
+}
+
 /// AddOverloadCandidate - Adds the given function to the set of
 /// candidate functions, using the given function call arguments.  If
 /// @p SuppressUserConversions, then don't allow user-defined
@@ -5814,6 +5843,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumOverloadCandidatesPruned;
     return;
   }
 
@@ -5827,6 +5857,7 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumOverloadCandidatesPruned;
     return;
   }
 
@@ -5849,12 +5880,10 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
       Candidate.Conversions[ArgIdx]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount,
-                                AllowExplicit);
+        = TryCopyInitializationForCandidate(*this, CandidateSet,
+                                            Args[ArgIdx], ParamType,
+                                            SuppressUserConversions,
+                                            AllowExplicit);
       if (Candidate.Conversions[ArgIdx].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -6072,6 +6101,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
   if (Args.size() > NumParams && !Proto->isVariadic()) {
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_many_arguments;
+    ++NumOverloadCandidatesPruned;
     return;
   }
 
@@ -6085,6 +6115,7 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
     // Not enough arguments.
     Candidate.Viable = false;
     Candidate.FailureKind = ovl_fail_too_few_arguments;
+    ++NumOverloadCandidatesPruned;
     return;
   }
 
@@ -6116,11 +6147,9 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
       Candidate.Conversions[ArgIdx + 1]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount);
+        = TryCopyInitializationForCandidate(*this, CandidateSet,
+                                            Args[ArgIdx], ParamType,
+                                            SuppressUserConversions);
       if (Candidate.Conversions[ArgIdx + 1].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -6142,6 +6171,34 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
   }
 }
 
+/// \brief Determine whether a call with \p NumArgs arguments could match
+/// \p FunctionTemplate at all, before setting up template argument deduction.
+///
+/// This mirrors the first checks performed by Sema::DeduceTemplateArguments,
+/// so that pruned candidates are diagnosed exactly as if deduction had been
+/// attempted.
+static Sema::TemplateDeductionResult
+CheckTemplateCandidateArity(Sema &S, FunctionTemplateDecl *FunctionTemplate,
+                            unsigned NumArgs) {
+  if (FunctionTemplate->isInvalidDecl())
+    return Sema::TDK_Invalid;
+
+  FunctionDecl *Function = FunctionTemplate->getTemplatedDecl();
+  if (NumArgs < Function->getMinRequiredArguments()) {
+    ++S.NumOverloadCandidatesPruned;
+    return Sema::TDK_TooFewArguments;
+  }
+  if (NumArgs > Function->getNumParams()) {
+    const FunctionProtoType *Proto
+      = Function->getType()->getAs<FunctionProtoType>();
+    if (!Proto->isTemplateVariadic() && !Proto->isVariadic()) {
+      ++S.NumOverloadCandidatesPruned;
+      return Sema::TDK_TooManyArguments;
+    }
+  }
+  return Sema::TDK_Success;
+}
+
 /// \brief Add a C++ member function template as a candidate to the candidate
 /// set, using template argument deduction to produce an appropriate member
 /// function template specialization.
@@ -6169,9 +6226,12 @@ Sema::AddMethodTemplateCandidate(FunctionTemplateDecl *MethodTmpl,
   //   functions.
   TemplateDeductionInfo Info(CandidateSet.getLocation());
   FunctionDecl *Specialization = 0;
-  if (TemplateDeductionResult Result
-      = DeduceTemplateArguments(MethodTmpl, ExplicitTemplateArgs, Args,
-                                Specialization, Info)) {
+  TemplateDeductionResult Result
+    = CheckTemplateCandidateArity(*this, MethodTmpl, Args.size());
+  if (!Result)
+    Result = DeduceTemplateArguments(MethodTmpl, ExplicitTemplateArgs, Args,
+                                     Specialization, Info);
+  if (Result) {
     OverloadCandidate &Candidate = CandidateSet.addCandidate();
     Candidate.FoundDecl = FoundDecl;
     Candidate.Function = MethodTmpl->getTemplatedDecl();
@@ -6219,9 +6279,12 @@ Sema::AddTemplateOverloadCandidate(FunctionTemplateDecl *FunctionTemplate,
   //   functions.
   TemplateDeductionInfo Info(CandidateSet.getLocation());
   FunctionDecl *Specialization = 0;
-  if (TemplateDeductionResult Result
-        = DeduceTemplateArguments(FunctionTemplate, ExplicitTemplateArgs, Args,
-                                  Specialization, Info)) {
+  TemplateDeductionResult Result
+    = CheckTemplateCandidateArity(*this, FunctionTemplate, Args.size());
+  if (!Result)
+    Result = DeduceTemplateArguments(FunctionTemplate, ExplicitTemplateArgs,
+                                     Args, Specialization, Info);
+  if (Result) {
     OverloadCandidate &Candidate = CandidateSet.addCandidate();
     Candidate.FoundDecl = FoundDecl;
     Candidate.Function = FunctionTemplate->getTemplatedDecl();
@@ -22,6 +22,7 @@
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/Template.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include <algorithm>
 
@@ -3274,6 +3275,87 @@ DeduceTemplateArgumentByListElement(Sema &S,
                                             ArgType, Info, Deduced, TDF);
 }
 
+/// \brief Compute the key under which a failed deduction of the template
+/// arguments of \p FunctionTemplate from a call is cached.
+///
+/// \returns false if the outcome of the deduction could depend on more than
+/// the key captures, in which case it must not be cached.
+static bool getDeductionFailureCacheKey(Sema &S,
+                                        FunctionTemplateDecl *FunctionTemplate,
+                                TemplateArgumentListInfo *ExplicitTemplateArgs,
+                                        ArrayRef<Expr *> Args,
+                                        llvm::FoldingSetNodeID &ID) {
+  if (S.CurContext->isDependentContext())
+    return false;
+
+  ID.AddPointer(FunctionTemplate);
+  ID.AddBoolean(ExplicitTemplateArgs != 0);
+  if (ExplicitTemplateArgs) {
+    ID.AddInteger(ExplicitTemplateArgs->size());
+    for (unsigned I = 0, N = ExplicitTemplateArgs->size(); I != N; ++I) {
+      const TemplateArgument &Arg = (*ExplicitTemplateArgs)[I].getArgument();
+      if (Arg.isInstantiationDependent() ||
+          Arg.containsUnexpandedParameterPack() || Arg.isPackExpansion())
+        return false;
+      S.Context.getCanonicalTemplateArgument(Arg).Profile(ID, S.Context);
+    }
+  }
+
+  ID.AddInteger(Args.size());
+  for (unsigned I = 0, N = Args.size(); I != N; ++I) {
+    Expr *Arg = Args[I];
+    // Deduction from an initializer list or an overload set looks at the
+    // expression itself, and deduction may complete the type of an array of
+    // unknown bound.
+    if (Arg->isTypeDependent() || isa<InitListExpr>(Arg) ||
+        Arg->getType()->isPlaceholderType() ||
+        Arg->getType()->isIncompleteArrayType())
+      return false;
+    ID.AddPointer(S.Context.getCanonicalType(Arg->getType()).getAsOpaquePtr());
+    ID.AddBoolean(Arg->isLValue());
+  }
+  return true;
+}
+
+/// \brief Whether a deduction failure is worth caching and is fully described
+/// by its TemplateDeductionInfo, so that it can be replayed.
+static bool isCacheableDeductionFailure(Sema::TemplateDeductionResult TDK) {
+  switch (TDK) {
+  case Sema::TDK_Incomplete:
+  case Sema::TDK_Inconsistent:
+  case Sema::TDK_Underqualified:
+  case Sema::TDK_SubstitutionFailure:
+  case Sema::TDK_NonDeducedMismatch:
+  case Sema::TDK_InvalidExplicitArguments:
+  case Sema::TDK_MiscellaneousDeductionFailure:
+    return true;
+
+  // These are found before any real work is done, or depend on more than
+  // the types of the arguments.
+  case Sema::TDK_Success:
+  case Sema::TDK_Invalid:
+  case Sema::TDK_InstantiationDepth:
+  case Sema::TDK_TooManyArguments:
+  case Sema::TDK_TooFewArguments:
+  case Sema::TDK_FailedOverloadResolution:
+    return false;
+  }
+  llvm_unreachable("unknown template deduction result");
+}
+
+void Sema::clearDeductionFailureCache() {
+  if (DeductionFailureCache.empty())
+    return;
+
+  SmallVector<CachedDeductionFailure *, 16> Entries;
+  for (llvm::FoldingSet<CachedDeductionFailure>::iterator
+         I = DeductionFailureCache.begin(), E = DeductionFailureCache.end();
+       I != E; ++I)
+    Entries.push_back(&*I);
+  DeductionFailureCache.clear();
+  llvm::DeleteContainerPointers(Entries);
+}
+
 /// \brief Perform template argument deduction from a function call
 /// (C++ [temp.deduct.call]).
 ///
@@ -3297,6 +3379,65 @@ Sema::TemplateDeductionResult Sema::DeduceTemplateArguments(
     FunctionTemplateDecl *FunctionTemplate,
     TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
     FunctionDecl *&Specialization, TemplateDeductionInfo &Info) {
+  // SFINAE-heavy code considers the same function template for the same
+  // argument types over and over; replay the failures we have already seen.
+  llvm::FoldingSetNodeID ID;
+  if (!getDeductionFailureCacheKey(*this, FunctionTemplate,
+                                   ExplicitTemplateArgs, Args, ID))
+    return DeduceCallTemplateArgumentsUncached(FunctionTemplate,
+                                               ExplicitTemplateArgs, Args,
+                                               Specialization, Info);
+
+  void *InsertPos;
+  if (CachedDeductionFailure *Cached
+        = DeductionFailureCache.FindNodeOrInsertPos(ID, InsertPos)) {
+    ++NumDeductionFailuresReused;
+    Info.Param = TemplateParameter::getFromOpaqueValue(Cached->Param);
+    Info.FirstArg = Cached->FirstArg;
+    Info.SecondArg = Cached->SecondArg;
+    Info.reset(Cached->Deduced);
+    if (Cached->HasSFINAEDiagnostic)
+      Info.addSFINAEDiagnostic(Cached->SFINAEDiagnostic.first,
+                               Cached->SFINAEDiagnostic.second);
+    return static_cast<TemplateDeductionResult>(Cached->Result);
+  }
+
+  // An error that escapes the SFINAE trap, e.g. in the instantiation of a
+  // class template, is only diagnosed once, so don't replay what follows it.
+  DiagnosticErrorTrap Trap(Diags);
+  TemplateDeductionResult Result
+    = DeduceCallTemplateArgumentsUncached(FunctionTemplate,
+                                          ExplicitTemplateArgs, Args,
+                                          Specialization, Info);
+  if (!isCacheableDeductionFailure(Result) || Trap.hasErrorOccurred())
+    return Result;
+
+  // Deduction may itself have changed the cache, so look up the insertion
+  // point again.
+  if (DeductionFailureCache.FindNodeOrInsertPos(ID, InsertPos))
+    return Result;
+
+  CachedDeductionFailure *Cached = new CachedDeductionFailure(ID);
+  Cached->Result = Result;
+  Cached->Param = Info.Param.getOpaqueValue();
+  Cached->FirstArg = Info.FirstArg;
+  Cached->SecondArg = Info.SecondArg;
+  Cached->Deduced = Info.take();
+  Info.reset(Cached->Deduced);
+  if (Info.hasSFINAEDiagnostic()) {
+    Cached->HasSFINAEDiagnostic = true;
+    Cached->SFINAEDiagnostic = *Info.diag_begin();
+  }
+  DeductionFailureCache.InsertNode(Cached, InsertPos);
+  return Result;
+}
+
+/// \brief Perform template argument deduction from a function call, without
+/// consulting or updating the cache of deduction failures.
+Sema::TemplateDeductionResult Sema::DeduceCallTemplateArgumentsUncached(
+    FunctionTemplateDecl *FunctionTemplate,
+    TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
+    FunctionDecl *&Specialization, TemplateDeductionInfo &Info) {
   if (FunctionTemplate->isInvalidDecl())
     return TDK_Invalid;
 
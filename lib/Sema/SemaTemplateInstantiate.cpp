@@ -18,6 +18,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
@@ -220,6 +221,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -243,6 +245,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -268,6 +271,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -294,6 +298,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
     
     if (!Inst.isInstantiationRecord())
       ++SemaRef.NonInstantiationEntries;
@@ -322,6 +327,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -345,6 +351,7 @@ Sema::InstantiatingTemplate::InstantiatingTemplate(
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -369,6 +376,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -393,6 +401,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -417,6 +426,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
     Inst.InstantiationRange = InstantiationRange;
     SemaRef.InNonInstantiationSFINAEContext = false;
     SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+    BeginTimeTrace();
   }
 }
 
@@ -441,6 +451,7 @@ InstantiatingTemplate(Sema &SemaRef, SourceLocation PointOfInstantiation,
   Inst.InstantiationRange = InstantiationRange;
   SemaRef.InNonInstantiationSFINAEContext = false;
   SemaRef.ActiveTemplateInstantiations.push_back(Inst);
+  BeginTimeTrace();
   
   assert(!Inst.isInstantiationRecord());
   ++SemaRef.NonInstantiationEntries;
@@ -455,6 +466,9 @@ void Sema::InstantiatingTemplate::Clear() {
     SemaRef.InNonInstantiationSFINAEContext
       = SavedInNonInstantiationSFINAEContext;
 
+    if (Profiler)
+      Profiler->end();
+
     // Name lookup no longer looks in this template's defining module.
     assert(SemaRef.ActiveTemplateInstantiations.size() >=
            SemaRef.ActiveTemplateInstantiationLookupModules.size() &&
@@ -471,6 +485,66 @@ void Sema::InstantiatingTemplate::Clear() {
   }
 }
 
+/// \brief Returns the name of the -ftime-trace event for the given kind of
+/// template instantiation.
+static StringRef
+getTimeTraceEventName(const Sema::ActiveTemplateInstantiation &Inst) {
+  switch (Inst.Kind) {
+  case Sema::ActiveTemplateInstantiation::TemplateInstantiation:
+    if (isa<CXXRecordDecl>(Inst.Entity))
+      return "InstantiateClass";
+    if (isa<FunctionDecl>(Inst.Entity))
+      return "InstantiateFunction";
+    if (isa<VarDecl>(Inst.Entity))
+      return "InstantiateVariable";
+    return "InstantiateTemplate";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentInstantiation:
+    return "InstantiateDefaultTemplateArgument";
+  case Sema::ActiveTemplateInstantiation::DefaultFunctionArgumentInstantiation:
+    return "InstantiateDefaultArgument";
+  case Sema::ActiveTemplateInstantiation::ExplicitTemplateArgumentSubstitution:
+    return "SubstituteExplicitTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::DeducedTemplateArgumentSubstitution:
+    return "DeduceTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::PriorTemplateArgumentSubstitution:
+    return "SubstituteTemplateArguments";
+  case Sema::ActiveTemplateInstantiation::DefaultTemplateArgumentChecking:
+    return "CheckDefaultTemplateArgument";
+  case Sema::ActiveTemplateInstantiation::ExceptionSpecInstantiation:
+    return "InstantiateExceptionSpec";
+  }
+  llvm_unreachable("Invalid InstantiationKind!");
+}
+
+/// \brief Record the instantiation just pushed onto the instantiation stack
+/// as an -ftime-trace event, if a profiler is active.
+void Sema::InstantiatingTemplate::BeginTimeTrace() {
+  Profiler = TimeTraceProfiler::getCurrent();
+  if (!Profiler)
+    return;
+
+  const ActiveTemplateInstantiation &Inst
+    = SemaRef.ActiveTemplateInstantiations.back();
+  PrintingPolicy Policy = SemaRef.getPrintingPolicy();
+
+  // Name the template (rather than the parameter) being substituted into,
+  // along with the arguments when they aren't already part of its name.
+  std::string Detail;
+  llvm::raw_string_ostream OS(Detail);
+  Decl *D = Inst.Template ? Inst.Template : Inst.Entity;
+  if (NamedDecl *ND = dyn_cast_or_null<NamedDecl>(D))
+    ND->getNameForDiagnostic(OS, Policy, /*Qualified=*/true);
+  if (Inst.Kind != ActiveTemplateInstantiation::TemplateInstantiation &&
+      Inst.Kind != ActiveTemplateInstantiation::ExceptionSpecInstantiation &&
+      Inst.NumTemplateArgs)
+    TemplateSpecializationType::PrintTemplateArgumentList(
+        OS, Inst.TemplateArgs, Inst.NumTemplateArgs, Policy);
+
+  Profiler->begin(getTimeTraceEventName(Inst), OS.str());
+  Profiler->setLocation(TimeTraceProfiler::getLocationString(
+      Inst.PointOfInstantiation, SemaRef.SourceMgr));
+}
+
 bool Sema::InstantiatingTemplate::CheckInstantiationDepth(
                                         SourceLocation PointOfInstantiation,
                                            SourceRange InstantiationRange) {
@@ -18,6 +18,7 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/TypeLoc.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
@@ -4704,6 +4705,12 @@ NamedDecl *Sema::FindInstantiatedDecl(SourceLocation Loc, NamedDecl *D,
 /// \brief Performs template instantiation for all implicit template
 /// instantiations we have seen until this point.
 void Sema::PerformPendingInstantiations(bool LocalOnly) {
+  // Record the end-of-translation-unit flush for -ftime-trace; local flushes
+  // happen after every function and are part of whatever encloses them.
+  TimeTraceProfiler *Profiler = LocalOnly ? 0 : TimeTraceProfiler::getCurrent();
+  if (Profiler)
+    Profiler->begin("PerformPendingInstantiations");
+
   // Load pending instantiations from the external source.
   if (!LocalOnly && ExternalSource) {
     SmallVector<PendingImplicitInstantiation, 4> Pending;
@@ -4712,6 +4719,12 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
                                  Pending.begin(), Pending.end());
   }
 
+  // When instantiating at the end of a PCH, the templates of some pending
+  // instantiations may not be defined yet. Keep those pending, so that the
+  // files using the PCH instantiate them once they see the definition.
+  bool KeepUndefined = !LocalOnly && TUKind == TU_Prefix;
+  SmallVector<PendingImplicitInstantiation, 4> StillPending;
+
   while (!PendingLocalImplicitInstantiations.empty() ||
          (!LocalOnly && !PendingInstantiations.empty())) {
     PendingImplicitInstantiation Inst;
@@ -4732,6 +4745,8 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
                                 TSK_ExplicitInstantiationDefinition;
       InstantiateFunctionDefinition(/*FIXME:*/Inst.second, Function, true,
                                     DefinitionRequired);
+      if (KeepUndefined && !Function->isDefined())
+        StillPending.push_back(Inst);
       continue;
     }
 
@@ -4773,7 +4788,15 @@ void Sema::PerformPendingInstantiations(bool LocalOnly) {
     // specializations.
     InstantiateVariableDefinition(/*FIXME:*/ Inst.second, Var, true,
                                   DefinitionRequired);
+    if (KeepUndefined && !Var->getDefinition())
+      StillPending.push_back(Inst);
   }
+
+  PendingInstantiations.insert(PendingInstantiations.end(),
+                               StillPending.begin(), StillPending.end());
+
+  if (Profiler)
+    Profiler->end();
 }
 
 void Sema::PerformDependentDiagnostics(const DeclContext *Pattern,
@@ -27,6 +27,7 @@
 #include "clang/Basic/SourceManagerInternals.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Basic/Version.h"
 #include "clang/Basic/VersionTuple.h"
 #include "clang/Lex/HeaderSearch.h"
@@ -46,7 +47,10 @@
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1421,18 +1425,22 @@ namespace {
   /// \brief Visitor class used to look up identifirs in an AST file.
   class IdentifierLookupVisitor {
     StringRef Name;
+    IdentifierBloomFilter::Hash NameHash;
     unsigned PriorGeneration;
     unsigned &NumIdentifierLookups;
     unsigned &NumIdentifierLookupHits;
+    unsigned &NumIdentifierLookupsFiltered;
     IdentifierInfo *Found;
 
   public:
     IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
-                            unsigned &NumIdentifierLookupHits)
-      : Name(Name), PriorGeneration(PriorGeneration),
+                            unsigned &NumIdentifierLookupHits,
+                            unsigned &NumIdentifierLookupsFiltered)
+      : Name(Name), NameHash(Name), PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
         NumIdentifierLookupHits(NumIdentifierLookupHits),
+        NumIdentifierLookupsFiltered(NumIdentifierLookupsFiltered),
         Found()
     {
     }
@@ -1449,6 +1457,13 @@ namespace {
         = (ASTIdentifierLookupTable *)M.IdentifierLookupTable;
       if (!IdTable)
         return false;
+
+      // Most identifiers are in very few of the loaded module files; don't
+      // probe the hash table of those that provably don't have this one.
+      if (!M.IdentifierFilter.mayContain(This->NameHash)) {
+        ++This->NumIdentifierLookupsFiltered;
+        return false;
+      }
       
       ASTIdentifierLookupTrait Trait(IdTable->getInfoObj().getReader(),
                                      M, This->Found);
@@ -1491,7 +1506,8 @@ void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
 
   IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(IdentifierLookupVisitor::visit, &Visitor, HitsPtr);
   markIdentifierUpToDate(&II);
 }
@@ -1977,6 +1993,100 @@ void ASTReader::MaybeAddSystemRootToFilename(ModuleFile &M,
   Filename.insert(Filename.begin(), isysroot.begin(), isysroot.end());
 }
 
+namespace {
+  /// \brief An AST file whose input files have been validated.
+  struct ValidatedASTFile {
+    /// \brief The size and modification time of the AST file when it was
+    /// validated.
+    off_t Size;
+    time_t ModTime;
+
+    /// \brief Whether the system input files were validated as well.
+    bool IncludedSystemInputs;
+  };
+
+  /// \brief The AST files whose input files have been validated by this
+  /// process, shared by all ASTReaders.
+  struct ValidatedASTFileCache {
+    llvm::sys::Mutex Lock;
+    llvm::StringMap<ValidatedASTFile> Files;
+  };
+}
+
+static llvm::ManagedStatic<ValidatedASTFileCache> ValidatedASTFiles;
+
+/// \brief Determine whether the input files of \p F have already been
+/// validated by this process.
+static bool isValidatedInProcess(ModuleFile &F, bool SystemInputs) {
+  if (!F.File)
+    return false;
+  ValidatedASTFileCache &Cache = *ValidatedASTFiles;
+  llvm::sys::ScopedLock L(Cache.Lock);
+  llvm::StringMap<ValidatedASTFile>::iterator Known
+    = Cache.Files.find(F.FileName);
+  return Known != Cache.Files.end() &&
+         Known->second.Size == F.File->getSize() &&
+         Known->second.ModTime == F.File->getModificationTime() &&
+         (Known->second.IncludedSystemInputs || !SystemInputs);
+}
+
+/// \brief Note that the input files of \p F have been validated.
+static void markValidatedInProcess(ModuleFile &F, bool SystemInputs) {
+  if (!F.File)
+    return;
+  ValidatedASTFileCache &Cache = *ValidatedASTFiles;
+  llvm::sys::ScopedLock L(Cache.Lock);
+  ValidatedASTFile &Entry = Cache.Files[F.FileName];
+  Entry.Size = F.File->getSize();
+  Entry.ModTime = F.File->getModificationTime();
+  Entry.IncludedSystemInputs = SystemInputs;
+}
+
+/// \brief Determine whether the contents of any file are remapped or
+/// overridden for \p PP.
+static bool hasRemappedFiles(Preprocessor &PP) {
+  const PreprocessorOptions &PPOpts = PP.getPreprocessorOpts();
+  return !PPOpts.RemappedFiles.empty() ||
+         !PPOpts.RemappedFileBuffers.empty() ||
+         PP.getSourceManager().hasFileOverrides();
+}
+
+bool ASTReader::computeInputSignature(StringRef Filename,
+                                      std::pair<uint64_t, uint64_t> &Signature) {
+  OwningPtr<llvm::MemoryBuffer> Buffer;
+  if (llvm::MemoryBuffer::getFile(Filename, Buffer))
+    return true;
+
+  llvm::MD5 Hash;
+  Hash.update(Buffer->getBuffer());
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  Signature.first = Signature.second = 0;
+  for (unsigned I = 0; I != 8; ++I) {
+    Signature.first |= uint64_t(Result[I]) << (8 * I);
+    Signature.second |= uint64_t(Result[I + 8]) << (8 * I);
+  }
+  return false;
+}
+
+/// \brief Determine whether the input signature recorded in \p F
+/// matches the current input signature file, if there is one.
+bool ASTReader::matchesInputSignature(ModuleFile &F) {
+  if (!F.HasInputSignature)
+    return false;
+
+  if (!ComputedInputSignature) {
+    ComputedInputSignature = true;
+    const std::string &SignatureFile
+      = PP.getHeaderSearchInfo().getHeaderSearchOpts().InputSignatureFile;
+    HasCurrentInputSignature
+      = !SignatureFile.empty() &&
+        !computeInputSignature(SignatureFile, CurrentInputSignature);
+  }
+
+  return HasCurrentInputSignature && F.InputSignature == CurrentInputSignature;
+}
+
 ASTReader::ASTReadResult
 ASTReader::ReadControlBlock(ModuleFile &F,
                             SmallVectorImpl<ImportedModule> &Loaded,
@@ -2005,25 +2115,44 @@ ASTReader::ReadControlBlock(ModuleFile &F,
           (!HSOpts.ModulesValidateOncePerBuildSession ||
            F.InputFilesValidationTimestamp <= HSOpts.BuildSessionTimestamp)) {
         bool Complain = (ClientLoadCapabilities & ARR_OutOfDate) == 0;
-        // All user input files reside at the index range [0, Record[1]), and
-        // system input files reside at [Record[1], Record[0]).
-        // Record is the one from INPUT_FILE_OFFSETS.
+        // All user input files reside at the index range
+        // [0, NumUserInputFiles), and system input files reside at
+        // [NumUserInputFiles, InputFilesLoaded.size()).
         //
         // If we are reading a module, we will create a verification timestamp,
         // so we verify all input files.  Otherwise, verify only user input
         // files.
-        unsigned NumInputs = Record[0];
-        unsigned NumUserInputs = Record[1];
-        unsigned N = ValidateSystemInputs ||
-                             (HSOpts.ModulesValidateOncePerBuildSession &&
-                              F.Kind == MK_Module)
-                         ? NumInputs
-                         : NumUserInputs;
+        bool SystemInputs = ValidateSystemInputs ||
+                            (HSOpts.ModulesValidateOncePerBuildSession &&
+                             F.Kind == MK_Module);
+
+        // Skip the per-file checks if the input signature still matches, or
+        // if this process has already checked these input files.
+        if (matchesInputSignature(F)) {
+          ++NumInputValidationsBySignature;
+          return Success;
+        }
+        // The process-wide cache only knows about the AST file itself.
+        // Remapped files and unsaved buffers change the outcome of the
+        // validation (an input file of the AST file must not be
+        // overridden), so don't use the cache when there are any.
+        bool UseValidationCache = HSOpts.ValidateASTInputsOncePerProcess &&
+                                  !hasRemappedFiles(PP);
+        if (UseValidationCache && isValidatedInProcess(F, SystemInputs)) {
+          ++NumInputValidationsCached;
+          return Success;
+        }
+
+        unsigned N = SystemInputs ? F.InputFilesLoaded.size()
+                                  : F.NumUserInputFiles;
         for (unsigned I = 0; I < N; ++I) {
           InputFile IF = getInputFile(F, I+1, Complain);
           if (!IF.getFile() || IF.isOutOfDate())
             return OutOfDate;
         }
+
+        if (UseValidationCache)
+          markValidatedInProcess(F, SystemInputs);
       }
       return Success;
     }
@@ -2191,6 +2320,12 @@ ASTReader::ReadControlBlock(ModuleFile &F,
     case INPUT_FILE_OFFSETS:
       F.InputFileOffsets = (const uint32_t *)Blob.data();
       F.InputFilesLoaded.resize(Record[0]);
+      F.NumUserInputFiles = Record[1];
+      break;
+
+    case INPUT_SIGNATURE:
+      F.InputSignature = std::make_pair(Record[0], Record[1]);
+      F.HasInputSignature = true;
       break;
     }
   }
@@ -2415,6 +2550,10 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
       }
       break;
 
+    case IDENTIFIER_BLOOM_FILTER:
+      F.IdentifierFilter = IdentifierBloomFilter::get(Blob, Record[0]);
+      break;
+
     case IDENTIFIER_OFFSET: {
       if (F.LocalNumIdentifiers != 0) {
         Error("duplicate IDENTIFIER_OFFSET record in AST file");
@@ -2804,7 +2943,7 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
     }
         
     case OBJC_CATEGORIES:
-      F.ObjCCategories.swap(Record);
+      F.ObjCCategories = (const uint32_t *)Blob.data();
       break;
         
     case CXX_BASE_SPECIFIER_OFFSETS: {
@@ -2819,6 +2958,18 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
       break;
     }
 
+    case CXX_CTOR_INITIALIZERS_OFFSETS: {
+      if (F.LocalNumCXXCtorInitializers != 0) {
+        Error("duplicate CXX_CTOR_INITIALIZERS_OFFSETS record in AST file");
+        return true;
+      }
+
+      F.LocalNumCXXCtorInitializers = Record[0];
+      F.CXXCtorInitializersOffsets = (const uint32_t *)Blob.data();
+      TotalNumCXXCtorInitializers += F.LocalNumCXXCtorInitializers;
+      break;
+    }
+
     case DIAG_PRAGMA_MAPPINGS:
       if (F.PragmaDiagMappings.empty())
         F.PragmaDiagMappings.swap(Record);
@@ -2904,10 +3055,9 @@ bool ASTReader::ReadASTBlock(ModuleFile &F) {
       break;
     }
 
-    case LOCAL_REDECLARATIONS: {
-      F.RedeclarationChains.swap(Record);
+    case LOCAL_REDECLARATIONS:
+      F.RedeclarationChains = (const uint32_t *)Blob.data();
       break;
-    }
         
     case LOCAL_REDECLARATIONS_MAP: {
       if (F.LocalNumRedeclarationsInMap != 0) {
@@ -3118,6 +3268,10 @@ ASTReader::ASTReadResult ASTReader::ReadAST(const std::string &FileName,
                                             ModuleKind Type,
                                             SourceLocation ImportLoc,
                                             unsigned ClientLoadCapabilities) {
+  TimeTraceScope TraceScope("ReadAST", FileName);
+  if (TraceScope.isActive())
+    TraceScope.setLocation(ImportLoc, SourceMgr);
+
   llvm::SaveAndRestore<SourceLocation>
     SetCurImportLocRAII(CurrentImportLoc, ImportLoc);
 
@@ -5681,6 +5835,35 @@ CXXBaseSpecifier *ASTReader::GetExternalCXXBaseSpecifiers(uint64_t Offset) {
   return Bases;
 }
 
+uint64_t ASTReader::readCXXCtorInitializersRef(ModuleFile &M,
+                                               const RecordData &Record,
+                                               unsigned &Idx) {
+  unsigned LocalID = Record[Idx++];
+  assert(LocalID && LocalID <= M.LocalNumCXXCtorInitializers &&
+         "Invalid constructor initializers ID");
+  return getGlobalBitOffset(M, M.CXXCtorInitializersOffsets[LocalID - 1]);
+}
+
+CXXCtorInitializer **
+ASTReader::GetExternalCXXCtorInitializers(uint64_t Offset) {
+  RecordLocation Loc = getLocalBitOffset(Offset);
+  BitstreamCursor &Cursor = Loc.F->DeclsCursor;
+  SavedStreamPosition SavedPosition(Cursor);
+  Cursor.JumpToBit(Loc.Offset);
+  ReadingKindTracker ReadingKind(Read_Decl, *this);
+  RecordData Record;
+  unsigned Code = Cursor.ReadCode();
+  unsigned RecCode = Cursor.readRecord(Code, Record);
+  if (RecCode != DECL_CXX_CTOR_INITIALIZERS) {
+    Error("Malformed AST file: missing C++ constructor initializers");
+    return 0;
+  }
+
+  ++NumCXXCtorInitializersRead;
+  unsigned Idx = 0;
+  return ReadCXXCtorInitializers(*Loc.F, Record, Idx).first;
+}
+
 serialization::DeclID 
 ASTReader::getGlobalDeclID(ModuleFile &F, LocalDeclID LocalID) const {
   if (LocalID < NUM_PREDEF_DECL_IDS)
@@ -5819,6 +6002,7 @@ Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
   // Offset here is a global offset across the entire chain.
   RecordLocation Loc = getLocalBitOffset(Offset);
   Loc.F->DeclsCursor.JumpToBit(Loc.Offset);
+  ++NumLazyBodiesRead;
   return ReadStmtFromStream(*Loc.F);
 }
 
@@ -6191,6 +6375,22 @@ void ASTReader::completeVisibleDeclsMap(const DeclContext *DC) {
   const_cast<DeclContext *>(DC)->setHasExternalVisibleStorage(false);
 }
 
+void ASTReader::completeAllDeclarations() {
+  Deserializing Everything(this);
+
+  for (unsigned I = 0, N = getTotalNumTypes(); I != N; ++I)
+    GetType((I + NUM_PREDEF_TYPE_IDS) << Qualifiers::FastWidth);
+
+  for (unsigned I = 0, N = getTotalNumDecls(); I != N; ++I)
+    GetDecl(I + NUM_PREDEF_DECL_IDS);
+
+  for (unsigned I = 0, N = getTotalNumIdentifiers(); I != N; ++I) {
+    IdentifierInfo *II = DecodeIdentifierInfo(I + 1);
+    if (II && II->isOutOfDate())
+      updateOutOfDateIdentifier(*II);
+  }
+}
+
 /// \brief Under non-PCH compilation the consumer receives the objc methods
 /// before receiving the implementation, and codegen depends on this.
 /// We simulate this by deserializing and passing to consumer the methods of the
@@ -6327,6 +6527,40 @@ void ASTReader::PrintStats() {
                  NumIdentifierLookupHits, NumIdentifierLookups,
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumIdentifierLookupsFiltered) {
+    std::fprintf(stderr,
+                 "  %u identifier table lookups avoided by Bloom filters\n",
+                 NumIdentifierLookupsFiltered);
+  }
+  if (NumLazyBodies) {
+    std::fprintf(stderr, "  %u/%u lazy function bodies read (%f%%)\n",
+                 NumLazyBodiesRead, NumLazyBodies,
+                 ((float)NumLazyBodiesRead/NumLazyBodies * 100));
+  }
+  if (TotalNumCXXCtorInitializers) {
+    std::fprintf(stderr,
+                 "  %u/%u constructor initializer lists read (%f%%)\n",
+                 NumCXXCtorInitializersRead, TotalNumCXXCtorInitializers,
+                 ((float)NumCXXCtorInitializersRead/TotalNumCXXCtorInitializers
+                  * 100));
+  }
+  if (NumMergedDefinitions) {
+    std::fprintf(stderr,
+                 "  %u/%u merged class definitions matched by hash (%f%%)\n",
+                 NumMergedDefinitionsByHash, NumMergedDefinitions,
+                 ((float)NumMergedDefinitionsByHash/NumMergedDefinitions
+                  * 100));
+  }
+  if (NumInputValidationsBySignature) {
+    std::fprintf(stderr,
+                 "  %u AST files validated by input signature\n",
+                 NumInputValidationsBySignature);
+  }
+  if (NumInputValidationsCached) {
+    std::fprintf(stderr,
+                 "  %u AST files already validated by this process\n",
+                 NumInputValidationsCached);
+  }
 
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
@@ -6457,7 +6691,8 @@ IdentifierInfo* ASTReader::get(const char *NameStart, const char *NameEnd) {
   }
   IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
-                                  NumIdentifierLookupHits);
+                                  NumIdentifierLookupHits,
+                                  NumIdentifierLookupsFiltered);
   ModuleMgr.visit(IdentifierLookupVisitor::visit, &Visitor, HitsPtr);
   IdentifierInfo *II = Visitor.getIdentifierInfo();
   markIdentifierUpToDate(II);
@@ -7806,14 +8041,18 @@ void ASTReader::finishPendingActions() {
     if (FunctionDecl *FD = dyn_cast<FunctionDecl>(PB->first)) {
       // FIXME: Check for =delete/=default?
       // FIXME: Complain about ODR violations here?
-      if (!getContext().getLangOpts().Modules || !FD->hasBody())
+      if (!getContext().getLangOpts().Modules || !FD->hasBody()) {
         FD->setLazyBody(PB->second);
+        ++NumLazyBodies;
+      }
       continue;
     }
 
     ObjCMethodDecl *MD = cast<ObjCMethodDecl>(PB->first);
-    if (!getContext().getLangOpts().Modules || !MD->hasBody())
+    if (!getContext().getLangOpts().Modules || !MD->hasBody()) {
       MD->setLazyBody(PB->second);
+      ++NumLazyBodies;
+    }
   }
   PendingBodies.clear();
 }
@@ -7879,6 +8118,7 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
     NumSLocEntriesRead(0), TotalNumSLocEntries(0), 
     NumStatementsRead(0), TotalNumStatements(0), NumMacrosRead(0),
     TotalNumMacros(0), NumIdentifierLookups(0), NumIdentifierLookupHits(0),
+    NumIdentifierLookupsFiltered(0),
     NumSelectorsRead(0), NumMethodPoolEntriesRead(0),
     NumMethodPoolLookups(0), NumMethodPoolHits(0),
     NumMethodPoolTableLookups(0), NumMethodPoolTableHits(0),
@@ -7887,7 +8127,12 @@ ASTReader::ASTReader(Preprocessor &PP, ASTContext &Context,
     NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
     TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
     PassingDeclsToConsumer(false),
-    NumCXXBaseSpecifiersLoaded(0), ReadingKind(Read_None)
+    NumCXXBaseSpecifiersLoaded(0), NumLazyBodies(0), NumLazyBodiesRead(0),
+    TotalNumCXXCtorInitializers(0), NumCXXCtorInitializersRead(0),
+    NumMergedDefinitions(0), NumMergedDefinitionsByHash(0),
+    NumInputValidationsBySignature(0), NumInputValidationsCached(0),
+    ComputedInputSignature(false), HasCurrentInputSignature(false),
+    ReadingKind(Read_None)
 {
   SourceMgr.setExternalSLocEntrySource(this);
 }
@@ -22,6 +22,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/Expr.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Sema/IdentifierResolver.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/SemaDiagnostic.h"
@@ -102,6 +103,8 @@ namespace clang {
     
     void ReadCXXDefinitionData(struct CXXRecordDecl::DefinitionData &Data,
                                const RecordData &R, unsigned &I);
+    void noteMergedDefinition(CXXRecordDecl *D,
+                              const struct CXXRecordDecl::DefinitionData &Def);
 
     /// \brief RAII class used to capture the first ID within a redeclaration
     /// chain and to introduce it into the list of pending redeclaration chains
@@ -1211,6 +1214,8 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Data.ImplicitCopyAssignmentHasConstParam = Record[Idx++];
   Data.HasDeclaredCopyConstructorWithConstParam = Record[Idx++];
   Data.HasDeclaredCopyAssignmentWithConstParam = Record[Idx++];
+  Data.ODRHash = Record[Idx++];
+  Data.HasODRHash = Data.ODRHash != 0;
 
   Data.NumBases = Record[Idx++];
   if (Data.NumBases)
@@ -1258,6 +1263,23 @@ void ASTDeclReader::ReadCXXDefinitionData(
   }
 }
 
+/// \brief Note that the definition of \p D has been merged into the existing
+/// definition \p Def.
+void ASTDeclReader::noteMergedDefinition(
+    CXXRecordDecl *D, const struct CXXRecordDecl::DefinitionData &Def) {
+  ++Reader.NumMergedDefinitions;
+
+  // If both definitions came from AST files with the same content hash,
+  // they are identical and the members of D need no ODR checking. Don't
+  // compute the hash of a definition that was parsed rather than loaded;
+  // that would cost more than the checks it saves.
+  const struct CXXRecordDecl::DefinitionData &Data = *D->DefinitionData;
+  if (Data.HasODRHash && Def.HasODRHash && Data.ODRHash == Def.ODRHash) {
+    ++Reader.NumMergedDefinitionsByHash;
+    Reader.IdenticalMergedDefinitions.insert(D);
+  }
+}
+
 ASTDeclReader::RedeclarableResult
 ASTDeclReader::VisitCXXRecordDeclImpl(CXXRecordDecl *D) {
   RedeclarableResult Redecl = VisitRecordDeclImpl(D);
@@ -1274,6 +1296,10 @@ ASTDeclReader::VisitCXXRecordDeclImpl(CXXRecordDecl *D) {
                                                                       false, LCD_None);
     else
       D->DefinitionData = new (C) struct CXXRecordDecl::DefinitionData(D);
+    if (ASTMemoryAccounting *Accounting = C.getMemoryAccounting())
+      Accounting->add(ASTMemoryAccounting::DefinitionData,
+                      IsLambda ? sizeof(CXXRecordDecl::LambdaDefinitionData)
+                               : sizeof(CXXRecordDecl::DefinitionData));
 
     ReadCXXDefinitionData(*D->DefinitionData, Record, Idx);
 
@@ -1296,6 +1322,7 @@ ASTDeclReader::VisitCXXRecordDeclImpl(CXXRecordDecl *D) {
       // FIXME: Check DefinitionData for consistency with prior definition.
       Reader.MergedDeclContexts.insert(
           std::make_pair(D, D->getCanonicalDecl()->DefinitionData->Definition));
+      noteMergedDefinition(D, *Canon->DefinitionData);
       D->IsCompleteDefinition = false;
       D->DefinitionData = D->getCanonicalDecl()->DefinitionData;
     }
@@ -1350,8 +1377,9 @@ void ASTDeclReader::VisitCXXConstructorDecl(CXXConstructorDecl *D) {
   VisitCXXMethodDecl(D);
   
   D->IsExplicitSpecified = Record[Idx++];
-  llvm::tie(D->CtorInitializers, D->NumCtorInitializers)
-      = Reader.ReadCXXCtorInitializers(F, Record, Idx);
+  D->NumCtorInitializers = Record[Idx++];
+  if (D->NumCtorInitializers)
+    D->CtorInitializers = Reader.readCXXCtorInitializersRef(F, Record, Idx);
 }
 
 void ASTDeclReader::VisitCXXDestructorDecl(CXXDestructorDecl *D) {
@@ -1591,6 +1619,7 @@ ASTDeclReader::VisitClassTemplateSpecializationDeclImpl(
             Reader.PendingDefinitions.erase(D);
             Reader.MergedDeclContexts.insert(
                 std::make_pair(D, CanonSpec->DefinitionData->Definition));
+            noteMergedDefinition(D, *CanonSpec->DefinitionData);
             D->IsCompleteDefinition = false;
             D->DefinitionData = CanonSpec->DefinitionData;
           }
@@ -2256,7 +2285,11 @@ ASTDeclReader::FindExistingResult ASTDeclReader::findExisting(NamedDecl *D) {
 
   // If this declaration is from a merged context, make a note that we need to
   // check that the canonical definition of that context contains the decl.
-  if (Reader.MergedDeclContexts.count(D->getLexicalDeclContext()))
+  // A context whose content hash matched the canonical definition's is known
+  // to contain the same declarations, so it needs no check.
+  DeclContext *LexicalDC = D->getLexicalDeclContext();
+  if (Reader.MergedDeclContexts.count(LexicalDC) &&
+      !Reader.IdenticalMergedDefinitions.count(LexicalDC))
     Reader.PendingOdrMergeChecks.push_back(D);
 
   return FindExistingResult(Reader, D, /*Existing=*/0);
@@ -2359,6 +2392,8 @@ ASTReader::combineStoredMergedDecls(Decl *Canon, GlobalDeclID CanonID) {
 
 /// \brief Read the declaration at the given offset from the AST file.
 Decl *ASTReader::ReadDeclRecord(DeclID ID) {
+  TimeTraceScope TraceScope("DeserializeDecl");
+
   unsigned Index = ID - NUM_PREDEF_DECL_IDS;
   unsigned RawLocation = 0;
   RecordLocation Loc = DeclCursorForID(ID, RawLocation);
@@ -2636,6 +2671,14 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   if (isConsumerInterestedIn(D, Reader.hasPendingBody()))
     InterestingDecls.push_back(D);
 
+  // Only use the name if it is a plain identifier: printing other names can
+  // require deserializing more of the AST. Source locations are left out for
+  // the same reason.
+  if (TraceScope.isActive())
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      if (IdentifierInfo *II = ND->getIdentifier())
+        TraceScope.setDetail(II->getName());
+
   return D;
 }
 
@@ -2749,8 +2792,9 @@ namespace {
       
       // Dig out all of the redeclarations.
       unsigned Offset = Result->Offset;
-      unsigned N = M.RedeclarationChains[Offset];
-      M.RedeclarationChains[Offset++] = 0; // Don't try to deserialize again
+      if (!M.LoadedRedeclarationChains.insert(Offset).second)
+        return; // Already deserialized.
+      unsigned N = M.RedeclarationChains[Offset++];
       for (unsigned I = 0; I != N; ++I)
         addToChain(Reader.GetLocalDecl(M, M.RedeclarationChains[Offset++]));
     }
@@ -2930,8 +2974,9 @@ namespace {
       
       // We found something. Dig out all of the categories.
       unsigned Offset = Result->Offset;
-      unsigned N = M.ObjCCategories[Offset];
-      M.ObjCCategories[Offset++] = 0; // Don't try to deserialize again
+      if (!M.LoadedObjCCategories.insert(Offset).second)
+        return true; // Already deserialized.
+      unsigned N = M.ObjCCategories[Offset++];
       for (unsigned I = 0; I != N; ++I)
         add(cast_or_null<ObjCCategoryDecl>(
               Reader.GetLocalDecl(M, M.ObjCCategories[Offset++])));
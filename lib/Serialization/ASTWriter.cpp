@@ -40,6 +40,7 @@
 #include "clang/Sema/IdentifierResolver.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTReader.h"
+#include "clang/Serialization/IdentifierBloomFilter.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
@@ -827,6 +828,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(FILE_SYSTEM_OPTIONS);
   RECORD(HEADER_SEARCH_OPTIONS);
   RECORD(PREPROCESSOR_OPTIONS);
+  RECORD(INPUT_SIGNATURE);
 
   BLOCK(INPUT_FILES_BLOCK);
   RECORD(INPUT_FILE);
@@ -880,6 +882,8 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(MACRO_OFFSET);
   RECORD(MACRO_TABLE);
   RECORD(LATE_PARSED_TEMPLATE);
+  RECORD(IDENTIFIER_BLOOM_FILTER);
+  RECORD(CXX_CTOR_INITIALIZERS_OFFSETS);
 
   // SourceManager Block.
   BLOCK(SOURCE_MANAGER_BLOCK);
@@ -987,6 +991,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(DECL_TEMPLATE_TEMPLATE_PARM);
   RECORD(DECL_STATIC_ASSERT);
   RECORD(DECL_CXX_BASE_SPECIFIERS);
+  RECORD(DECL_CXX_CTOR_INITIALIZERS);
   RECORD(DECL_INDIRECTFIELD);
   RECORD(DECL_EXPANDED_NON_TYPE_TEMPLATE_PARM_PACK);
   
@@ -1268,6 +1273,18 @@ void ASTWriter::WriteControlBlock(Preprocessor &PP, ASTContext &Context,
                   PP.getHeaderSearchInfo().getHeaderSearchOpts(),
                   isysroot,
                   PP.getLangOpts().Modules);
+
+  // Input signature, which lets readers skip checking the input files.
+  const std::string &SignatureFile
+    = PP.getHeaderSearchInfo().getHeaderSearchOpts().InputSignatureFile;
+  std::pair<uint64_t, uint64_t> Signature;
+  if (!SignatureFile.empty() &&
+      !ASTReader::computeInputSignature(SignatureFile, Signature)) {
+    Record.clear();
+    Record.push_back(Signature.first);
+    Record.push_back(Signature.second);
+    Stream.EmitRecord(INPUT_SIGNATURE, Record);
+  }
   Stream.ExitBlock();
 }
 
@@ -2578,6 +2595,28 @@ void ASTWriter::WriteCXXBaseSpecifiersOffsets() {
                             data(CXXBaseSpecifiersOffsets));
 }
 
+void ASTWriter::WriteCXXCtorInitializersOffsets() {
+  if (CXXCtorInitializersOffsets.empty())
+    return;
+
+  RecordData Record;
+
+  // Create a blob abbreviation for the C++ constructor initializer offsets.
+  using namespace llvm;
+
+  BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(CXX_CTOR_INITIALIZERS_OFFSETS));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // size
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned CtorInitializersOffsetAbbrev = Stream.EmitAbbrev(Abbrev);
+
+  // Write the constructor initializer offsets table.
+  Record.push_back(CXX_CTOR_INITIALIZERS_OFFSETS);
+  Record.push_back(CXXCtorInitializersOffsets.size());
+  Stream.EmitRecordWithBlob(CtorInitializersOffsetAbbrev, Record,
+                            data(CXXCtorInitializersOffsets));
+}
+
 //===----------------------------------------------------------------------===//
 // Type Serialization
 //===----------------------------------------------------------------------===//
@@ -3260,16 +3299,25 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     // Create the on-disk hash table representation. We only store offsets
     // for identifiers that appear here for the first time.
     IdentifierOffsets.resize(NextIdentID - FirstIdentID);
+    SmallVector<const IdentifierInfo *, 256> TableIdentifiers;
     for (llvm::DenseMap<const IdentifierInfo *, IdentID>::iterator
            ID = IdentifierIDs.begin(), IDEnd = IdentifierIDs.end();
          ID != IDEnd; ++ID) {
       assert(ID->first && "NULL identifier in identifier table");
       if (!Chain || !ID->first->isFromAST() || 
-          ID->first->hasChangedSinceDeserialization())
+          ID->first->hasChangedSinceDeserialization()) {
         Generator.insert(const_cast<IdentifierInfo *>(ID->first), ID->second,
                          Trait);
+        TableIdentifiers.push_back(ID->first);
+      }
     }
 
+    // Summarize the identifier table in a Bloom filter, so that readers can
+    // skip it for identifiers it does not contain.
+    IdentifierBloomFilterBuilder Filter(TableIdentifiers.size());
+    for (unsigned I = 0, N = TableIdentifiers.size(); I != N; ++I)
+      Filter.add(TableIdentifiers[I]->getName());
+
     // Create the on-disk hash table in a buffer.
     SmallString<4096> IdentifierTable;
     uint32_t BucketOffset;
@@ -3293,6 +3341,18 @@ void ASTWriter::WriteIdentifierTable(Preprocessor &PP,
     Record.push_back(IDENTIFIER_TABLE);
     Record.push_back(BucketOffset);
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable.str());
+
+    // Write the Bloom filter for the identifier table.
+    Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_BLOOM_FILTER));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // # of hashes
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned FilterAbbrev = Stream.EmitAbbrev(Abbrev);
+
+    Record.clear();
+    Record.push_back(IDENTIFIER_BLOOM_FILTER);
+    Record.push_back(Filter.getNumHashes());
+    Stream.EmitRecordWithBlob(FilterAbbrev, Record, Filter.getData());
   }
 
   // Write the offsets table for identifier IDs.
@@ -3661,8 +3721,20 @@ void ASTWriter::WriteRedeclarations() {
     reinterpret_cast<char*>(LocalRedeclsMap.data()),
     LocalRedeclsMap.size() * sizeof(LocalRedeclarationsInfo));
 
-  // Emit the redeclaration chains.
-  Stream.EmitRecord(LOCAL_REDECLARATIONS, LocalRedeclChains);
+  // Emit the redeclaration chains as 32-bit values, so that the reader can
+  // use them directly from the AST file.
+  Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(LOCAL_REDECLARATIONS));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // # of entries
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  AbbrevID = Stream.EmitAbbrev(Abbrev);
+
+  SmallVector<uint32_t, 16> Chains(LocalRedeclChains.begin(),
+                                   LocalRedeclChains.end());
+  Record.clear();
+  Record.push_back(LOCAL_REDECLARATIONS);
+  Record.push_back(Chains.size());
+  Stream.EmitRecordWithBlob(AbbrevID, Record, data(Chains));
 }
 
 void ASTWriter::WriteObjCCategories() {
@@ -3714,8 +3786,19 @@ void ASTWriter::WriteObjCCategories() {
                             reinterpret_cast<char*>(CategoriesMap.data()),
                             CategoriesMap.size() * sizeof(ObjCCategoriesInfo));
   
-  // Emit the category lists.
-  Stream.EmitRecord(OBJC_CATEGORIES, Categories);
+  // Emit the category lists as 32-bit values, so that the reader can use
+  // them directly from the AST file.
+  Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(OBJC_CATEGORIES));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // # of entries
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  AbbrevID = Stream.EmitAbbrev(Abbrev);
+
+  SmallVector<uint32_t, 16> Lists(Categories.begin(), Categories.end());
+  Record.clear();
+  Record.push_back(OBJC_CATEGORIES);
+  Record.push_back(Lists.size());
+  Stream.EmitRecordWithBlob(AbbrevID, Record, data(Lists));
 }
 
 void ASTWriter::WriteMergedDecls() {
@@ -3836,7 +3919,7 @@ void ASTWriter::SetSelectorOffset(Selector Sel, uint32_t Offset) {
 ASTWriter::ASTWriter(llvm::BitstreamWriter &Stream)
   : Stream(Stream), Context(0), PP(0), Chain(0), WritingModule(0),
     WritingAST(false), DoneWritingDeclsAndTypes(false),
-    ASTHasCompilerErrors(false),
+    ASTHasCompilerErrors(false), TotalBitsWritten(0),
     FirstDeclID(NUM_PREDEF_DECL_IDS), NextDeclID(FirstDeclID),
     FirstTypeID(NUM_PREDEF_TYPE_IDS), NextTypeID(FirstTypeID),
     FirstIdentID(NUM_PREDEF_IDENT_IDS), NextIdentID(FirstIdentID),
@@ -3847,7 +3930,7 @@ ASTWriter::ASTWriter(llvm::BitstreamWriter &Stream)
     CollectedStmts(&StmtsToEmit),
     NumStatements(0), NumMacros(0), NumLexicalDeclContexts(0),
     NumVisibleDeclContexts(0),
-    NextCXXBaseSpecifiersID(1),
+    NextCXXBaseSpecifiersID(1), NextCXXCtorInitializersID(1),
     DeclParmVarAbbrev(0), DeclContextLexicalAbbrev(0),
     DeclContextVisibleLookupAbbrev(0), UpdateVisibleAbbrev(0),
     DeclRefExprAbbrev(0), CharacterLiteralAbbrev(0),
@@ -3869,6 +3952,8 @@ void ASTWriter::WriteAST(Sema &SemaRef,
   WritingAST = true;
   
   ASTHasCompilerErrors = hasErrors;
+  PartSizes.clear();
+  uint64_t StartBit = Stream.GetCurrentBitNo();
   
   // Emit the file header.
   Stream.Emit((unsigned)'C', 8);
@@ -3877,6 +3962,7 @@ void ASTWriter::WriteAST(Sema &SemaRef,
   Stream.Emit((unsigned)'H', 8);
 
   WriteBlockInfoBlock();
+  notePartWritten("header and block info", StartBit);
 
   Context = &SemaRef.Context;
   PP = &SemaRef.PP;
@@ -3886,9 +3972,42 @@ void ASTWriter::WriteAST(Sema &SemaRef,
   PP = 0;
   this->WritingModule = 0;
   
+  TotalBitsWritten = Stream.GetCurrentBitNo() - StartBit;
   WritingAST = false;
 }
 
+void ASTWriter::notePartWritten(const char *Name, uint64_t StartBit) {
+  uint64_t Bits = Stream.GetCurrentBitNo() - StartBit;
+  for (unsigned I = 0, N = PartSizes.size(); I != N; ++I) {
+    if (PartSizes[I].first == Name) {
+      PartSizes[I].second += Bits;
+      return;
+    }
+  }
+  PartSizes.push_back(std::make_pair(Name, Bits));
+}
+
+void ASTWriter::PrintStats() const {
+  fprintf(stderr, "*** AST File Writer Statistics:\n");
+  fprintf(stderr, "  %llu bytes written\n",
+          (unsigned long long)(TotalBitsWritten / 8));
+  if (!TotalBitsWritten)
+    return;
+
+  uint64_t Accounted = 0;
+  for (unsigned I = 0, N = PartSizes.size(); I != N; ++I) {
+    Accounted += PartSizes[I].second;
+    fprintf(stderr, "  %llu bytes (%.1f%%) in %s\n",
+            (unsigned long long)(PartSizes[I].second / 8),
+            (double)PartSizes[I].second * 100.0 / TotalBitsWritten,
+            PartSizes[I].first);
+  }
+  uint64_t Other = TotalBitsWritten - Accounted;
+  fprintf(stderr, "  %llu bytes (%.1f%%) in other records\n",
+          (unsigned long long)(Other / 8),
+          (double)Other * 100.0 / TotalBitsWritten);
+}
+
 template<typename Vector>
 static void AddLazyVectorDecls(ASTWriter &Writer, Vector &Vec,
                                ASTWriter::RecordData &Record) {
@@ -4074,7 +4193,9 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
   }
 
   // Write the control block
+  uint64_t StartBit = Stream.GetCurrentBitNo();
   WriteControlBlock(PP, Context, isysroot, OutputFile);
+  notePartWritten("control block", StartBit);
 
   // Write the remaining AST contents.
   RecordData Record;
@@ -4164,6 +4285,7 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
 
   // Keep writing types and declarations until all types and
   // declarations have been written.
+  StartBit = Stream.GetCurrentBitNo();
   Stream.EnterSubblock(DECLTYPES_BLOCK_ID, NUM_ALLOWED_ABBREVS_SIZE);
   WriteDeclsBlockAbbrevs();
   for (DeclsToRewriteTy::iterator I = DeclsToRewrite.begin(), 
@@ -4179,12 +4301,17 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
       WriteDecl(Context, DOT.getDecl());
   }
   Stream.ExitBlock();
+  notePartWritten("declarations and types", StartBit);
 
   DoneWritingDeclsAndTypes = true;
 
   WriteFileDeclIDsMap();
+  StartBit = Stream.GetCurrentBitNo();
   WriteSourceManagerBlock(Context.getSourceManager(), PP, isysroot);
+  notePartWritten("source manager block", StartBit);
+  StartBit = Stream.GetCurrentBitNo();
   WriteComments();
+  notePartWritten("comments", StartBit);
   
   if (Chain) {
     // Write the mapping information describing our module dependencies and how
@@ -4230,18 +4357,29 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
     Stream.EmitRecordWithBlob(ModuleOffsetMapAbbrev, Record,
                               Buffer.data(), Buffer.size());
   }
+  StartBit = Stream.GetCurrentBitNo();
   WritePreprocessor(PP, isModule);
+  notePartWritten("preprocessor", StartBit);
+  StartBit = Stream.GetCurrentBitNo();
   WriteHeaderSearch(PP.getHeaderSearchInfo(), isysroot);
+  notePartWritten("header search table", StartBit);
+  StartBit = Stream.GetCurrentBitNo();
   WriteSelectors(SemaRef);
   WriteReferencedSelectorsPool(SemaRef);
+  notePartWritten("selectors", StartBit);
+  StartBit = Stream.GetCurrentBitNo();
   WriteIdentifierTable(PP, SemaRef.IdResolver, isModule);
+  notePartWritten("identifier table", StartBit);
   WriteFPPragmaOptions(SemaRef.getFPOptions());
   WriteOpenCLExtensions(SemaRef);
 
+  StartBit = Stream.GetCurrentBitNo();
   WriteTypeDeclOffsets();
+  notePartWritten("type and declaration offsets", StartBit);
   WritePragmaDiagnosticMappings(Context.getDiagnostics(), isModule);
 
   WriteCXXBaseSpecifiersOffsets();
+  WriteCXXCtorInitializersOffsets();
   
   // If we're emitting a module, write out the submodule information.  
   if (WritingModule)
@@ -4336,11 +4474,13 @@ void ASTWriter::WriteASTCore(Sema &SemaRef,
     }
   }
 
+  StartBit = Stream.GetCurrentBitNo();
   WriteDeclUpdatesBlocks();
   WriteDeclReplacementsBlock();
   WriteRedeclarations();
   WriteMergedDecls();
   WriteObjCCategories();
+  notePartWritten("declaration updates and redeclarations", StartBit);
   WriteLateParsedTemplates(SemaRef);
 
   // Some simple statistics
@@ -4531,6 +4671,15 @@ void ASTWriter::AddCXXBaseSpecifiersRef(CXXBaseSpecifier const *Bases,
   Record.push_back(NextCXXBaseSpecifiersID++);
 }
 
+void ASTWriter::AddCXXCtorInitializersRef(
+                                   CXXCtorInitializer const * const *Inits,
+                                   unsigned NumInits, RecordDataImpl &Record) {
+  assert(NumInits && "Empty initializer lists are not recorded");
+  CXXCtorInitializersToWrite.push_back(
+      QueuedCXXCtorInitializers(NextCXXCtorInitializersID, Inits, NumInits));
+  Record.push_back(NextCXXCtorInitializersID++);
+}
+
 void ASTWriter::AddTemplateArgumentLocInfo(TemplateArgument::ArgKind Kind,
                                            const TemplateArgumentLocInfo &Arg,
                                            RecordDataImpl &Record) {
@@ -5087,6 +5236,28 @@ void ASTWriter::FlushCXXBaseSpecifiers() {
   CXXBaseSpecifiersToWrite.clear();
 }
 
+void ASTWriter::FlushCXXCtorInitializers() {
+  RecordData Record;
+  for (unsigned I = 0, N = CXXCtorInitializersToWrite.size(); I != N; ++I) {
+    Record.clear();
+
+    // Record the offset of this initializer list.
+    unsigned Index = CXXCtorInitializersToWrite[I].ID - 1;
+    if (Index >= CXXCtorInitializersOffsets.size())
+      CXXCtorInitializersOffsets.resize(Index + 1);
+    CXXCtorInitializersOffsets[Index] = Stream.GetCurrentBitNo();
+
+    AddCXXCtorInitializers(CXXCtorInitializersToWrite[I].Inits,
+                           CXXCtorInitializersToWrite[I].NumInits, Record);
+    Stream.EmitRecord(serialization::DECL_CXX_CTOR_INITIALIZERS, Record);
+
+    // Flush any expressions that were written as part of the initializers.
+    FlushStmts();
+  }
+
+  CXXCtorInitializersToWrite.clear();
+}
+
 void ASTWriter::AddCXXCtorInitializers(
                              const CXXCtorInitializer * const *CtorInitializers,
                              unsigned NumCtorInitializers,
@@ -5165,6 +5336,9 @@ void ASTWriter::AddCXXDefinitionData(const CXXRecordDecl *D, RecordDataImpl &Rec
   Record.push_back(Data.ImplicitCopyAssignmentHasConstParam);
   Record.push_back(Data.HasDeclaredCopyConstructorWithConstParam);
   Record.push_back(Data.HasDeclaredCopyAssignmentWithConstParam);
+  // Only modules can contain several definitions of the same class that
+  // need to be merged, so only they pay for hashing the definition.
+  Record.push_back(WritingModule && !Data.IsLambda ? D->getODRHash() : 0);
   // IsLambda bit is already saved.
 
   Record.push_back(Data.NumBases);
@@ -1022,8 +1022,10 @@ void ASTDeclWriter::VisitCXXConstructorDecl(CXXConstructorDecl *D) {
   VisitCXXMethodDecl(D);
 
   Record.push_back(D->IsExplicitSpecified);
-  Writer.AddCXXCtorInitializers(D->CtorInitializers, D->NumCtorInitializers,
-                                Record);
+  Record.push_back(D->NumCtorInitializers);
+  if (D->NumCtorInitializers)
+    Writer.AddCXXCtorInitializersRef(D->init_begin(), D->NumCtorInitializers,
+                                     Record);
 
   Code = serialization::DECL_CXX_CONSTRUCTOR;
 }
@@ -1749,6 +1751,7 @@ void ASTWriter::WriteDeclsBlockAbbrevs() {
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); //ExplicitTemplateArgs
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); //HadMultipleCandidates
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 1)); //RefersToEnclosingLocal
+  Abv->Add(BitCodeAbbrevOp(0)); // HasNameLoc
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // DeclRef
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // Location
   DeclRefExprAbbrev = Stream.EmitAbbrev(Abv);
@@ -1907,6 +1910,9 @@ void ASTWriter::WriteDecl(ASTContext &Context, Decl *D) {
   
   // Flush C++ base specifiers, if there are any.
   FlushCXXBaseSpecifiers();
+
+  // Flush C++ constructor initializers, if there are any.
+  FlushCXXCtorInitializers();
   
   // Note declarations that should be deserialized eagerly so that we can add
   // them to a record in the AST file later.
@@ -350,6 +350,7 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
   Record.push_back(E->hasTemplateKWAndArgsInfo());
   Record.push_back(E->hadMultipleCandidates());
   Record.push_back(E->refersToEnclosingLocal());
+  Record.push_back(E->hasNameLoc());
 
   if (E->hasTemplateKWAndArgsInfo()) {
     unsigned NumTemplateArgs = E->getNumTemplateArgs();
@@ -359,7 +360,7 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
   DeclarationName::NameKind nk = (E->getDecl()->getDeclName().getNameKind());
 
   if ((!E->hasTemplateKWAndArgsInfo()) && (!E->hasQualifier()) &&
-      (E->getDecl() == E->getFoundDecl()) &&
+      (E->getDecl() == E->getFoundDecl()) && !E->hasNameLoc() &&
       nk == DeclarationName::Identifier) {
     AbbrevToUse = Writer.getDeclRefExprAbbrev();
   }
@@ -375,7 +376,9 @@ void ASTStmtWriter::VisitDeclRefExpr(DeclRefExpr *E) {
 
   Writer.AddDeclRef(E->getDecl(), Record);
   Writer.AddSourceLocation(E->getLocation(), Record);
-  Writer.AddDeclarationNameLoc(E->DNLoc, E->getDecl()->getDeclName(), Record);
+  if (E->hasNameLoc())
+    Writer.AddDeclarationNameLoc(E->getInternalNameLoc(),
+                                 E->getDecl()->getDeclName(), Record);
   Code = serialization::EXPR_DECL_REF;
 }
 
@@ -558,7 +561,7 @@ void ASTStmtWriter::VisitMemberExpr(MemberExpr *E) {
   Writer.AddDeclRef(E->getMemberDecl(), Record);
   Writer.AddSourceLocation(E->getMemberLoc(), Record);
   Record.push_back(E->isArrow());
-  Writer.AddDeclarationNameLoc(E->MemberDNLoc,
+  Writer.AddDeclarationNameLoc(E->getMemberNameInfo().getInfo(),
                                E->getMemberDecl()->getDeclName(), Record);
   Code = serialization::EXPR_MEMBER;
 }
@@ -19,7 +19,9 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
+#include <climits>
 #include <string>
 
 using namespace clang;
@@ -48,6 +50,14 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   if (hasErrors && !AllowASTWithErrors)
     return;
   
+  // If we are replacing an existing AST file, its size is a good estimate of
+  // the size of the new one; reserve that much up front so that the buffer
+  // does not repeatedly grow (and copy) while a large AST file is written.
+  uint64_t PreviousSize;
+  if (!llvm::sys::fs::file_size(OutputFile, PreviousSize) &&
+      PreviousSize > Buffer.capacity() && PreviousSize < UINT_MAX)
+    Buffer.reserve(PreviousSize);
+
   // Emit the PCH file
   assert(SemaPtr && "No Sema?");
   Writer.WriteAST(*SemaPtr, OutputFile, Module, isysroot, hasErrors);
@@ -58,12 +68,18 @@ void PCHGenerator::HandleTranslationUnit(ASTContext &Ctx) {
   // Make sure it hits disk now.
   Out->flush();
 
-  // Free up some memory, in case the process is kept alive.
-  Buffer.clear();
+  // Free up the buffer's memory, in case the process is kept alive; clear()
+  // alone would keep the whole AST file's worth of capacity around.
+  SmallVector<char, 128>().swap(Buffer);
 
   HasEmittedPCH = true;
 }
 
+void PCHGenerator::PrintStats() {
+  if (HasEmittedPCH)
+    Writer.PrintStats();
+}
+
 ASTMutationListener *PCHGenerator::GetASTMutationListener() {
   return &Writer;
 }
@@ -48,7 +48,9 @@ namespace {
     /// \brief Describes a module, including its file name and dependencies.
     MODULE,
     /// \brief The index for identifiers.
-    IDENTIFIER_INDEX
+    IDENTIFIER_INDEX,
+    /// \brief A Bloom filter over all identifiers in the identifier index.
+    IDENTIFIER_INDEX_BLOOM_FILTER
   };
 }
 
@@ -121,7 +123,8 @@ typedef OnDiskChainedHashTable<IdentifierIndexReaderTrait> IdentifierIndexTable;
 GlobalModuleIndex::GlobalModuleIndex(llvm::MemoryBuffer *Buffer,
                                      llvm::BitstreamCursor Cursor)
   : Buffer(Buffer), IdentifierIndex(),
-    NumIdentifierLookups(), NumIdentifierLookupHits()
+    NumIdentifierLookups(), NumIdentifierLookupHits(),
+    NumIdentifierLookupsFiltered()
 {
   // Read the global index.
   bool InGlobalIndexBlock = false;
@@ -215,6 +218,10 @@ GlobalModuleIndex::GlobalModuleIndex(llvm::MemoryBuffer *Buffer,
                             IdentifierIndexReaderTrait());
       }
       break;
+
+    case IDENTIFIER_INDEX_BLOOM_FILTER:
+      IdentifierFilter = IdentifierBloomFilter::get(Blob, Record[0]);
+      break;
     }
   }
 }
@@ -285,8 +292,14 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   if (!IdentifierIndex)
     return false;
 
-  // Look into the identifier index.
+  // Look into the identifier index. Most lookups are for identifiers that
+  // no module knows about, which the Bloom filter can usually answer.
   ++NumIdentifierLookups;
+  if (!IdentifierFilter.mayContain(Name)) {
+    ++NumIdentifierLookupsFiltered;
+    return true;
+  }
+
   IdentifierIndexTable &Table
     = *static_cast<IdentifierIndexTable *>(IdentifierIndex);
   IdentifierIndexTable::iterator Known = Table.find(Name);
@@ -338,6 +351,10 @@ void GlobalModuleIndex::printStats() {
             NumIdentifierLookupHits, NumIdentifierLookups,
             (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
+  if (NumIdentifierLookupsFiltered) {
+    fprintf(stderr, "  %u identifier lookups answered by the Bloom filter\n",
+            NumIdentifierLookupsFiltered);
+  }
   std::fprintf(stderr, "\n");
 }
 
@@ -439,6 +456,7 @@ GlobalModuleIndexBuilder::emitBlockInfoBlock(llvm::BitstreamWriter &Stream) {
   RECORD(INDEX_METADATA);
   RECORD(MODULE);
   RECORD(IDENTIFIER_INDEX);
+  RECORD(IDENTIFIER_INDEX_BLOOM_FILTER);
 #undef RECORD
 #undef BLOCK
 
@@ -726,6 +744,26 @@ void GlobalModuleIndexBuilder::writeIndex(llvm::BitstreamWriter &Stream) {
     Stream.EmitRecordWithBlob(IDTableAbbrev, Record, IdentifierTable.str());
   }
 
+  // Write a Bloom filter over all of the identifiers in the index.
+  {
+    IdentifierBloomFilterBuilder Filter(InterestingIdentifiers.size());
+    for (InterestingIdentifierMap::iterator I = InterestingIdentifiers.begin(),
+                                            IEnd = InterestingIdentifiers.end();
+         I != IEnd; ++I)
+      Filter.add(I->first());
+
+    BitCodeAbbrev *Abbrev = new BitCodeAbbrev();
+    Abbrev->Add(BitCodeAbbrevOp(IDENTIFIER_INDEX_BLOOM_FILTER));
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // # of hashes
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+    unsigned FilterAbbrev = Stream.EmitAbbrev(Abbrev);
+
+    Record.clear();
+    Record.push_back(IDENTIFIER_INDEX_BLOOM_FILTER);
+    Record.push_back(Filter.getNumHashes());
+    Stream.EmitRecordWithBlob(FilterAbbrev, Record, Filter.getData());
+  }
+
   Stream.ExitBlock();
 }
 
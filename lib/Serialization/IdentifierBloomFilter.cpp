@@ -0,0 +1,70 @@
+//===--- IdentifierBloomFilter.cpp - Bloom filter of identifiers ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the IdentifierBloomFilter class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Serialization/IdentifierBloomFilter.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace clang;
+using namespace serialization;
+
+/// \brief The number of filter bits per name.  Together with 7 hashes this
+/// gives a false positive rate of about 1%.
+static const unsigned BitsPerName = 10;
+
+/// \brief The number of bits set per name in the filters we write.
+static const unsigned DefaultNumHashes = 7;
+
+/// \brief The smallest filter we write, in bytes.
+static const unsigned MinFilterSize = 64;
+
+IdentifierBloomFilter::Hash::Hash(StringRef Name) {
+  // Two independent hashes: Bernstein (which the on-disk identifier tables
+  // also use) and FNV-1a.
+  H1 = llvm::HashString(Name);
+  uint32_t FNV = 2166136261u;
+  for (unsigned I = 0, N = Name.size(); I != N; ++I)
+    FNV = (FNV ^ (unsigned char)Name[I]) * 16777619u;
+  // The step has to be odd to visit distinct bits.
+  H2 = FNV | 1;
+}
+
+IdentifierBloomFilter IdentifierBloomFilter::get(StringRef Data,
+                                                 unsigned NumHashes) {
+  IdentifierBloomFilter Filter;
+  if (Data.empty() || !llvm::isPowerOf2_64(Data.size()) ||
+      Data.size() > (1u << 28) || NumHashes == 0)
+    return Filter;
+
+  Filter.Bits = (const unsigned char *)Data.data();
+  Filter.BitMask = Data.size() * 8 - 1;
+  Filter.NumHashes = NumHashes;
+  return Filter;
+}
+
+IdentifierBloomFilterBuilder::IdentifierBloomFilterBuilder(unsigned NumNames)
+  : NumHashes(DefaultNumHashes) {
+  uint64_t Size = (uint64_t)NumNames * BitsPerName / 8;
+  if (Size < MinFilterSize)
+    Size = MinFilterSize;
+  Bits.resize(llvm::NextPowerOf2(Size - 1));
+}
+
+void IdentifierBloomFilterBuilder::add(StringRef Name) {
+  IdentifierBloomFilter::Hash H(Name);
+  uint32_t BitMask = Bits.size() * 8 - 1;
+  for (unsigned I = 0; I != NumHashes; ++I) {
+    uint32_t Bit = (H.H1 + I * H.H2) & BitMask;
+    Bits[Bit >> 3] |= 1 << (Bit & 7);
+  }
+}
@@ -23,6 +23,7 @@ using namespace reader;
 ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
   : Kind(Kind), File(0), DirectlyImported(false),
     Generation(Generation), SizeInBits(0),
+    InputFileOffsets(0), NumUserInputFiles(0), HasInputSignature(false),
     LocalNumSLocEntries(0), SLocEntryBaseID(0),
     SLocEntryBaseOffset(0), SLocEntryOffsets(0),
     LocalNumIdentifiers(0),
@@ -38,9 +39,11 @@ ModuleFile::ModuleFile(ModuleKind Kind, unsigned Generation)
     SelectorLookupTableData(0), SelectorLookupTable(0), LocalNumDecls(0),
     DeclOffsets(0), BaseDeclID(0),
     LocalNumCXXBaseSpecifiers(0), CXXBaseSpecifiersOffsets(0),
+    LocalNumCXXCtorInitializers(0), CXXCtorInitializersOffsets(0),
     FileSortedDecls(0), NumFileSortedDecls(0),
     RedeclarationsMap(0), LocalNumRedeclarationsInMap(0),
-    ObjCCategoriesMap(0), LocalNumObjCCategoriesInMap(0),
+    RedeclarationChains(0),
+    ObjCCategoriesMap(0), LocalNumObjCCategoriesInMap(0), ObjCCategories(0),
     LocalNumTypes(0), TypeOffsets(0), BaseTypeIndex(0)
 {}
 
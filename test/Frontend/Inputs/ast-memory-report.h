@@ -0,0 +1,6 @@
+struct Point {
+  int X, Y;
+  int sum() const { return X + Y; }
+};
+
+typedef Point *PointPtr;
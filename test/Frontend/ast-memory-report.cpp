@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fast-memory-report=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: not %clang_cc1 -fsyntax-only -fast-memory-report=%t.dir/nonexistent/report.json %s 2>&1 | FileCheck %s -check-prefix=ERR
+
+#include "ast-memory-report.h"
+
+int distance(PointPtr P) {
+  return P->sum();
+}
+
+// CHECK: {"total":{{[1-9][0-9]*}},"categories":{"types":{{[1-9][0-9]*}},"decls":{{[1-9][0-9]*}},"stmts":{{[1-9][0-9]*}},"decl-context-maps":{{[0-9]+}},"apvalues":{{[0-9]+}},"definition-data":{{[1-9][0-9]*}},"other-ast":{{[0-9]+}},"ast-side-tables":{{[0-9]+}},"sema-tables":{{[0-9]+}},"ast-reader-buffers":0},"files":[
+// CHECK-DAG: {"file":"{{.*}}ast-memory-report.h","total":{{[1-9][0-9]*}},"categories":{"types":{{[1-9][0-9]*}},"decls":{{[1-9][0-9]*}},"stmts":{{[1-9][0-9]*}},"decl-context-maps":{{[0-9]+}},"apvalues":0,"definition-data":{{[1-9][0-9]*}},
+// CHECK-DAG: {"file":"{{.*}}ast-memory-report.cpp","total":{{[1-9][0-9]*}},"categories":{"types":{{[0-9]+}},"decls":{{[1-9][0-9]*}},"stmts":{{[1-9][0-9]*}},
+// CHECK: ]}
+
+// ERR: unable to open output file
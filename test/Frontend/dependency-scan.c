@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -dependency-scan -I %S/Inputs -dependency-file - -MT dependency-scan.o %s | FileCheck -check-prefix=MAKE %s
+// RUN: %clang_cc1 -dependency-scan -I %S/Inputs -dependency-file - -MT dependency-scan.o -dependency-format=json %s | FileCheck -check-prefix=JSON %s
+// RUN: not %clang_cc1 -dependency-scan -dependency-file - -dependency-format=ninja %s 2>&1 | FileCheck -check-prefix=BAD-FORMAT %s
+
+// MAKE: dependency-scan.o:
+// MAKE: dependency-scan.c
+// MAKE: Inputs{{[/\\]}}test.h
+// MAKE-NOT: missing.h
+
+// JSON: "targets": ["dependency-scan.o"]
+// JSON: "dependencies": [
+// JSON: dependency-scan.c"
+// JSON: Inputs{{[/\\\\]+}}test.h"
+// JSON-NOT: missing.h
+
+// BAD-FORMAT: invalid value 'ninja' in '-dependency-format=ninja'
+
+#define HEADER "test.h"
+#include HEADER
+
+#if 0
+#include "missing.h"
+#endif
+
+// Text outside of directives is not expanded, nor does it need to parse.
+HEADER this is not C @
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -ftime-trace=%t.json -ftime-trace-summary=3 %s 2>&1 | FileCheck %s -check-prefix=SUMMARY
+// RUN: FileCheck %s < %t.json
+// RUN: not grep '"tid":0,.*"name":"Source"' %t.json
+// RUN: not grep '"tid":1,.*"name":"ParseTopLevelDecl"' %t.json
+
+// The parser lexes the token after a declaration before the declaration's
+// event ends, so the header below is entered while that event is open. The
+// header's event is recorded on its own track and must not end in its place.
+
+int before_header;
+#include "time-trace.h"
+int after_header = Box<int>().get();
+
+// SUMMARY: *** Time Trace Summary:
+// SUMMARY-DAG: ParseTopLevelDecl
+// SUMMARY-DAG: Source
+
+// CHECK: "traceEvents"
+// CHECK-DAG: {"ph":"M","pid":1,"tid":1,"name":"thread_name","args":{"name":"Source"}}
+// CHECK-DAG: {"ph":"X","pid":1,"tid":1,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"name":"Source","args":{"detail":"{{.*}}time-trace.h",
+// CHECK-DAG: {"ph":"X","pid":1,"tid":0,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"name":"ParseTopLevelDecl",
+// CHECK-DAG: {"ph":"X","pid":1,"tid":0,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"name":"ExecuteAction",
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -x c++-header -emit-pch -o %t.pch %S/Inputs/time-trace.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.pch -emit-llvm -o - -ftime-trace=%t.json %s
+// RUN: FileCheck %s < %t.json
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.pch -emit-llvm -o - -ftime-trace=%t.coarse.json -ftime-trace-granularity=100000000 %s
+// RUN: FileCheck %s -check-prefix=COARSE < %t.coarse.json
+
+int answer(int x) {
+  Box<int> B = { x };
+  return B.get();
+}
+
+// CHECK: "traceEvents"
+// CHECK-DAG: "name":"ExecuteAction","args":{"detail":"{{.*}}time-trace-phases.cpp",
+// CHECK-DAG: "name":"ReadAST","args":{"detail":"{{.*}}.pch",
+// CHECK-DAG: "name":"DeserializeDecl","args":{"detail":"Box",
+// CHECK-DAG: "name":"ParseTopLevelDecl","args":{"detail":"answer","location":"{{.*}}time-trace-phases.cpp:7:1",
+// CHECK-DAG: "name":"InstantiateClass","args":{"detail":"Box<int>","location":"{{.*}}time-trace-phases.cpp:8:
+// CHECK-DAG: "name":"EmitTopLevelDecl","args":{"detail":"answer","location":"{{.*}}time-trace-phases.cpp:7:5",
+// CHECK-DAG: "name":"EmitDeferred",
+// CHECK-DAG: "name":"EmitDeferredDecl","args":{"detail":"Box<int>::get","location":"{{.*}}time-trace.h:3:5",
+// CHECK-DAG: "name":"Backend",
+
+// COARSE: "traceEvents"
+// COARSE-NOT: "ph":"X"
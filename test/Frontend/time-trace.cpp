@@ -0,0 +1,35 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -ftime-trace=%t.json -ftime-trace-summary=3 %s 2>&1 | FileCheck %s
+// RUN: FileCheck %s -check-prefix=JSON < %t.json
+// RUN: not %clang_cc1 -fsyntax-only -ftime-trace=%t.dir/nonexistent/trace.json %s 2>&1 | FileCheck %s -check-prefix=ERR
+
+#include "time-trace.h"
+
+template<int N> struct Fib {
+  static const int Value = Fib<N - 1>::Value + Fib<N - 2>::Value;
+};
+template<> struct Fib<1> { static const int Value = 1; };
+template<> struct Fib<0> { static const int Value = 0; };
+
+template<typename T> T twice(T t) { return t + t; }
+
+int main() {
+  Box<int> B = { Fib<10>::Value };
+  return twice(B.get());
+}
+
+// CHECK: *** Time Trace Summary:
+// CHECK-DAG: InstantiateClass
+// CHECK-DAG: InstantiateFunction
+// CHECK-DAG: PerformPendingInstantiations
+// CHECK-DAG: Source
+// CHECK: *** Top 3 Events:
+
+// JSON: "traceEvents"
+// JSON-DAG: "name":"Source","args":{"detail":"{{.*}}time-trace.h",
+// JSON-DAG: "name":"InstantiateClass","args":{"detail":"Fib<10>",
+// JSON-DAG: "name":"InstantiateClass","args":{"detail":"Box<int>",
+// JSON-DAG: "name":"DeduceTemplateArguments","args":{"detail":"twice<int>",
+// JSON-DAG: "name":"InstantiateFunction","args":{"detail":"twice<int>",
+// JSON-DAG: "name":"PerformPendingInstantiations","args":{"bytes":
+
+// ERR: unable to open output file
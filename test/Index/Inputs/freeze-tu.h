@@ -0,0 +1,8 @@
+struct Base {
+  int a;
+  double b;
+};
+
+template<typename T> struct Holder {
+  T value;
+};
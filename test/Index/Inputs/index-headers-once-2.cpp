@@ -0,0 +1,6 @@
+#include "index-headers-once.h"
+
+void second_func() {
+  shared_func(1);
+  shared_tmpl('a');
+}
@@ -0,0 +1,12 @@
+#ifndef INDEX_HEADERS_ONCE_H
+#define INDEX_HEADERS_ONCE_H
+
+void shared_func(int x);
+
+struct SharedStruct {
+  int field;
+};
+
+template <typename T> T shared_tmpl(T t) { return t; }
+
+#endif
@@ -0,0 +1,16 @@
+// Test that a translation unit built on a PCH can be frozen, and that the
+// cursors and types are the same afterwards.
+
+// RUN: c-index-test -write-pch %t.pch -x c++-header %S/Inputs/freeze-tu.h -target x86_64-pc-linux-gnu
+// RUN: env CINDEXTEST_FREEZE=1 c-index-test -test-print-type-size %s -include-pch %t.pch -target x86_64-pc-linux-gnu | FileCheck %s
+
+// Once frozen, the TU can be traversed and queried from several threads at
+// once; they must all see the same cursors, types, USRs and linkage.
+// RUN: env CINDEXTEST_FREEZE=1 CINDEXTEST_FREEZE_THREADS=4 c-index-test -test-print-type-size %s -include-pch %t.pch -target x86_64-pc-linux-gnu | FileCheck -check-prefix=THREADS -check-prefix=CHECK %s
+// THREADS: // Frozen translation unit visited concurrently
+
+// CHECK: StructDecl=Derived:[[@LINE+1]]:8 (Definition) [type=Derived] [typekind=Record] [sizeof=24] [alignof=8]
+struct Derived : Base {
+// CHECK: FieldDecl=c:[[@LINE+1]]:16 (Definition) [type=Holder<char>] [typekind=Unexposed] [sizeof=1] [alignof=1] [offsetof=128]
+  Holder<char> c;
+};
@@ -0,0 +1,47 @@
+// XFAIL: mingw32,win32
+#include "index-headers-once.h"
+
+void first_func(SharedStruct s) {
+  shared_func(s.field);
+  shared_tmpl(0);
+}
+
+// RUN: env CINDEXTEST_INDEX_HEADERS_ONCE=1 c-index-test -index-files %s %S/Inputs/index-headers-once-2.cpp -- -I%S/Inputs > %t
+// RUN: FileCheck %s -input-file=%t
+// RUN: c-index-test -index-files %s %S/Inputs/index-headers-once-2.cpp -- -I%S/Inputs | FileCheck %s -check-prefix=NO-ONCE
+
+// Implicit instantiations are indexed by every translation unit that makes
+// them, even when another one claimed the template's header.
+// RUN: env CINDEXTEST_INDEX_HEADERS_ONCE=1 CINDEXTEST_INDEXIMPLICITTEMPLATEINSTANTIATIONS=1 c-index-test -index-files %s %S/Inputs/index-headers-once-2.cpp -- -I%S/Inputs | FileCheck %s -check-prefix=IMPLICIT
+
+// On several threads, either translation unit may claim the header first,
+// but only one of them indexes its declarations.
+// RUN: env CINDEXTEST_INDEX_HEADERS_ONCE=1 CINDEXTEST_INDEX_THREADS=4 c-index-test -index-files %s %S/Inputs/index-headers-once-2.cpp %s %S/Inputs/index-headers-once-2.cpp -- -I%S/Inputs > %t.threads
+// RUN: FileCheck %s -check-prefix=THREADS -input-file=%t.threads
+// RUN: grep -c "kind: function | name: shared_func | .*index-headers-once.h:4:6" %t.threads | FileCheck %s -check-prefix=THREADS-ONCE
+
+// CHECK: [enteredMainFile]: {{.*}}index-headers-once.cpp
+// CHECK: [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}index-headers-once.h:4:6
+// CHECK: [indexDeclaration]: kind: struct | name: SharedStruct | {{.*}} | loc: {{.*}}index-headers-once.h:6:8
+// CHECK: [indexDeclaration]: kind: function | name: first_func | {{.*}} | loc: 4:6
+// CHECK: [enteredMainFile]: {{.*}}index-headers-once-2.cpp
+// CHECK: [ppIncludedFile]: {{.*}}index-headers-once.h
+// CHECK-NOT: [indexDeclaration]: kind: function | name: shared_func
+// CHECK-NOT: [indexDeclaration]: kind: struct | name: SharedStruct
+// CHECK: [indexDeclaration]: kind: function | name: second_func
+// CHECK: [indexEntityReference]: kind: function | name: shared_func | {{.*}} | loc: 4:3
+
+// THREADS-DAG: [indexDeclaration]: kind: function | name: first_func
+// THREADS-DAG: [indexDeclaration]: kind: function | name: second_func
+// THREADS-DAG: [indexDeclaration]: kind: struct | name: SharedStruct | {{.*}} | loc: {{.*}}index-headers-once.h:6:8
+// THREADS-ONCE: {{^1$}}
+
+// IMPLICIT: [enteredMainFile]: {{.*}}index-headers-once.cpp
+// IMPLICIT: [indexDeclaration]: kind: function-template | name: shared_tmpl | {{.*}} | loc: {{.*}}index-headers-once.h:10:25
+// IMPLICIT: [indexDeclaration]: kind: function-template-spec | name: shared_tmpl | {{.*}} | loc: {{.*}}index-headers-once.h:10:25
+// IMPLICIT: [enteredMainFile]: {{.*}}index-headers-once-2.cpp
+// IMPLICIT-NOT: kind: function-template | name: shared_tmpl
+// IMPLICIT: [indexDeclaration]: kind: function-template-spec | name: shared_tmpl | {{.*}} | loc: {{.*}}index-headers-once.h:10:25
+
+// NO-ONCE: [enteredMainFile]: {{.*}}index-headers-once-2.cpp
+// NO-ONCE: [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}index-headers-once.h:4:6
@@ -0,0 +1,20 @@
+struct Bar {
+  void method();
+};
+
+void foo(int x);
+
+void test(Bar b) {
+  foo(0);
+  b.method();
+}
+
+// The hashes are stable, so they can be checked here.
+// RUN: env CINDEXTEST_USR_HASH=1 c-index-test -index-file %s | FileCheck %s
+// CHECK-NOT: cursor USR hash
+// CHECK: [indexDeclaration]: kind: struct | name: Bar | USR: c:@S@Bar | USR hash: bad7fda960e3d62e597d622ca6955a7a |
+// CHECK: [indexDeclaration]: kind: c++-instance-method | name: method | USR: c:@S@Bar@F@method# | USR hash: 1b544737388f56f92ea6b14ed1f54271 |
+// CHECK: [indexDeclaration]: kind: function | name: foo | USR: c:@F@foo#I# | USR hash: f6b3c5b65911e399cbbccfdbefb2519d |
+// CHECK: [indexEntityReference]: kind: function | name: foo | USR: c:@F@foo#I# | USR hash: f6b3c5b65911e399cbbccfdbefb2519d |
+// CHECK: [indexEntityReference]: kind: c++-instance-method | name: method | USR: c:@S@Bar@F@method# | USR hash: 1b544737388f56f92ea6b14ed1f54271 |
+// CHECK-NOT: cursor USR hash
@@ -0,0 +1,14 @@
+// The per-process cache of validated AST files must not hide an input file
+// of a PCH that an unsaved buffer overrides on a later parse.
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'int from_header(void);' > %t/header.h
+// RUN: echo 'int from_unsaved_header(void);' > %t/unsaved.h
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t/header.pch %t/header.h
+// RUN: c-index-test -test-load-source-reparse 1 local "-remap-file=%t/header.h,%t/unsaved.h" %s -include-pch %t/header.pch -fvalidate-ast-inputs-once-per-process 2>&1 | FileCheck %s
+
+// CHECK: header.h' from the precompiled header has been overridden
+
+int main(void) {
+  return from_header();
+}
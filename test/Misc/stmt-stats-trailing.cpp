@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Only references whose name carries source information of its own, such as
+// an operator-function-id, pay for a DeclarationNameLoc after the node.
+
+struct S {
+  int m;
+  int operator+(int) const;
+};
+int operator-(const S &, const S &);
+
+int f(const S &s, int i) {
+  return s.m + s.operator+(i) + (s - s);
+}
+
+// CHECK: *** Stmt/Expr Stats:
+// CHECK-DAG: {{^    [0-9]+ DeclRefExpr, 32 each \([0-9]+ bytes \+ 8 bytes trailing/out-of-line\)$}}
+// CHECK-DAG: {{^    2 MemberExpr, 40 each \(80 bytes \+ 8 bytes trailing/out-of-line\)$}}
+// CHECK-DAG: {{^    1 CXXMemberCallExpr, [0-9]+ each \([0-9]+ bytes \+ 16 bytes trailing/out-of-line\)$}}
+// CHECK-DAG: {{^    1 CXXOperatorCallExpr, [0-9]+ each \([0-9]+ bytes \+ 24 bytes trailing/out-of-line\)$}}
+// CHECK-DAG: {{^    [0-9]+ ReturnStmt, [0-9]+ each \([0-9]+ bytes\)$}}
+// CHECK: Total bytes =
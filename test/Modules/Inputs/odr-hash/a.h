@@ -0,0 +1,5 @@
+#include "common.h"
+
+inline int fromA() {
+  return Point().getX();
+}
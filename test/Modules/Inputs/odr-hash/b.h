@@ -0,0 +1,5 @@
+#include "common.h"
+
+inline int fromB() {
+  return Point().y;
+}
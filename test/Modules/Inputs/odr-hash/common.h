@@ -0,0 +1,5 @@
+struct Point {
+  Point() : x(0), y(0) {}
+  int getX() const { return x; }
+  int x, y;
+};
@@ -0,0 +1,4 @@
+#ifndef LEAF_H
+#define LEAF_H
+typedef long leaf_t;
+#endif
@@ -0,0 +1,2 @@
+#include "leaf.h"
+leaf_t mid(void);
@@ -0,0 +1,2 @@
+#include "base.h"
+base_t right(void);
@@ -0,0 +1,4 @@
+#include "left.h"
+#include "right.h"
+#include "mid.h"
+static inline base_t top(void) { return left() + right() + (base_t)mid(); }
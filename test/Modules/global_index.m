@@ -13,6 +13,7 @@
 @import Module;
 
 // CHECK: *** Global Module Index Statistics:
+// CHECK: identifier lookups answered by the Bloom filter
 
 int *get_sub() {
   return Module_Sub;
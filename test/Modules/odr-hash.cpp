@@ -0,0 +1,13 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -x objective-c++ -fmodules -fmodules-cache-path=%t -I %S/Inputs/odr-hash %s -verify -print-stats 2>&1 | FileCheck %s
+
+// Both modules contain their own copy of the definition of Point. The copies
+// have the same content hash, so they are merged without checking members.
+// CHECK: 1/1 merged class definitions matched by hash
+
+@import a;
+@import b;
+
+int x = fromA() + fromB();
+
+// expected-no-diagnostics
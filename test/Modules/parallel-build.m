@@ -0,0 +1,38 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fdisable-module-hash -fmodules-cache-path=%t -fmodules-build-jobs=4 -I %S/Inputs/parallel-build -fsyntax-only -verify %s
+// RUN: ls -1tr %t | FileCheck %s
+// RUN: ls -1tr %t | FileCheck %s -check-prefix=INCLUDE
+
+// Building Top must have built everything its module map depends on, each
+// module after the modules it uses. Left and Right may be built in either
+// order.
+// CHECK: Base.pcm
+// CHECK-DAG: Left.pcm
+// CHECK-DAG: Right.pcm
+// CHECK: Top.pcm
+
+// Mid and Top depend on the modules whose headers theirs include, even
+// though their module maps don't name them.
+// INCLUDE: Leaf.pcm
+// INCLUDE: Mid.pcm
+// INCLUDE: Top.pcm
+
+// Module files that already exist are reused, and each of the modules built
+// ahead of time can be imported on its own.
+// RUN: %clang_cc1 -fmodules -fdisable-module-hash -fmodules-cache-path=%t -fmodules-build-jobs=4 -I %S/Inputs/parallel-build -fsyntax-only -verify %s
+// RUN: %clang_cc1 -fmodules -fdisable-module-hash -fmodules-cache-path=%t -I %S/Inputs/parallel-build -fsyntax-only -verify -DIMPORT_EACH %s
+
+// expected-no-diagnostics
+
+#ifdef IMPORT_EACH
+@import Base;
+@import Left;
+@import Right;
+@import Mid;
+
+base_t use_left_right(void) { return left() + right() + (base_t)mid(); }
+#else
+@import Top;
+
+base_t use_top(void) { return top(); }
+#endif
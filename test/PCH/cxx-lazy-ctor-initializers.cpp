@@ -0,0 +1,32 @@
+// Test that constructor initializers and function bodies from a PCH are only
+// deserialized when they are needed.
+
+// RUN: %clang_cc1 -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: lazy function bodies read
+// CHECK: 1/2 constructor initializer lists read
+
+#ifndef HEADER
+#define HEADER
+
+struct Used {
+  constexpr Used(int x) : Value(x) { }
+  int Value;
+};
+
+struct Unused {
+  Unused(int x) : Value(x), Other(x * 2) { }
+  int Value;
+  int Other;
+};
+
+inline int unused_function(int x) { return x + 1; }
+
+#else
+
+// expected-no-diagnostics
+
+static_assert(Used(3).Value == 3, "constructor initializers were not loaded");
+
+#endif
@@ -0,0 +1,23 @@
+// Test that identifiers that are not in the PCH don't probe its identifier
+// table.
+
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: identifier table lookups avoided by Bloom filters
+
+#ifndef HEADER
+#define HEADER
+
+int pch_function(int pch_param);
+
+#else
+
+// expected-no-diagnostics
+
+int main_only_function(int main_only_param) {
+  int main_only_local = pch_function(main_only_param);
+  return main_only_local;
+}
+
+#endif
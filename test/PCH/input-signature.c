@@ -0,0 +1,20 @@
+// Test that a matching input signature lets the reader skip checking the
+// input files of a PCH, and that a changed signature falls back to them.
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'int from_header(void);' > %t/header.h
+// RUN: echo 'first' > %t/signature
+// RUN: %clang_cc1 -emit-pch -finput-signature-file=%t/signature -o %t/header.pch %t/header.h
+
+// RUN: %clang_cc1 -include-pch %t/header.pch -finput-signature-file=%t/signature -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s
+// CHECK: 1 AST files validated by input signature
+
+// RUN: echo 'second' > %t/signature
+// RUN: %clang_cc1 -include-pch %t/header.pch -finput-signature-file=%t/signature -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck -check-prefix=CHANGED %s
+// CHANGED-NOT: validated by input signature
+
+// expected-no-diagnostics
+
+int main(void) {
+  return from_header();
+}
@@ -0,0 +1,36 @@
+// Without -fpch-instantiate-templates, every file using the PCH instantiates
+// the templates the PCH needs.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -o %t.1 %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.1 -emit-llvm -o - %s 2>&1 | FileCheck %s -check-prefix=TU
+
+// With it, they are instantiated once, while building the PCH.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -fpch-instantiate-templates -o %t.2 %s 2>&1 | FileCheck %s -check-prefix=PCH
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.2 -emit-llvm -o - %s 2>&1 | FileCheck %s -check-prefix=PCH-TU
+
+#ifndef HEADER
+#define HEADER
+
+template<typename T> int shift(T t) { return t << 40; }
+inline int useShift() { return shift(1); }
+
+// Defined only after the PCH; instantiated by the file using it either way.
+template<typename T> T later(T t);
+inline int useLater() { return later(1); }
+
+#else
+
+template<typename T> T later(T t) { return t + 1; }
+
+int main() { return useShift() + useLater(); }
+
+#endif
+
+// TU: warning: shift count >= width of type
+// TU-DAG: define linkonce_odr i32 @_Z5shiftIiEiT_
+// TU-DAG: define linkonce_odr i32 @_Z5laterIiET_S0_
+
+// PCH: warning: shift count >= width of type
+
+// PCH-TU-NOT: warning
+// PCH-TU-DAG: define linkonce_odr i32 @_Z5shiftIiEiT_
+// PCH-TU-DAG: define linkonce_odr i32 @_Z5laterIiET_S0_
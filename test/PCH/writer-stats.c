@@ -0,0 +1,12 @@
+// Test that -print-stats reports how the bytes of an emitted PCH are spread
+// across its blocks.
+
+// RUN: %clang_cc1 -emit-pch -print-stats -o %t %S/Inputs/typo.h 2>&1 | FileCheck %s
+
+// CHECK: *** AST File Writer Statistics:
+// CHECK-NEXT: bytes written
+// CHECK: bytes ({{.*}}%) in control block
+// CHECK: bytes ({{.*}}%) in declarations and types
+// CHECK: bytes ({{.*}}%) in source manager block
+// CHECK: bytes ({{.*}}%) in identifier table
+// CHECK: bytes ({{.*}}%) in other records
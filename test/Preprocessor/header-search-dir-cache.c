@@ -0,0 +1,31 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b/sub
+// RUN: echo '#include_next <next.h>' > %t/a/next.h
+// RUN: echo 'int next_from_b;' > %t/b/next.h
+// RUN: echo 'int sub_header;' > %t/b/sub/header.h
+// Directories modified within the last second are never trusted to be
+// complete; backdate them so that the listings are used.
+// RUN: touch -t 200001010000 %t/a %t/b %t/b/sub
+// RUN: %clang_cc1 -fheader-search-dir-cache -E -I %t/a -I %t/b %s | FileCheck %s
+// RUN: %clang_cc1 -fheader-search-dir-cache -fsyntax-only -print-stats -I %t/a -I %t/b %s 2>&1 | FileCheck -check-prefix=STATS %s
+// RUN: %clang -fheader-search-dir-cache -### -fsyntax-only %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+
+// DRIVER: -fheader-search-dir-cache
+// STATS: {{[1-9][0-9]*}} directory listings read, {{[1-9][0-9]*}} misses answered from listings.
+
+#include <next.h>
+// CHECK: int next_from_b;
+
+#include <sub/header.h>
+// CHECK: int sub_header;
+
+#if __has_include(<missing.h>) || __has_include(<sub/missing.h>) || \
+    __has_include(<nodir/missing.h>) || __has_include(<sub/../missing.h>)
+#error "found a header that does not exist"
+#endif
+
+#if __has_include(<sub/../next.h>) && __has_include(<SUB/../sub/header.h>) == \
+    __has_include(<SUB/header.h>)
+int relative_ok;
+// CHECK: int relative_ok;
+#endif
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/first/sys %t/second/sys
+// RUN: echo 'int first_config;' > %t/first/config.h
+// RUN: echo 'int second_config;' > %t/second/config.h
+// RUN: echo 'int sys_types;' > %t/second/sys/types.h
+// RUN: clang-hmap -o %t/classic.hmap %t/first %t/second
+// RUN: clang-hmap -perfect-hash -o %t/perfect.hmap %t/first %t/second
+// RUN: %clang_cc1 -E %s -I %t/classic.hmap | FileCheck %s
+// RUN: %clang_cc1 -E %s -I %t/perfect.hmap | FileCheck %s
+// RUN: clang-hmap -dump %t/perfect.hmap 2>&1 | FileCheck -check-prefix=DUMP %s
+
+// CHECK: int first_config;
+// CHECK: int sys_types;
+// CHECK: int not_found;
+
+// DUMP: 2 entries
+// DUMP-DAG: config.h -> '{{.*}}first{{/|\\\\}}' 'config.h'
+// DUMP-DAG: sys/types.h -> '{{.*}}sys{{/|\\\\}}' 'types.h'
+
+#include "config.h"
+#include <SYS/TYPES.H>
+#if !__has_include("missing.h")
+int not_found;
+#endif
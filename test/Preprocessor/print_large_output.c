@@ -0,0 +1,35 @@
+// The -E output is far larger than the output buffer. It must be the same
+// whether it goes to a file or to a pipe, and keep tokens, pragmas and line
+// markers in order across buffer flushes.
+// RUN: %clang_cc1 -E -I %S/Inputs %s -o %t.file
+// RUN: %clang_cc1 -E -I %S/Inputs %s > %t.pipe
+// RUN: diff %t.file %t.pipe
+// RUN: FileCheck %s < %t.file
+// RUN: %clang_cc1 -E -P -I %S/Inputs %s > %t.noline
+// RUN: FileCheck %s -check-prefix=NOLINE < %t.noline
+
+#define T10 tok tok tok tok tok tok tok tok tok tok
+#define T100 T10 T10 T10 T10 T10 T10 T10 T10 T10 T10
+#define T1K T100 T100 T100 T100 T100 T100 T100 T100 T100 T100
+#define T10K T1K T1K T1K T1K T1K T1K T1K T1K T1K T1K
+#define T100K T10K T10K T10K T10K T10K T10K T10K T10K T10K T10K
+
+first T100K first_end
+#pragma unknown_pragma after_first
+#include "print-large-output.h"
+second T100K second_end
+int last_line;
+
+// CHECK: {{^}}first tok tok {{.*}} tok first_end{{$}}
+// CHECK: #pragma unknown_pragma after_first
+// CHECK: # 1 "{{.*}}print-large-output.h" 1
+// CHECK: int in_header;
+// CHECK: # {{[0-9]+}} "{{.*}}print_large_output.c" 2
+// CHECK: {{^}}second tok tok {{.*}} tok second_end{{$}}
+// CHECK: int last_line;
+
+// NOLINE: {{^}}first tok tok {{.*}} tok first_end{{$}}
+// NOLINE: #pragma unknown_pragma after_first
+// NOLINE: int in_header;
+// NOLINE: {{^}}second tok tok {{.*}} tok second_end{{$}}
+// NOLINE: int last_line;
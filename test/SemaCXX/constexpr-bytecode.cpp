@@ -0,0 +1,101 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify -fexperimental-constexpr-bytecode %s
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify -fexperimental-constexpr-bytecode -fno-constexpr-call-cache %s
+// RUN: not %clang_cc1 -std=c++1y -fsyntax-only -fexperimental-constexpr-bytecode -print-stats %s 2>&1 | FileCheck %s
+
+// Everything here is checked by both the AST evaluator and the bytecode
+// interpreter, which must agree on values and, by handing the call back to
+// the AST evaluator, on diagnostics.
+
+constexpr unsigned long long sum(unsigned n) {
+  unsigned long long r = 0;
+  for (unsigned i = 1; i <= n; ++i)
+    r += i;
+  return r;
+}
+static_assert(sum(100000) == 5000050000ULL, "");
+
+constexpr bool isPrime(int n) {
+  if (n < 2)
+    return false;
+  for (int d = 2; d * d <= n; ++d)
+    if (n % d == 0)
+      return false;
+  return true;
+}
+constexpr int countPrimes(int n) {
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    if (!isPrime(i))
+      continue;
+    ++count;
+  }
+  return count;
+}
+static_assert(countPrimes(1000) == 168, "");
+
+constexpr int collatz(long long n) {
+  int steps = 0;
+  while (n != 1) {
+    n = n % 2 ? 3 * n + 1 : n / 2;
+    steps++;
+  }
+  return steps;
+}
+static_assert(collatz(27) == 111, "");
+
+constexpr int firstBit(unsigned v) {
+  int i = 0;
+  do {
+    if (v & 1)
+      break;
+    v >>= 1;
+  } while (++i < 32);
+  return i;
+}
+static_assert(firstBit(0x80) == 7, "");
+static_assert(firstBit(0) == 32, "");
+
+// Conversions and unsigned arithmetic wrap.
+constexpr unsigned char wrapChar(int n) {
+  unsigned char c = 250;
+  c += n;
+  return c;
+}
+static_assert(wrapChar(10) == 4, "");
+constexpr short narrow(int n) { return n; }
+static_assert(narrow(0x18000) == -0x8000, "");
+constexpr unsigned negate(unsigned n) { return -n; }
+static_assert(negate(1) == 0xffffffffu, "");
+constexpr long long mulWide(long long a, long long b) { return a * b; }
+static_assert(mulWide(3037000499LL, 3037000499LL) == 9223372030926249001LL, "");
+
+enum E { A = 1, B = 2 };
+enum class Scoped : char { X = 'x' };
+constexpr int enums(E e, Scoped s) { return e + B + (int)s; }
+static_assert(enums(A, Scoped::X) == 3 + 'x', "");
+
+constexpr bool logic(int a, int b) { return (a && b) || !a; }
+static_assert(logic(1, 2) && !logic(1, 0) && logic(0, 0), "");
+
+template<int N> constexpr int scaled(int x, int y = N) { return x * y; }
+static_assert(scaled<3>(4) == 12, "");
+
+// Diagnostics.
+constexpr int power(int n) {
+  int r = 1;
+  while (n--)
+    r *= 10; // expected-note {{value 10000000000 is outside the range of representable values of type 'int'}}
+  return r;
+}
+static_assert(power(9) == 1000000000, "");
+static_assert(power(10), ""); // expected-error {{constant expression}} expected-note {{in call to 'power(10)'}}
+
+constexpr int divide(int a, int b) { return a / b; } // expected-note {{division by zero}}
+static_assert(divide(1, 0), ""); // expected-error {{constant expression}} expected-note {{in call to 'divide(1, 0)'}}
+
+constexpr int shift(int a, int b) { return a << b; } // expected-note {{left shift of negative value -8}}
+static_assert(shift(1, 30) == 0x40000000, "");
+static_assert(shift(-8, 1), ""); // expected-error {{constant expression}} expected-note {{in call to 'shift(-8, 1)'}}
+
+// CHECK: {{[1-9][0-9]*}}/{{[0-9]+}} constexpr calls evaluated by the bytecode interpreter ({{[1-9][0-9]*}}/{{[0-9]+}} functions compiled)
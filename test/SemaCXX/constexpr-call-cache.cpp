@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -std=c++11 -fsyntax-only -fno-constexpr-call-cache %s 2>&1 | FileCheck %s -check-prefix=NO-CACHE
+// expected-no-diagnostics
+
+// Without memoization this takes an exponential number of steps.
+constexpr unsigned long long fib(unsigned n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(60) == 1548008755920ULL, "");
+static_assert(fib(61) == 2504730781961ULL, "");
+
+// Aggregate arguments and results.
+struct Pair { int a, b; };
+constexpr Pair swap(Pair p) { return Pair{p.b, p.a}; }
+static_assert(swap(Pair{1, 2}).a == 2, "");
+static_assert(swap(Pair{3, 4}).a == 4, "");
+static_assert(swap(Pair{1, 2}).b == 1, "");
+
+// Calls taking references depend on the objects they refer to.
+constexpr int deref(const int &r) { return r; }
+constexpr int g1 = 1, g2 = 2;
+static_assert(deref(g1) == 1, "");
+static_assert(deref(g2) == 2, "");
+
+// CHECK: {{[1-9][0-9]*}}/{{[0-9]+}} constexpr calls reused a memoized result
+
+// NO-CACHE: static_assert expression is not an integral constant expression
+// NO-CACHE: step limit
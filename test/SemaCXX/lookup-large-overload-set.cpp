@@ -0,0 +1,36 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// expected-no-diagnostics
+// RUN: %clang_cc1 -fsyntax-only -ast-dump -ast-dump-lookups -ast-dump-filter N %s | FileCheck %s
+
+// Overload sets long enough to index their lookup entries must still replace
+// each redeclared function, and function template, in place.
+
+template<int I> struct tag {};
+
+#define OVERLOADS(M) M(0) M(1) M(2) M(3) M(4) M(5) M(6) M(7) M(8) M(9) \
+                     M(10) M(11) M(12) M(13) M(14) M(15) M(16) M(17)
+
+namespace N {
+#define DECLARE_G(n) void g(tag<n>);
+#define DECLARE_H(n) template<typename T> void h(T, tag<n>);
+  OVERLOADS(DECLARE_G)
+  OVERLOADS(DECLARE_H)
+  OVERLOADS(DECLARE_G)
+  OVERLOADS(DECLARE_H)
+
+  void g(tag<3>) {}
+  template<typename T> void h(T, tag<5>) {}
+  void g(int);
+}
+
+void test() {
+  N::g(tag<3>());
+  N::g(tag<17>());
+  N::g(0);
+  N::h(0, tag<5>());
+}
+
+// The last declaration of each function is the only one in the table.
+// CHECK: DeclarationName 'g'
+// CHECK: 'void (tag<3>)'
+// CHECK-NOT: 'void (tag<3>)'
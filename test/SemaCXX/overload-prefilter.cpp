@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// Candidates rejected by arity, and argument conversions shared between
+// candidates, must be diagnosed exactly as before.
+
+struct Stream {};
+Stream &operator<<(Stream &, int);
+Stream &operator<<(Stream &, const char *);
+Stream &operator<<(Stream &, double);
+template<typename T> Stream &operator<<(Stream &, T *);
+
+void f(int, int); // expected-note {{candidate function not viable: requires 2 arguments, but 1 was provided}}
+template<typename T> void g(T, T, T); // expected-note {{candidate function template not viable: requires 3 arguments, but 1 was provided}}
+
+struct NotStreamable {};
+
+void test(Stream &s) {
+  s << 1;
+  f(1); // expected-error {{no matching function for call to 'f'}}
+  g(1); // expected-error {{no matching function for call to 'g'}}
+  s << NotStreamable(); // expected-error {{invalid operands to binary expression}}
+}
+// expected-note@8 {{candidate function not viable: no known conversion from 'NotStreamable' to 'int' for 2nd argument}}
+// expected-note@9 {{candidate function not viable: no known conversion from 'NotStreamable' to 'const char *' for 2nd argument}}
+// expected-note@10 {{candidate function not viable: no known conversion from 'NotStreamable' to 'double' for 2nd argument}}
+// expected-note@11 {{candidate template ignored: could not match 'T *' against 'NotStreamable'}}
+
+// CHECK: 2 overload candidates pruned by arity.
+// CHECK: 4 overload argument conversions reused.
@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c++11 -verify %s
+// RUN: not %clang_cc1 -fsyntax-only -std=c++11 -print-stats %s 2>&1 | FileCheck %s
+
+// Deduction failures replayed from the cache must be diagnosed exactly as
+// the first time.
+
+template<typename T> typename T::type h(T); // expected-note 2{{candidate template ignored: substitution failure [with T = int]}}
+void h(double *); // expected-note 2{{candidate function not viable: no known conversion from 'int' to 'double *' for 1st argument}}
+
+template<typename T> void k(T, T); // expected-note 2{{candidate template ignored: deduced conflicting types for parameter 'T' ('int' vs. 'char')}}
+
+void test(int i) {
+  h(i); // expected-error {{no matching function for call to 'h'}}
+  h(i); // expected-error {{no matching function for call to 'h'}}
+  k(i, 'c'); // expected-error {{no matching function for call to 'k'}}
+  k(i, 'c'); // expected-error {{no matching function for call to 'k'}}
+}
+
+// A declaration that makes a failed substitution succeed flushes the cache.
+template<typename T> auto call_g(T t) -> decltype(g(t)); // expected-note {{candidate template ignored: substitution failure [with T = N::A]}}
+
+namespace N { struct A {}; }
+
+void before(N::A a) {
+  call_g(a); // expected-error {{no matching function for call to 'call_g'}}
+}
+
+namespace N { void g(A); }
+
+void after(N::A a) {
+  call_g(a);
+}
+
+// CHECK: 2 template argument deduction failures reused.
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/include
+// RUN: echo '#include "b.h"' > %t/include/a.h
+// RUN: echo > %t/include/b.h
+// RUN: echo '#include "a.h"' > %t/one.cpp
+// RUN: echo '#include "b.h"' > %t/two.cpp
+// RUN: echo '[{"directory":"%t","command":"clang++ -c %t/one.cpp -I%t/include","file":"%t/one.cpp"},{"directory":"%t","command":"clang++ -c %t/two.cpp -I%t/include","file":"%t/two.cpp"}]' | sed -e 's/\\/\//g' > %t/compile_commands.json
+// RUN: clang-scan-deps -p "%t" "%t/one.cpp" "%t/two.cpp" | FileCheck -check-prefix=MAKE %s
+// RUN: clang-scan-deps -p "%t" -format=json "%t/one.cpp" "%t/two.cpp" | FileCheck -check-prefix=JSON %s
+
+// MAKE: one.o:
+// MAKE: one.cpp
+// MAKE: include{{[/\\]}}a.h
+// MAKE: include{{[/\\]}}b.h
+// MAKE: two.o:
+// MAKE: two.cpp
+// MAKE-NOT: a.h
+// MAKE: include{{[/\\]}}b.h
+
+// JSON: [
+// JSON-NEXT: {
+// JSON-NEXT: "targets": ["one.o"]
+// JSON: a.h"
+// JSON: b.h"
+// JSON: },
+// JSON-NEXT: {
+// JSON-NEXT: "targets": ["two.o"]
+// JSON-NOT: a.h"
+// JSON: b.h"
+// JSON: }
+// JSON-NEXT: ]
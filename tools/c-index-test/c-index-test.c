@@ -10,6 +10,10 @@
 #include <string.h>
 #include <assert.h>
 
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #ifdef CLANG_HAVE_LIBXML
 #include <libxml/parser.h>
 #include <libxml/relaxng.h>
@@ -1373,6 +1377,102 @@ static enum CXChildVisitResult PrintBitWidth(CXCursor cursor, CXCursor p,
   return CXChildVisit_Recurse;
 }
 
+/******************************************************************************/
+/* Concurrent traversal of frozen translation units.                          */
+/******************************************************************************/
+
+typedef struct {
+  CXTranslationUnit TU;
+  unsigned long Hash;
+} FrozenVisitData;
+
+static void hash_string(unsigned long *Hash, CXString Str) {
+  const char *S = clang_getCString(Str);
+  for (; S && *S; ++S)
+    *Hash = *Hash * 33 + (unsigned char)*S;
+  clang_disposeString(Str);
+}
+
+#if HAVE_PTHREAD_H
+static pthread_mutex_t FrozenLocationLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* Queries that may look up a source location must not run concurrently,
+   even on a frozen translation unit. */
+static void lock_frozen_locations(void) {
+#if HAVE_PTHREAD_H
+  pthread_mutex_lock(&FrozenLocationLock);
+#endif
+}
+
+static void unlock_frozen_locations(void) {
+#if HAVE_PTHREAD_H
+  pthread_mutex_unlock(&FrozenLocationLock);
+#endif
+}
+
+static enum CXChildVisitResult FrozenVisitor(CXCursor C, CXCursor Parent,
+                                             CXClientData ClientData) {
+  FrozenVisitData *Data = (FrozenVisitData *)ClientData;
+  CXType T = clang_getCursorType(C);
+  hash_string(&Data->Hash, clang_getCursorSpelling(C));
+  /* The USRs of local and anonymous declarations and the spelling of
+     anonymous types include their location. */
+  lock_frozen_locations();
+  hash_string(&Data->Hash, clang_getCursorUSR(C));
+  hash_string(&Data->Hash, clang_getTypeSpelling(T));
+  unlock_frozen_locations();
+  Data->Hash = Data->Hash * 33 + clang_getCursorLinkage(C);
+  Data->Hash = Data->Hash * 33 + (unsigned long)clang_Type_getSizeOf(T);
+  hash_string(&Data->Hash,
+              clang_getCursorSpelling(clang_getCursorReferenced(C)));
+  return CXChildVisit_Recurse;
+}
+
+static void *visit_frozen_tu(void *UserData) {
+  FrozenVisitData *Data = (FrozenVisitData *)UserData;
+  Data->Hash = 5381;
+  clang_visitChildren(clang_getTranslationUnitCursor(Data->TU), FrozenVisitor,
+                      Data);
+  return NULL;
+}
+
+/* Query every cursor of the frozen TU from NumThreads threads at once, and
+   check that they all see the same thing. */
+static int visit_frozen_tu_concurrently(CXTranslationUnit TU,
+                                        unsigned NumThreads) {
+#if HAVE_PTHREAD_H
+  FrozenVisitData Data[16];
+  pthread_t Threads[16];
+  unsigned I, NumStarted = 0;
+  int Result = 0;
+
+  if (NumThreads > 16)
+    NumThreads = 16;
+  for (I = 0; I != NumThreads; ++I) {
+    Data[I].TU = TU;
+    if (pthread_create(&Threads[I], NULL, visit_frozen_tu, &Data[I]) != 0)
+      break;
+    ++NumStarted;
+  }
+  for (I = 0; I != NumStarted; ++I)
+    pthread_join(Threads[I], NULL);
+
+  for (I = 1; I < NumStarted; ++I) {
+    if (Data[I].Hash != Data[0].Hash) {
+      fprintf(stderr, "Threads disagree about the frozen translation unit\n");
+      Result = 1;
+    }
+  }
+  if (!Result)
+    printf("// Frozen translation unit visited concurrently\n");
+  return Result;
+#else
+  printf("// Frozen translation unit visited concurrently\n");
+  return 0;
+#endif
+}
+
 /******************************************************************************/
 /* Loading ASTs/source.                                                       */
 /******************************************************************************/
@@ -1386,6 +1486,23 @@ static int perform_test_load(CXIndex Idx, CXTranslationUnit TU,
   if (prefix)
     FileCheckPrefix = prefix;
 
+  if (getenv("CINDEXTEST_FREEZE")) {
+    enum CXErrorCode Err = (enum CXErrorCode)clang_freezeTranslationUnit(TU);
+    const char *FreezeThreads = getenv("CINDEXTEST_FREEZE_THREADS");
+    if (Err != CXError_Success) {
+      fprintf(stderr, "Unable to freeze translation unit!\n");
+      describeLibclangFailure(Err);
+      clang_disposeTranslationUnit(TU);
+      return 1;
+    }
+
+    if (FreezeThreads &&
+        visit_frozen_tu_concurrently(TU, atoi(FreezeThreads))) {
+      clang_disposeTranslationUnit(TU);
+      return 1;
+    }
+  }
+
   if (Visitor) {
     enum CXCursorKind K = CXCursor_NotImplemented;
     enum CXCursorKind *ck = &K;
@@ -2702,6 +2819,16 @@ static void printEntityInfo(const char *cb,
          getEntityTemplateKindString(info->templateKind));
   printf(" | name: %s", name);
   printf(" | USR: %s", info->USR);
+  if (getenv("CINDEXTEST_USR_HASH")) {
+    CXUSRHash hash, cursorHash;
+    hash = clang_index_getEntityUSRHash(info);
+    cursorHash = clang_getCursorUSRHash(info->cursor);
+    printf(" | USR hash: %016llx%016llx", hash.data[1], hash.data[0]);
+    if (hash.data[0] != cursorHash.data[0] ||
+        hash.data[1] != cursorHash.data[1])
+      printf(" (cursor USR hash: %016llx%016llx)",
+             cursorHash.data[1], cursorHash.data[0]);
+  }
   printf(" | lang: %s", getEntityLanguageString(info->lang));
 
   for (i = 0; i != info->numAttributes; ++i) {
@@ -2965,6 +3092,88 @@ static IndexerCallbacks IndexCB = {
   index_indexEntityReference
 };
 
+#if HAVE_PTHREAD_H
+/* -index-files may index several translation units at once. Run one
+   callback at a time so that the lines they print are not interleaved. */
+static pthread_mutex_t IndexCBLock = PTHREAD_MUTEX_INITIALIZER;
+
+static int locked_abortQuery(CXClientData client_data, void *reserved) {
+  int result;
+  pthread_mutex_lock(&IndexCBLock);
+  result = index_abortQuery(client_data, reserved);
+  pthread_mutex_unlock(&IndexCBLock);
+  return result;
+}
+
+static void locked_diagnostic(CXClientData client_data,
+                              CXDiagnosticSet diagSet, void *reserved) {
+  pthread_mutex_lock(&IndexCBLock);
+  index_diagnostic(client_data, diagSet, reserved);
+  pthread_mutex_unlock(&IndexCBLock);
+}
+
+static CXIdxClientFile locked_enteredMainFile(CXClientData client_data,
+                                              CXFile file, void *reserved) {
+  CXIdxClientFile result;
+  pthread_mutex_lock(&IndexCBLock);
+  result = index_enteredMainFile(client_data, file, reserved);
+  pthread_mutex_unlock(&IndexCBLock);
+  return result;
+}
+
+static CXIdxClientFile locked_ppIncludedFile(CXClientData client_data,
+                                           const CXIdxIncludedFileInfo *info) {
+  CXIdxClientFile result;
+  pthread_mutex_lock(&IndexCBLock);
+  result = index_ppIncludedFile(client_data, info);
+  pthread_mutex_unlock(&IndexCBLock);
+  return result;
+}
+
+static CXIdxClientFile locked_importedASTFile(CXClientData client_data,
+                                        const CXIdxImportedASTFileInfo *info) {
+  CXIdxClientFile result;
+  pthread_mutex_lock(&IndexCBLock);
+  result = index_importedASTFile(client_data, info);
+  pthread_mutex_unlock(&IndexCBLock);
+  return result;
+}
+
+static CXIdxClientContainer locked_startedTranslationUnit(
+    CXClientData client_data, void *reserved) {
+  CXIdxClientContainer result;
+  pthread_mutex_lock(&IndexCBLock);
+  result = index_startedTranslationUnit(client_data, reserved);
+  pthread_mutex_unlock(&IndexCBLock);
+  return result;
+}
+
+static void locked_indexDeclaration(CXClientData client_data,
+                                    const CXIdxDeclInfo *info) {
+  pthread_mutex_lock(&IndexCBLock);
+  index_indexDeclaration(client_data, info);
+  pthread_mutex_unlock(&IndexCBLock);
+}
+
+static void locked_indexEntityReference(CXClientData client_data,
+                                        const CXIdxEntityRefInfo *info) {
+  pthread_mutex_lock(&IndexCBLock);
+  index_indexEntityReference(client_data, info);
+  pthread_mutex_unlock(&IndexCBLock);
+}
+
+static IndexerCallbacks LockedIndexCB = {
+  locked_abortQuery,
+  locked_diagnostic,
+  locked_enteredMainFile,
+  locked_ppIncludedFile,
+  locked_importedASTFile,
+  locked_startedTranslationUnit,
+  locked_indexDeclaration,
+  locked_indexEntityReference
+};
+#endif
+
 static unsigned getIndexOptions(void) {
   unsigned index_opts;
   index_opts = 0;
@@ -2972,8 +3181,12 @@ static unsigned getIndexOptions(void) {
     index_opts |= CXIndexOpt_SuppressRedundantRefs;
   if (getenv("CINDEXTEST_INDEXLOCALSYMBOLS"))
     index_opts |= CXIndexOpt_IndexFunctionLocalSymbols;
+  if (getenv("CINDEXTEST_INDEXIMPLICITTEMPLATEINSTANTIATIONS"))
+    index_opts |= CXIndexOpt_IndexImplicitTemplateInstantiations;
   if (!getenv("CINDEXTEST_DISABLE_SKIPPARSEDBODIES"))
     index_opts |= CXIndexOpt_SkipParsedBodiesInSession;
+  if (getenv("CINDEXTEST_INDEX_HEADERS_ONCE"))
+    index_opts |= CXIndexOpt_IndexHeadersOnceInSession;
 
   return index_opts;
 }
@@ -3118,6 +3331,79 @@ static int index_tu(int argc, const char **argv) {
   return result;
 }
 
+static int index_files(int argc, const char **argv) {
+  CXIndex Idx;
+  CXIndexAction idxAction;
+  CXIndexSourceFileJob *jobs;
+  IndexData *index_data;
+  IndexerCallbacks *callbacks;
+  const char **args;
+  unsigned num_jobs, num_threads, i;
+  int num_args;
+  int result;
+
+  num_jobs = 0;
+  while (num_jobs < (unsigned)argc && strcmp(argv[num_jobs], "--") != 0)
+    ++num_jobs;
+  if (num_jobs == 0 || num_jobs == (unsigned)argc) {
+    fprintf(stderr, "expected source files followed by '--'\n");
+    return -1;
+  }
+  args = argv + num_jobs + 1;
+  num_args = argc - num_jobs - 1;
+
+  num_threads = 1;
+  if (getenv("CINDEXTEST_INDEX_THREADS"))
+    num_threads = atoi(getenv("CINDEXTEST_INDEX_THREADS"));
+
+  if (!(Idx = clang_createIndex(/* excludeDeclsFromPCH */ 1,
+                                /* displayDiagnostics=*/1))) {
+    fprintf(stderr, "Could not create Index\n");
+    return 1;
+  }
+  idxAction = clang_IndexAction_create(Idx);
+
+  jobs = (CXIndexSourceFileJob *)malloc(num_jobs * sizeof(*jobs));
+  index_data = (IndexData *)malloc(num_jobs * sizeof(*index_data));
+  for (i = 0; i != num_jobs; ++i) {
+    index_data[i].check_prefix = 0;
+    index_data[i].first_check_printed = 0;
+    index_data[i].fail_for_error = 0;
+    index_data[i].abort = 0;
+    index_data[i].main_filename = "";
+    index_data[i].importedASTs = 0;
+
+    jobs[i].source_filename = argv[i];
+    jobs[i].command_line_args = args;
+    jobs[i].num_command_line_args = num_args;
+    jobs[i].client_data = &index_data[i];
+    jobs[i].result = 0;
+  }
+
+  callbacks = &IndexCB;
+#if HAVE_PTHREAD_H
+  if (num_threads > 1)
+    callbacks = &LockedIndexCB;
+#endif
+
+  result = clang_indexSourceFiles(idxAction, callbacks, sizeof(*callbacks),
+                                  getIndexOptions(), jobs, num_jobs, 0, 0,
+                                  num_threads);
+  if (result != CXError_Success)
+    describeLibclangFailure(result);
+
+  for (i = 0; i != num_jobs; ++i) {
+    if (index_data[i].fail_for_error)
+      result = -1;
+  }
+
+  free(index_data);
+  free(jobs);
+  clang_IndexAction_dispose(idxAction);
+  clang_disposeIndex(Idx);
+  return result;
+}
+
 static int index_compile_db(int argc, const char **argv) {
   const char *check_prefix;
   CXIndex Idx;
@@ -3912,6 +4198,7 @@ static void print_usage(void) {
     "       c-index-test -index-file-full [-check-prefix=<FileCheck prefix>] <compiler arguments>\n"
     "       c-index-test -index-tu [-check-prefix=<FileCheck prefix>] <AST file>\n"
     "       c-index-test -index-compile-db [-check-prefix=<FileCheck prefix>] <compilation database>\n"
+    "       c-index-test -index-files <source files> -- <compiler arguments>\n"
     "       c-index-test -test-file-scan <AST file> <source file> "
           "[FileCheck prefix]\n");
   fprintf(stderr,
@@ -3979,6 +4266,8 @@ int cindextest_main(int argc, const char **argv) {
     return index_file(argc - 2, argv + 2, /*full=*/1);
   if (argc > 2 && strcmp(argv[1], "-index-tu") == 0)
     return index_tu(argc - 2, argv + 2);
+  if (argc > 2 && strcmp(argv[1], "-index-files") == 0)
+    return index_files(argc - 2, argv + 2);
   if (argc > 2 && strcmp(argv[1], "-index-compile-db") == 0)
     return index_compile_db(argc - 2, argv + 2);
   else if (argc >= 4 && strncmp(argv[1], "-test-load-tu", 13) == 0) {
@@ -0,0 +1,99 @@
+//===-- clang-hmap/ClangHMap.cpp - Header map generator -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements a tool that writes a header map for a list of
+/// include directories, so that a build can pass a single header map to
+/// -I instead of the directories themselves.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/HeaderMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace clang;
+
+static cl::list<std::string>
+Inputs(cl::Positional, cl::ZeroOrMore,
+       cl::desc("<include directory> ... | <header map>"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output header map"), cl::value_desc("file"));
+
+static cl::opt<bool>
+PerfectHashFormat("perfect-hash",
+                  cl::desc("Write the extended format, whose lookups probe a "
+                           "single bucket"));
+
+static cl::opt<bool>
+Dump("dump", cl::desc("Print the contents of the given header map"));
+
+static int dumpHeaderMap(StringRef Filename) {
+  OwningPtr<MemoryBuffer> Buffer;
+  if (error_code EC = MemoryBuffer::getFile(Filename, Buffer)) {
+    errs() << "error: cannot read '" << Filename << "': " << EC.message()
+           << "\n";
+    return 1;
+  }
+
+  OwningPtr<const HeaderMap> HMap(HeaderMap::Create(Buffer.take()));
+  if (!HMap) {
+    errs() << "error: '" << Filename << "' is not a header map\n";
+    return 1;
+  }
+  HMap->dump();
+  return 0;
+}
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  cl::ParseCommandLineOptions(argc, argv,
+                              "A tool to generate clang header maps.\n\n"
+                              "Maps every file below the given directories "
+                              "to its path, earlier\ndirectories taking "
+                              "precedence, as with -I.\n");
+
+  if (Dump) {
+    if (Inputs.size() != 1) {
+      errs() << "error: -dump requires exactly one header map\n";
+      return 1;
+    }
+    return dumpHeaderMap(Inputs[0]);
+  }
+
+  if (OutputFilename.empty()) {
+    errs() << "error: no output file specified (use -o)\n";
+    return 1;
+  }
+
+  HeaderMapBuilder Builder;
+  for (unsigned I = 0, E = Inputs.size(); I != E; ++I) {
+    if (error_code EC = Builder.addDirectory(Inputs[I])) {
+      errs() << "error: cannot read directory '" << Inputs[I]
+             << "': " << EC.message() << "\n";
+      return 1;
+    }
+  }
+
+  std::string ErrorInfo;
+  raw_fd_ostream OS(OutputFilename.c_str(), ErrorInfo, sys::fs::F_None);
+  if (!ErrorInfo.empty()) {
+    errs() << "error: " << ErrorInfo << "\n";
+    return 1;
+  }
+  Builder.write(OS, PerfectHashFormat ? HeaderMapBuilder::PerfectHash
+                                      : HeaderMapBuilder::Classic);
+  return 0;
+}
@@ -0,0 +1,124 @@
+//===-- clang-scan-deps/ClangScanDeps.cpp - Batch dependency scanner ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements a tool that computes the header dependencies
+/// of every translation unit in a compilation database, without parsing or
+/// generating code for any of them.
+///
+/// All translation units are scanned in one process and share a single
+/// FileManager, so each header is only stat'ed and opened once per run.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/DependencyOutputOptions.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <deque>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::OptionCategory ScanDepsCategory("clang-scan-deps options");
+
+static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
+
+static cl::opt<DependencyOutputFormat>
+Format("format", cl::desc("Output format of the dependencies"),
+       cl::values(clEnumValN(DOF_Make, "make", "Makefile rules"),
+                  clEnumValN(DOF_JSON, "json", "A JSON array of objects"),
+                  clEnumValEnd),
+       cl::init(DOF_Make), cl::cat(ScanDepsCategory));
+
+namespace {
+
+/// \brief Scans one translation unit and appends its dependencies, in the
+/// requested format, to a string.
+class ScanAction : public DependencyScanAction {
+  raw_string_ostream OS;
+
+public:
+  explicit ScanAction(std::string &Result) : OS(Result) {}
+
+protected:
+  virtual bool BeginInvocation(CompilerInstance &CI) {
+    DependencyOutputOptions &DepOpts = CI.getDependencyOutputOpts();
+    // The dependencies go to our own stream, not to the -MF file of the
+    // original compile command.
+    DepOpts.OutputFile.clear();
+    DepOpts.OutputFormat = Format;
+    if (DepOpts.Targets.empty()) {
+      const FrontendOptions &FEOpts = CI.getFrontendOpts();
+      if (!FEOpts.Inputs.empty())
+        DepOpts.Targets.push_back(
+            (sys::path::stem(FEOpts.Inputs[0].getFile()) + ".o").str());
+    }
+
+    // Most headers are looked up in several include directories before they
+    // are found; answer the misses from the directory listings.
+    CI.getHeaderSearchOpts().UseDirectoryListingCache = true;
+    return true;
+  }
+
+  virtual bool BeginSourceFileAction(CompilerInstance &CI,
+                                     StringRef Filename) {
+    AttachDependencyFileGen(CI.getPreprocessor(), CI.getDependencyOutputOpts(),
+                            OS);
+    return true;
+  }
+};
+
+class ScanActionFactory : public FrontendActionFactory {
+public:
+  // A deque, so that the strings handed out stay put as more are added.
+  std::deque<std::string> Results;
+
+  virtual FrontendAction *create() {
+    Results.push_back(std::string());
+    return new ScanAction(Results.back());
+  }
+};
+
+} // end anonymous namespace
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal();
+  CommonOptionsParser OptionsParser(argc, argv, ScanDepsCategory);
+  ClangTool Tool(OptionsParser.getCompilations(),
+                 OptionsParser.getSourcePathList());
+
+  ScanActionFactory Factory;
+  int Status = Tool.run(&Factory);
+
+  raw_ostream &OS = outs();
+  if (Format == DOF_JSON)
+    OS << "[\n";
+  bool First = true;
+  for (unsigned I = 0, E = Factory.Results.size(); I != E; ++I) {
+    StringRef Result = StringRef(Factory.Results[I]).rtrim();
+    if (Result.empty())
+      continue;
+    if (Format == DOF_JSON && !First)
+      OS << ",\n";
+    OS << Result << '\n';
+    First = false;
+  }
+  if (Format == DOF_JSON)
+    OS << "]\n";
+  return Status;
+}
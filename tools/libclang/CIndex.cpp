@@ -3077,6 +3077,39 @@ int clang_reparseTranslationUnit(CXTranslationUnit TU,
   return RTUI.result;
 }
 
+static void clang_freezeTranslationUnit_Impl(void *UserData) {
+  static_cast<ASTUnit *>(UserData)->freeze();
+}
+
+int clang_freezeTranslationUnit(CXTranslationUnit TU) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+
+  if (getenv("LIBCLANG_NOTHREADS")) {
+    CXXUnit->freeze();
+    return CXError_Success;
+  }
+
+  llvm::CrashRecoveryContext CRC;
+
+  if (!RunSafely(CRC, clang_freezeTranslationUnit_Impl, CXXUnit)) {
+    fprintf(stderr, "libclang: crash detected while freezing AST\n");
+    CXXUnit->setUnsafeToFree(true);
+    return CXError_Crashed;
+  }
+
+  return CXError_Success;
+}
+
 
 CXString clang_getTranslationUnitSpelling(CXTranslationUnit CTUnit) {
   if (isNotUsableTU(CTUnit)) {
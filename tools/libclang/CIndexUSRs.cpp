@@ -34,6 +34,17 @@ bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf) {
   return generateUSRForDecl(D, Buf);
 }
 
+static CXUSRHash makeCXUSRHash(StringRef USR) {
+  CXUSRHash Result = { { 0, 0 } };
+  if (USR.empty())
+    return Result;
+
+  USRHash Hash = hashUSR(USR);
+  Result.data[0] = Hash.Low;
+  Result.data[1] = Hash.High;
+  return Result;
+}
+
 extern "C" {
 
 CXString clang_getCursorUSR(CXCursor C) {
@@ -84,6 +95,24 @@ CXString clang_getCursorUSR(CXCursor C) {
   return cxstring::createEmpty();
 }
 
+CXUSRHash clang_getCursorUSRHash(CXCursor C) {
+  if (clang_isDeclaration(clang_getCursorKind(C))) {
+    // Generate the USR on the stack instead of in the translation unit's
+    // string buffers.
+    const Decl *D = cxcursor::getCursorDecl(C);
+    SmallString<512> Buf;
+    if (!D || cxcursor::getDeclCursorUSR(D, Buf))
+      return makeCXUSRHash(StringRef());
+    return makeCXUSRHash(Buf.str());
+  }
+
+  CXString USR = clang_getCursorUSR(C);
+  const char *CStr = clang_getCString(USR);
+  CXUSRHash Result = makeCXUSRHash(CStr ? StringRef(CStr) : StringRef());
+  clang_disposeString(USR);
+  return Result;
+}
+
 CXString clang_constructUSR_ObjCIvar(const char *name, CXString classUSR) {
   SmallString<128> Buf(getUSRSpacePrefix());
   llvm::raw_svector_ostream OS(Buf);
@@ -23,6 +23,7 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
@@ -85,3 +86,13 @@ const std::string &CIndexer::getClangResourcesPath() {
   ResourcesPath = LibClangPath.str();
   return ResourcesPath;
 }
+
+const char *CIndexer::internUSR(StringRef USR) {
+  llvm::MutexGuard Guard(USRLock);
+  unsigned NumUSRs = InternedUSRs.size();
+  llvm::StringMapEntry<index::USRHash> &Entry =
+      InternedUSRs.GetOrCreateValue(USR);
+  if (InternedUSRs.size() != NumUSRs)
+    Entry.setValue(index::hashUSR(USR));
+  return Entry.getKeyData();
+}
@@ -16,7 +16,11 @@
 #define LLVM_CLANG_CINDEXER_H
 
 #include "clang-c/Index.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/Path.h"
 #include <vector>
 
@@ -39,9 +43,14 @@ class CIndexer {
 
   std::string ResourcesPath;
 
+  /// \brief The USRs handed out by the indexing APIs, with their hashes.
+  /// Translation units of the same index may be indexed concurrently.
+  llvm::sys::Mutex USRLock;
+  llvm::StringMap<index::USRHash, llvm::BumpPtrAllocator> InternedUSRs;
+
 public:
  CIndexer() : OnlyLocalDecls(false), DisplayDiagnostics(false),
-              Options(CXGlobalOpt_None) { }
+              Options(CXGlobalOpt_None), USRLock(/*recursive=*/false) { }
   
   /// \brief Whether we only want to see "local" declarations (that did not
   /// come from a previous precompiled header). If false, we want to see all
@@ -63,6 +72,16 @@ public:
 
   /// \brief Get the path of the clang resource files.
   const std::string &getClangResourcesPath();
+
+  /// \brief Returns a null-terminated copy of \p USR that lives as long as
+  /// the index. Equal USRs get the same pointer.
+  const char *internUSR(StringRef USR);
+
+  /// \brief Returns the hash of a USR returned by \c internUSR.
+  static index::USRHash getInternedUSRHash(const char *USR) {
+    return llvm::StringMapEntry<index::USRHash>::
+        GetStringMapEntryFromKeyData(USR).getValue();
+  }
 };
 
   /// \brief Return the current size to request for "safety".
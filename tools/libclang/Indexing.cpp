@@ -27,12 +27,18 @@
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
+#include "llvm/Config/config.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Threading.h"
 #include <cstdio>
 
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 using namespace clang;
 using namespace cxtu;
 using namespace cxindex;
@@ -63,6 +69,19 @@ public:
   void finished() { }
 };
 
+class SessionIndexedHeaderData { };
+
+class TUHeaderIndexControl {
+public:
+  TUHeaderIndexControl(SessionIndexedHeaderData &sessionData,
+                       PPConditionalDirectiveRecord &ppRec,
+                       Preprocessor &pp) { }
+  bool isIndexedElsewhere(SourceLocation Loc, FileID FID,
+                          const FileEntry *FE) {
+    return false;
+  }
+};
+
 #else
 
 /// \brief A "region" in source code identified by the file/offset of the
@@ -166,6 +185,38 @@ public:
   }
 };
 
+/// \brief Returns the region that \p Loc belongs to, or an invalid region if
+/// it cannot be identified across translation units.
+static PPRegion getPPRegion(PPConditionalDirectiveRecord &PPRec,
+                            Preprocessor &PP, SourceLocation Loc, FileID FID,
+                            const FileEntry *FE) {
+  SourceLocation RegionLoc = PPRec.findConditionalDirectiveRegionLoc(Loc);
+  if (RegionLoc.isInvalid()) {
+    if (PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE)) {
+      const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+      return PPRegion(ID, 0, FE->getModificationTime());
+    }
+    return PPRegion();
+  }
+
+  const SourceManager &SM = PPRec.getSourceManager();
+  assert(RegionLoc.isFileID());
+  FileID RegionFID;
+  unsigned RegionOffset;
+  llvm::tie(RegionFID, RegionOffset) = SM.getDecomposedLoc(RegionLoc);
+
+  if (RegionFID != FID) {
+    if (PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE)) {
+      const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+      return PPRegion(ID, 0, FE->getModificationTime());
+    }
+    return PPRegion();
+  }
+
+  const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+  return PPRegion(ID, RegionOffset, FE->getModificationTime());
+}
+
 class TUSkipBodyControl {
   SessionSkipBodyData &SessionData;
   PPConditionalDirectiveRecord &PPRec;
@@ -185,7 +236,7 @@ public:
   }
 
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
-    PPRegion region = getRegion(Loc, FID, FE);
+    PPRegion region = getPPRegion(PPRec, PP, Loc, FID, FE);
     if (region.isInvalid())
       return false;
 
@@ -203,38 +254,63 @@ public:
   void finished() {
     SessionData.update(NewParsedRegions);
   }
+};
 
-private:
-  PPRegion getRegion(SourceLocation Loc, FileID FID, const FileEntry *FE) {
-    SourceLocation RegionLoc = PPRec.findConditionalDirectiveRegionLoc(Loc);
-    if (RegionLoc.isInvalid()) {
-      if (isParsedOnceInclude(FE)) {
-        const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-        return PPRegion(ID, 0, FE->getModificationTime());
-      }
-      return PPRegion();
-    }
+/// \brief The header regions whose declarations have been indexed by some
+/// translation unit of the session.
+///
+/// Unlike \c SessionSkipBodyData, which is only updated when a translation
+/// unit finishes, a region is claimed as soon as a translation unit starts
+/// indexing it, so that translation units indexed concurrently don't report
+/// the same header declarations.
+class SessionIndexedHeaderData {
+  llvm::sys::Mutex Mux;
+  PPRegionSetTy IndexedRegions;
 
-    const SourceManager &SM = PPRec.getSourceManager();
-    assert(RegionLoc.isFileID());
-    FileID RegionFID;
-    unsigned RegionOffset;
-    llvm::tie(RegionFID, RegionOffset) = SM.getDecomposedLoc(RegionLoc);
-
-    if (RegionFID != FID) {
-      if (isParsedOnceInclude(FE)) {
-        const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-        return PPRegion(ID, 0, FE->getModificationTime());
-      }
-      return PPRegion();
-    }
+public:
+  SessionIndexedHeaderData() : Mux(/*recursive=*/false) {}
 
-    const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-    return PPRegion(ID, RegionOffset, FE->getModificationTime());
+  /// \brief Returns true if the caller is the first to index \p Region.
+  bool claim(const PPRegion &Region) {
+    llvm::MutexGuard MG(Mux);
+    return IndexedRegions.insert(Region).second;
   }
+};
 
-  bool isParsedOnceInclude(const FileEntry *FE) {
-    return PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE);
+class TUHeaderIndexControl {
+  SessionIndexedHeaderData &SessionData;
+  PPConditionalDirectiveRecord &PPRec;
+  Preprocessor &PP;
+
+  /// \brief The regions seen by this translation unit, mapped to whether
+  /// this translation unit is the one indexing them.
+  llvm::DenseMap<PPRegion, bool> OwnedRegions;
+  PPRegion LastRegion;
+  bool LastIsOwned;
+
+public:
+  TUHeaderIndexControl(SessionIndexedHeaderData &sessionData,
+                       PPConditionalDirectiveRecord &ppRec,
+                       Preprocessor &pp)
+    : SessionData(sessionData), PPRec(ppRec), PP(pp), LastIsOwned(false) { }
+
+  bool isIndexedElsewhere(SourceLocation Loc, FileID FID,
+                          const FileEntry *FE) {
+    PPRegion region = getPPRegion(PPRec, PP, Loc, FID, FE);
+    if (region.isInvalid())
+      return false;
+
+    // Check common case, consecutive declarations in the same region.
+    if (LastRegion == region)
+      return !LastIsOwned;
+
+    LastRegion = region;
+    std::pair<llvm::DenseMap<PPRegion, bool>::iterator, bool>
+      Known = OwnedRegions.insert(std::make_pair(region, false));
+    if (Known.second)
+      Known.first->second = SessionData.claim(region);
+    LastIsOwned = Known.first->second;
+    return !LastIsOwned;
   }
 };
 
@@ -311,10 +387,34 @@ public:
 class IndexingConsumer : public ASTConsumer {
   IndexingContext &IndexCtx;
   TUSkipBodyControl *SKCtrl;
+  TUHeaderIndexControl *HICtrl;
+
+  /// \brief Whether \p D lives in a header region that another translation
+  /// unit of the session has indexed or is indexing.
+  bool isIndexedElsewhere(const Decl *D) {
+    if (!HICtrl)
+      return false;
+
+    const SourceManager &SM = IndexCtx.getASTContext().getSourceManager();
+    SourceLocation Loc = D->getLocation();
+    if (Loc.isInvalid())
+      return false;
+    Loc = SM.getExpansionLoc(Loc);
+
+    FileID FID = SM.getFileID(Loc);
+    if (SM.getMainFileID() == FID)
+      return false;
+    const FileEntry *FE = SM.getFileEntryForID(FID);
+    if (!FE)
+      return false;
+
+    return HICtrl->isIndexedElsewhere(Loc, FID, FE);
+  }
 
 public:
-  IndexingConsumer(IndexingContext &indexCtx, TUSkipBodyControl *skCtrl)
-    : IndexCtx(indexCtx), SKCtrl(skCtrl) { }
+  IndexingConsumer(IndexingContext &indexCtx, TUSkipBodyControl *skCtrl,
+                   TUHeaderIndexControl *hiCtrl = 0)
+    : IndexCtx(indexCtx), SKCtrl(skCtrl), HICtrl(hiCtrl) { }
 
   // ASTConsumer Implementation
 
@@ -329,7 +429,14 @@ public:
   }
 
   virtual bool HandleTopLevelDecl(DeclGroupRef DG) {
-    IndexCtx.indexDeclGroupRef(DG);
+    if (!HICtrl) {
+      IndexCtx.indexDeclGroupRef(DG);
+      return !IndexCtx.shouldAbort();
+    }
+
+    for (DeclGroupRef::iterator I = DG.begin(), E = DG.end(); I != E; ++I)
+      if (!isIndexedElsewhere(*I))
+        IndexCtx.indexTopLevelDecl(*I);
     return !IndexCtx.shouldAbort();
   }
 
@@ -337,7 +444,14 @@ public:
   /// and ObjC container.
   virtual void HandleTopLevelDeclInObjCContainer(DeclGroupRef D) {
     // They will be handled after the interface is seen first.
-    IndexCtx.addTUDeclInObjCContainer(D);
+    if (!HICtrl) {
+      IndexCtx.addTUDeclInObjCContainer(D);
+      return;
+    }
+
+    for (DeclGroupRef::iterator I = D.begin(), E = D.end(); I != E; ++I)
+      if (!isIndexedElsewhere(*I))
+        IndexCtx.addTUDeclInObjCContainer(DeclGroupRef(*I));
   }
 
   /// \brief This is called by the AST reader when deserializing things.
@@ -345,6 +459,11 @@ public:
   /// care about them when indexing, so have an empty definition.
   virtual void HandleInterestingDecl(DeclGroupRef D) {}
 
+  // Implicit instantiations are not filtered by header region: they belong
+  // to the translation unit that uses them, even though they are located in
+  // the template's header, and another translation unit that indexed that
+  // header need not have instantiated the same specializations.
+
   virtual void HandleTagDeclDefinition(TagDecl *D) {
     if (!IndexCtx.shouldIndexImplicitTemplateInsts())
       return;
@@ -412,15 +531,18 @@ class IndexingFrontendAction : public ASTFrontendAction {
 
   SessionSkipBodyData *SKData;
   OwningPtr<TUSkipBodyControl> SKCtrl;
+  SessionIndexedHeaderData *HIData;
+  OwningPtr<TUHeaderIndexControl> HICtrl;
 
 public:
   IndexingFrontendAction(CXClientData clientData,
                          IndexerCallbacks &indexCallbacks,
                          unsigned indexOptions,
                          CXTranslationUnit cxTU,
-                         SessionSkipBodyData *skData)
+                         SessionSkipBodyData *skData,
+                         SessionIndexedHeaderData *hiData)
     : IndexCtx(clientData, indexCallbacks, indexOptions, cxTU),
-      CXTU(cxTU), SKData(skData) { }
+      CXTU(cxTU), SKData(skData), HIData(hiData) { }
 
   virtual ASTConsumer *CreateASTConsumer(CompilerInstance &CI,
                                          StringRef InFile) {
@@ -436,14 +558,17 @@ public:
     PP.addPPCallbacks(new IndexPPCallbacks(PP, IndexCtx));
     IndexCtx.setPreprocessor(PP);
 
-    if (SKData) {
+    if (SKData || HIData) {
       PPConditionalDirectiveRecord *
         PPRec = new PPConditionalDirectiveRecord(PP.getSourceManager());
       PP.addPPCallbacks(PPRec);
-      SKCtrl.reset(new TUSkipBodyControl(*SKData, *PPRec, PP));
+      if (SKData)
+        SKCtrl.reset(new TUSkipBodyControl(*SKData, *PPRec, PP));
+      if (HIData)
+        HICtrl.reset(new TUHeaderIndexControl(*HIData, *PPRec, PP));
     }
 
-    return new IndexingConsumer(IndexCtx, SKCtrl.get());
+    return new IndexingConsumer(IndexCtx, SKCtrl.get(), HICtrl.get());
   }
 
   virtual void EndSourceFileAction() {
@@ -466,9 +591,11 @@ public:
 struct IndexSessionData {
   CXIndex CIdx;
   OwningPtr<SessionSkipBodyData> SkipBodyData;
+  OwningPtr<SessionIndexedHeaderData> IndexedHeaderData;
 
   explicit IndexSessionData(CXIndex cIdx)
-    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData),
+      IndexedHeaderData(new SessionIndexedHeaderData) {}
 };
 
 struct IndexSourceFileInfo {
@@ -484,6 +611,9 @@ struct IndexSourceFileInfo {
   unsigned num_unsaved_files;
   CXTranslationUnit *out_TU;
   unsigned TU_options;
+  /// \brief The clang resource directory, or null to ask the CIndexer. The
+  /// CIndexer computes it lazily, so concurrent jobs must pass it in.
+  const char *resources_path;
   int result;
 };
 
@@ -543,6 +673,10 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   if (CXXIdx->isOptEnabled(CXGlobalOpt_ThreadBackgroundPriorityForIndexing))
     setThreadBackgroundPriority();
 
+  StringRef ResourcesPath = ITUI->resources_path
+                                ? StringRef(ITUI->resources_path)
+                                : StringRef(CXXIdx->getClangResourcesPath());
+
   bool CaptureDiagnostics = !Logger::isLoggingEnabled();
 
   CaptureDiagnosticConsumer *CaptureDiag = 0;
@@ -631,10 +765,15 @@ static void clang_indexSourceFile_Impl(void *UserData) {
   if (SkipBodies)
     CInvok->getFrontendOpts().SkipFunctionBodies = true;
 
+  SessionIndexedHeaderData *IndexedHeaders = 0;
+  if (index_options & CXIndexOpt_IndexHeadersOnceInSession)
+    IndexedHeaders = IdxSession->IndexedHeaderData.get();
+
   OwningPtr<IndexingFrontendAction> IndexAction;
   IndexAction.reset(new IndexingFrontendAction(client_data, CB,
                                                index_options, CXTU->getTU(),
-                              SkipBodies ? IdxSession->SkipBodyData.get() : 0));
+                              SkipBodies ? IdxSession->SkipBodyData.get() : 0,
+                                               IndexedHeaders));
 
   // Recover resources if we crash before exiting this method.
   llvm::CrashRecoveryContextCleanupRegistrar<IndexingFrontendAction>
@@ -667,7 +806,7 @@ static void clang_indexSourceFile_Impl(void *UserData) {
                                                        IndexAction.get(),
                                                        Unit,
                                                        Persistent,
-                                                CXXIdx->getClangResourcesPath(),
+                                                ResourcesPath,
                                                        OnlyLocalDecls,
                                                        CaptureDiagnostics,
                                                        PrecompilePreamble,
@@ -829,6 +968,98 @@ static void clang_indexTranslationUnit_Impl(void *UserData) {
   ITUI->result = CXError_Success;
 }
 
+/// \brief Index a source file as clang_indexSourceFile() does, with crash
+/// recovery unless LIBCLANG_NOTHREADS is set.
+static int indexSourceFileSafely(IndexSourceFileInfo &ITUI) {
+  if (getenv("LIBCLANG_NOTHREADS")) {
+    clang_indexSourceFile_Impl(&ITUI);
+    return ITUI.result;
+  }
+
+  llvm::CrashRecoveryContext CRC;
+
+  if (!RunSafely(CRC, clang_indexSourceFile_Impl, &ITUI)) {
+    fprintf(stderr, "libclang: crash detected during indexing source file: {\n");
+    fprintf(stderr, "  'source_filename' : '%s'\n", ITUI.source_filename);
+    fprintf(stderr, "  'command_line_args' : [");
+    for (int i = 0; i != ITUI.num_command_line_args; ++i) {
+      if (i)
+        fprintf(stderr, ", ");
+      fprintf(stderr, "'%s'", ITUI.command_line_args[i]);
+    }
+    fprintf(stderr, "],\n");
+    fprintf(stderr, "  'unsaved_files' : [");
+    for (unsigned i = 0; i != ITUI.num_unsaved_files; ++i) {
+      if (i)
+        fprintf(stderr, ", ");
+      fprintf(stderr, "('%s', '...', %ld)", ITUI.unsaved_files[i].Filename,
+              ITUI.unsaved_files[i].Length);
+    }
+    fprintf(stderr, "],\n");
+    fprintf(stderr, "  'options' : %d,\n", ITUI.TU_options);
+    fprintf(stderr, "}\n");
+    
+    return 1;
+  } else if (getenv("LIBCLANG_RESOURCE_USAGE")) {
+    if (ITUI.out_TU)
+      PrintLibclangResourceUsage(*ITUI.out_TU);
+  }
+  
+  return ITUI.result;
+}
+
+//===----------------------------------------------------------------------===//
+// clang_indexSourceFiles Implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// \brief The source files of a clang_indexSourceFiles call, handed out to
+/// the worker threads one at a time.
+struct IndexSourceFilesBatch {
+  CXIndexAction idxAction;
+  IndexerCallbacks *index_callbacks;
+  unsigned index_callbacks_size;
+  unsigned index_options;
+  CXIndexSourceFileJob *jobs;
+  unsigned num_jobs;
+  struct CXUnsavedFile *unsaved_files;
+  unsigned num_unsaved_files;
+
+  /// \brief The clang resource directory, computed before the threads start.
+  std::string ResourcesPath;
+
+  llvm::sys::Mutex Lock;
+  unsigned NextJob;
+};
+
+} // anonymous namespace
+
+/// \brief Worker loop: index source files from the batch until none are left.
+static void *indexSourceFilesInBatch(void *UserData) {
+  IndexSourceFilesBatch &Batch = *static_cast<IndexSourceFilesBatch *>(UserData);
+  while (true) {
+    CXIndexSourceFileJob *Job;
+    {
+      llvm::sys::ScopedLock L(Batch.Lock);
+      if (Batch.NextJob == Batch.num_jobs)
+        return 0;
+      Job = &Batch.jobs[Batch.NextJob++];
+    }
+    IndexSourceFileInfo ITUI = { Batch.idxAction, Job->client_data,
+                                 Batch.index_callbacks,
+                                 Batch.index_callbacks_size,
+                                 Batch.index_options, Job->source_filename,
+                                 Job->command_line_args,
+                                 Job->num_command_line_args,
+                                 Batch.unsaved_files, Batch.num_unsaved_files,
+                                 /*out_TU=*/0, /*TU_options=*/0,
+                                 Batch.ResourcesPath.c_str(),
+                                 CXError_Failure };
+    Job->result = indexSourceFileSafely(ITUI);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // libclang public APIs.
 //===----------------------------------------------------------------------===//
@@ -959,6 +1190,19 @@ CXIdxClientEntity clang_index_getClientEntity(const CXIdxEntityInfo *info) {
   return Entity->IndexCtx->getClientEntity(Entity->Dcl);
 }
 
+CXUSRHash clang_index_getEntityUSRHash(const CXIdxEntityInfo *info) {
+  CXUSRHash Result = { { 0, 0 } };
+  if (!info || !info->USR)
+    return Result;
+
+  // The indexing callbacks only hand out interned USRs, which carry their
+  // hash.
+  index::USRHash Hash = CIndexer::getInternedUSRHash(info->USR);
+  Result.data[0] = Hash.Low;
+  Result.data[1] = Hash.High;
+  return Result;
+}
+
 void clang_index_setClientEntity(const CXIdxEntityInfo *info,
                                  CXIdxClientEntity client) {
   if (!info)
@@ -999,43 +1243,66 @@ int clang_indexSourceFile(CXIndexAction idxAction,
                                source_filename, command_line_args,
                                num_command_line_args, unsaved_files,
                                num_unsaved_files, out_TU, TU_options,
-                               CXError_Failure };
+                               /*resources_path=*/0, CXError_Failure };
+  return indexSourceFileSafely(ITUI);
+}
 
-  if (getenv("LIBCLANG_NOTHREADS")) {
-    clang_indexSourceFile_Impl(&ITUI);
-    return ITUI.result;
+int clang_indexSourceFiles(CXIndexAction idxAction,
+                           IndexerCallbacks *index_callbacks,
+                           unsigned index_callbacks_size,
+                           unsigned index_options,
+                           CXIndexSourceFileJob *jobs,
+                           unsigned num_jobs,
+                           struct CXUnsavedFile *unsaved_files,
+                           unsigned num_unsaved_files,
+                           unsigned num_threads) {
+  LOG_FUNC_SECTION {
+    *Log << num_jobs << " files, " << num_threads << " threads";
   }
 
-  llvm::CrashRecoveryContext CRC;
-
-  if (!RunSafely(CRC, clang_indexSourceFile_Impl, &ITUI)) {
-    fprintf(stderr, "libclang: crash detected during indexing source file: {\n");
-    fprintf(stderr, "  'source_filename' : '%s'\n", source_filename);
-    fprintf(stderr, "  'command_line_args' : [");
-    for (int i = 0; i != num_command_line_args; ++i) {
-      if (i)
-        fprintf(stderr, ", ");
-      fprintf(stderr, "'%s'", command_line_args[i]);
-    }
-    fprintf(stderr, "],\n");
-    fprintf(stderr, "  'unsaved_files' : [");
-    for (unsigned i = 0; i != num_unsaved_files; ++i) {
-      if (i)
-        fprintf(stderr, ", ");
-      fprintf(stderr, "('%s', '...', %ld)", unsaved_files[i].Filename,
-              unsaved_files[i].Length);
-    }
-    fprintf(stderr, "],\n");
-    fprintf(stderr, "  'options' : %d,\n", TU_options);
-    fprintf(stderr, "}\n");
-    
-    return 1;
-  } else if (getenv("LIBCLANG_RESOURCE_USAGE")) {
-    if (out_TU)
-      PrintLibclangResourceUsage(*out_TU);
+  if (!idxAction || (num_jobs && !jobs))
+    return CXError_InvalidArguments;
+
+  IndexSourceFilesBatch Batch;
+  Batch.idxAction = idxAction;
+  Batch.index_callbacks = index_callbacks;
+  Batch.index_callbacks_size = index_callbacks_size;
+  Batch.index_options = index_options;
+  Batch.jobs = jobs;
+  Batch.num_jobs = num_jobs;
+  Batch.unsaved_files = unsaved_files;
+  Batch.num_unsaved_files = num_unsaved_files;
+  Batch.NextJob = 0;
+  IndexSessionData *IdxSession = static_cast<IndexSessionData *>(idxAction);
+  Batch.ResourcesPath =
+      static_cast<CIndexer *>(IdxSession->CIdx)->getClangResourcesPath();
+
+  for (unsigned I = 0; I != num_jobs; ++I)
+    jobs[I].result = CXError_Failure;
+
+  // clang_createIndex() has already enabled multithreading, unless LLVM was
+  // built without thread support.
+  if (getenv("LIBCLANG_NOTHREADS") || !llvm::llvm_is_multithreaded())
+    num_threads = 1;
+
+#if HAVE_PTHREAD_H
+  SmallVector<pthread_t, 8> Threads;
+  for (unsigned I = 1; I < num_threads && I < num_jobs; ++I) {
+    pthread_t Thread;
+    if (::pthread_create(&Thread, 0, &indexSourceFilesInBatch, &Batch) == 0)
+      Threads.push_back(Thread);
   }
-  
-  return ITUI.result;
+  indexSourceFilesInBatch(&Batch);
+  for (unsigned I = 0, N = Threads.size(); I != N; ++I)
+    ::pthread_join(Threads[I], 0);
+#else
+  indexSourceFilesInBatch(&Batch);
+#endif
+
+  for (unsigned I = 0; I != num_jobs; ++I)
+    if (jobs[I].result != CXError_Success)
+      return jobs[I].result;
+  return CXError_Success;
 }
 
 int clang_indexTranslationUnit(CXIndexAction idxAction,
@@ -9,6 +9,7 @@
 
 #include "IndexingContext.h"
 #include "CIndexDiagnostic.h"
+#include "CIndexer.h"
 #include "CXTranslationUnit.h"
 #include "clang/AST/Attr.h"
 #include "clang/AST/DeclCXX.h"
@@ -1108,15 +1109,22 @@ void IndexingContext::getEntityInfo(const NamedDecl *D,
     EntityInfo.name = SA.copyCStr(StrBuf.str());
   }
 
-  {
-    SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
-    if (Ignore) {
-      EntityInfo.USR = 0;
-    } else {
-      EntityInfo.USR = SA.copyCStr(StrBuf.str());
-    }
-  }
+  EntityInfo.USR = getInternedUSR(D);
+}
+
+const char *IndexingContext::getInternedUSR(const Decl *D) {
+  std::pair<USRMapTy::iterator, bool>
+    Res = USRMap.insert(std::make_pair(D, (const char *)0));
+  if (!Res.second)
+    return Res.first->second;
+
+  SmallString<512> StrBuf;
+  bool Ignore = getDeclCursorUSR(D, StrBuf);
+  if (Ignore)
+    return 0;
+
+  Res.first->second = CXTU->CIdx->internUSR(StrBuf.str());
+  return Res.first->second;
 }
 
 void IndexingContext::getContainerInfo(const DeclContext *DC,
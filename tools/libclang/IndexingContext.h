@@ -281,11 +281,16 @@ class IndexingContext {
   typedef llvm::DenseMap<const DeclContext *, CXIdxClientContainer>
     ContainerMapTy;
   typedef llvm::DenseMap<const Decl *, CXIdxClientEntity> EntityMapTy;
+  typedef llvm::DenseMap<const Decl *, const char *> USRMapTy;
 
   FileMapTy FileMap;
   ContainerMapTy ContainerMap;
   EntityMapTy EntityMap;
 
+  /// \brief The interned USR of each declaration seen so far, or null if it
+  /// has none, so that repeated references don't regenerate it.
+  USRMapTy USRMap;
+
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
@@ -487,6 +492,8 @@ private:
                      EntityInfo &EntityInfo,
                      ScratchAlloc &SA);
 
+  const char *getInternedUSR(const Decl *D);
+
   void getContainerInfo(const DeclContext *DC, ContainerInfo &ContInfo);
 
   CXCursor getCursor(const Decl *D) {
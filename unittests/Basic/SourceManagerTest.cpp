@@ -19,6 +19,7 @@
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
 #include "gtest/gtest.h"
@@ -164,6 +165,46 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, NULL));
 }
 
+TEST_F(SourceManagerTest, getLineNumber) {
+  // Build a file that is large enough for its line table to be computed
+  // piecemeal, with every kind of line ending.
+  std::string Source;
+  std::vector<unsigned> LineStarts;
+  static const char *const LineEndings[] = { "\n", "\r\n", "\r", "\n\r" };
+  for (unsigned I = 0; I != 40000; ++I) {
+    LineStarts.push_back(Source.size());
+    Source += "int x;";
+    Source += LineEndings[I % 4];
+  }
+  LineStarts.push_back(Source.size());
+
+  MemoryBuffer *Buf = MemoryBuffer::getMemBufferCopy(Source);
+  FileID MainFileID = SourceMgr.createMainFileIDForMemBuffer(Buf);
+  MemoryBuffer *OtherBuf = MemoryBuffer::getMemBuffer("a\nb\nc\n");
+  FileID OtherFileID = SourceMgr.createFileIDForMemBuffer(OtherBuf);
+
+  // Query far into the file first, then go back towards the start and
+  // interleave queries into another file.
+  unsigned Lines[] = { 30000, 2, 39999, 1, 17, 20000, 40001, 5 };
+  for (unsigned I = 0; I != llvm::array_lengthof(Lines); ++I) {
+    unsigned Line = Lines[I];
+    bool Invalid = true;
+    EXPECT_EQ(Line, SourceMgr.getLineNumber(MainFileID, LineStarts[Line - 1],
+                                            &Invalid));
+    EXPECT_FALSE(Invalid);
+    if (Line <= 40000)
+      EXPECT_EQ(Line, SourceMgr.getLineNumber(MainFileID,
+                                              LineStarts[Line] - 1));
+    EXPECT_EQ(1U + I % 3, SourceMgr.getLineNumber(OtherFileID, 2 * (I % 3)));
+  }
+
+  SourceLocation Start = SourceMgr.getLocForStartOfFile(MainFileID);
+  EXPECT_EQ(Start.getLocWithOffset(LineStarts[39999] + 3),
+            SourceMgr.translateLineCol(MainFileID, 40000, 4));
+  EXPECT_EQ(Start.getLocWithOffset(Source.size() - 1),
+            SourceMgr.translateLineCol(MainFileID, 50000, 1));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -0,0 +1,84 @@
+//===- unittests/Lex/HeaderMapTest.cpp - HeaderMap tests ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/HeaderMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+const HeaderMap *buildHeaderMap(const HeaderMapBuilder &Builder,
+                                HeaderMapBuilder::FormatKind Format) {
+  std::string Data;
+  {
+    raw_string_ostream OS(Data);
+    Builder.write(OS, Format);
+  }
+  return HeaderMap::Create(MemoryBuffer::getMemBufferCopy(Data, "test.hmap"));
+}
+
+void checkLookups(HeaderMapBuilder::FormatKind Format) {
+  HeaderMapBuilder Builder;
+  EXPECT_TRUE(Builder.addMapping("Foo.h", "/include/", "Foo.h"));
+  EXPECT_TRUE(Builder.addMapping("sys/types.h", "/usr/include/sys/",
+                                 "types.h"));
+  EXPECT_FALSE(Builder.addMapping("FOO.H", "/other/", "Foo.h"));
+  for (unsigned I = 0; I != 1000; ++I) {
+    SmallString<32> Key;
+    raw_svector_ostream(Key) << "gen/header" << I << ".h";
+    Builder.addMapping(Key, "/gen/", Key);
+  }
+  EXPECT_EQ(1002U, Builder.size());
+
+  OwningPtr<const HeaderMap> HMap(buildHeaderMap(Builder, Format));
+  ASSERT_TRUE(HMap.get() != 0);
+
+  SmallString<64> Path;
+  EXPECT_EQ("/include/Foo.h", HMap->lookupFilename("Foo.h", Path).str());
+  EXPECT_EQ("/include/Foo.h", HMap->lookupFilename("foo.H", Path).str());
+  EXPECT_EQ("/usr/include/sys/types.h",
+            HMap->lookupFilename("sys/types.h", Path).str());
+  EXPECT_EQ("/gen/gen/header999.h",
+            HMap->lookupFilename("gen/header999.h", Path).str());
+  EXPECT_TRUE(HMap->lookupFilename("Bar.h", Path).empty());
+  EXPECT_TRUE(HMap->lookupFilename("gen/header1000.h", Path).empty());
+}
+
+TEST(HeaderMapTest, ClassicFormat) {
+  checkLookups(HeaderMapBuilder::Classic);
+}
+
+TEST(HeaderMapTest, PerfectHashFormat) {
+  checkLookups(HeaderMapBuilder::PerfectHash);
+}
+
+TEST(HeaderMapTest, EmptyMap) {
+  HeaderMapBuilder Builder;
+  OwningPtr<const HeaderMap> HMap(
+      buildHeaderMap(Builder, HeaderMapBuilder::PerfectHash));
+  ASSERT_TRUE(HMap.get() != 0);
+
+  SmallString<64> Path;
+  EXPECT_TRUE(HMap->lookupFilename("Foo.h", Path).empty());
+}
+
+TEST(HeaderMapTest, RejectsNonHeaderMaps) {
+  OwningPtr<const HeaderMap> HMap(HeaderMap::Create(
+      MemoryBuffer::getMemBufferCopy("this is definitely not a header map",
+                                     "bogus.hmap")));
+  EXPECT_TRUE(HMap.get() == 0);
+}
+
+} // anonymous namespace